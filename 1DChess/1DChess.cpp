@@ -2,17 +2,20 @@
 //
 
 #include <iostream>
+#include <string_view>
+#include <vector>
 #include "Board.h"
 #include "Game.h"
 #include "EvaluationTree.h"
+#include "CommandLine.h"
+#include "PlayModes.h"
+#include "SolveModes.h"
+#include "AnalysisModes.h"
+#include "ServerModes.h"
+#include "ArchiveModes.h"
 
 
-/* Hack table to convert -2 to unknown eval in case we don't have one somehow */
-const char* gEvalTable[] = {
-    "?", "-1", "0", "1"
-};
-
-const char* evalGameState(const GameState& state, EvaluationTree& eval)
+const char* evalGameState(const GameState& state, const EvaluationTree& eval)
 {
     /* Use cache if non-terminal game state.
        Otherwise do a quick eval */
@@ -36,20 +39,145 @@ const char* evalGameState(const GameState& state, EvaluationTree& eval)
     return gEvalTable[value + 2];
 }
 
-int main()
+int main(int argc, char* argv[])
 {
+    /* 1DChess --batch [file] */
+    if (argc > 1 && std::string_view(argv[1]) == "--batch")
+    {
+        return runBatch(argc > 2 ? argv[2] : nullptr);
+    }
+
+    /* 1DChess --selfplay [games=N] [threads=N] [white=perfect|random|mixed] [black=...] [random=rate] [opening=plies] [maxplies=N] [seed=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--selfplay")
+    {
+        return runSelfPlay(argc, argv);
+    }
+
+    /* 1DChess --load [threads=N] [rate=requests/s] [seconds=N] [op=probe|annotate] [corpus=N] [plies=N] [seed=N] [background=0|1] [out=corpus] */
+    if (argc > 1 && std::string_view(argv[1]) == "--load")
+    {
+        return runLoad(argc, argv);
+    }
+
+    /* 1DChess --fuzz [iterations=N] [plies=N] [threads=N] [seed=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--fuzz")
+    {
+        return runFuzz(argc, argv);
+    }
+
+    /* 1DChess --variants [threads=N] [out=dir] [file=setups] [setup ...] */
+    if (argc > 1 && std::string_view(argv[1]) == "--variants")
+    {
+        return runVariants(argc, argv);
+    }
+
+    /* 1DChess --profile [order=0|1] [csv=path] [bin=path] */
+    if (argc > 1 && std::string_view(argv[1]) == "--profile")
+    {
+        return runProfile(argc, argv);
+    }
+
+    /* 1DChess --frontier [setup] [order=setup|locality] [prefetch=0|1] [out=table] */
+    if (argc > 1 && std::string_view(argv[1]) == "--frontier")
+    {
+        return runFrontier(argc, argv);
+    }
+
+    /* 1DChess --hashed [setup] [memory=MB] [replace=depth|always] [threads=N] [compare=0|1] */
+    if (argc > 1 && std::string_view(argv[1]) == "--hashed")
+    {
+        return runHashed(argc, argv);
+    }
+
+    /* 1DChess --verify [setup] [table=path] [threads=N] [max=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--verify")
+    {
+        return runVerify(argc, argv);
+    }
+
+    /* 1DChess --bitsliced [setup] [lanes=64|256] [rounds=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--bitsliced")
+    {
+        return runBitsliced(argc, argv);
+    }
+
+    /* 1DChess --locality [setup] [max=positions] */
+    if (argc > 1 && std::string_view(argv[1]) == "--locality")
+    {
+        return runLocality(argc, argv);
+    }
+
+    /* 1DChess --anytime [setup] [time=ms] [nodes=N] [depth=N] [memory=MB] [cancel=ms] [compare=0|1] */
+    if (argc > 1 && std::string_view(argv[1]) == "--anytime")
+    {
+        return runAnytime(argc, argv);
+    }
+
+    /* 1DChess --line [setup] [table=path] [position=board] [side=w|b] [tree=0|1] [distance=plies] [plies=N] [nodes=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--line")
+    {
+        return runLine(argc, argv);
+    }
+
+    /* 1DChess --compress table compressed [block=positions] [cache=blocks] [probes=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--compress")
+    {
+        return runCompress(argc, argv);
+    }
+
+    /* 1DChess --serve [setup] [table=path] [socket=path] [connections=N] [seconds=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--serve")
+    {
+        return runServe(argc, argv);
+    }
+
+    /* 1DChess --query [file] [socket=path] [op=value|best|moves] [pipeline=N] */
+    if (argc > 1 && std::string_view(argv[1]) == "--query")
+    {
+        return runQuery(argc, argv);
+    }
+
+    /* 1DChess --record archive [setup=board] [games=N] [random=rate] [maxplies=N] [seed=N]
+       1DChess --annotate archive [setup=board] [table=path] [out=path] [threads=N] [batch=games] [dtm=0|1] [distance=plies] */
+    if (argc > 1 && (std::string_view(argv[1]) == "--record" || std::string_view(argv[1]) == "--annotate"))
+    {
+        return runArchive(std::string_view(argv[1]) == "--annotate", argc, argv);
+    }
+
+    /* 1DChess --stream [setup] [dir=path] [chunk=positions] [memory=MB] [buffer=KB] [out=table] */
+    if (argc > 1 && std::string_view(argv[1]) == "--stream")
+    {
+        return runStream(argc, argv);
+    }
+
+    /* 1DChess --partition [setup] [parts=N] [dir=path] [out=table] [timeout=s]
+       1DChess --partition-worker setup parts=N part=I dir=path run=id, started by the former */
+    if (argc > 1 && (std::string_view(argv[1]) == "--partition" || std::string_view(argv[1]) == "--partition-worker"))
+    {
+        return runPartition(std::string_view(argv[1]) == "--partition-worker", argc, argv);
+    }
+
     GameState state;
     state.FinalizeGameState();
     char input = 0;
 
     EvaluationTree eval;
-    std::cout << "Evaluating whole game..." << std::endl;
-    eval.Evaluate(state);
-    std::cout << "Evaluation done!" << std::endl;
+    eval.SetVerbose(false);
+
+    /* Solve on a worker thread, so the game starts right away */
+    eval.StartEvaluation(state);
 
     do
     {
         std::cout << "------------------------------------" << std::endl;
+
+        if (eval.IsEvaluationRunning())
+        {
+            /* Solve what the user looks at first */
+            eval.RequestPriority(state);
+            std::cout << "Evaluating in background, unknown evaluations are shown as ?" << std::endl;
+        }
+
         std::cout << state.GetBoard() << std::endl;
         
         std::cout << "Eval: " << evalGameState(state, eval) << std::endl;
@@ -76,20 +204,28 @@ int main()
         std::vector<Move> moves = state.GetMoves();
         for (int i = 0; i < moves.size(); i++)
         {       
-            GameState newGameState = state;
-            newGameState.MakeMove(moves[i]);
-            newGameState.FinalizeGameState();
-            
-
             std::cout << i + 1 << ": " << moves[i];
 
-            std::cout << " (" << evalGameState(newGameState, eval) << ")";
+            /* Move outcomes are stored by the solver. Only positions it never expanded need the successor state */
+            int value = eval.GetMoveEvaluation(state, i);
+            if (value != -2)
+            {
+                std::cout << " (" << gEvalTable[value + 2] << ")";
+            }
+            else
+            {
+                GameState newGameState = state;
+                newGameState.MakeMove(moves[i]);
+                newGameState.FinalizeGameState();
+
+                std::cout << " (" << evalGameState(newGameState, eval) << ")";
+            }
 
             std::cout << std::endl;
 		}
 
 		/* Ask for user input */
-		std::cout << "Please enter the number of the move you want to make: ";
+		std::cout << "Please enter the number of the move you want to make (e = engine move, q = quit): ";
 		std::cin >> input;
 		
         if (input == 'q')
@@ -97,12 +233,17 @@ int main()
 			break;
 		}
 
-        int number = input - '1';
+        /* Let the solver pick */
+        int number = input == 'e' ? eval.GetBestMove(state) : input - '1';
         if (number >= 0 && number < moves.size())
         {
 			state.MakeMove(moves[number]);
             state.FinalizeGameState();
 		}
+        else if (input == 'e')
+        {
+            std::cout << "Engine move not known yet!" << std::endl;
+        }
         else
         {
 			std::cout << "Invalid move!" << std::endl;
@@ -0,0 +1,447 @@
+#include "AnalysisModes.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <random>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "AnytimeSearch.h"
+#include "BitslicedRules.h"
+#include "CommandLine.h"
+#include "CompressedTable.h"
+#include "FrontierSolver.h"
+#include "LayoutReport.h"
+#include "LineExtractor.h"
+#include "MappedTable.h"
+
+/* Bit-sliced rules for one board size and lane type: Compare with GameState on every position of the setup's layout and time both */
+template<int Size, class Lanes>
+int runBitslicedOfSize(const std::string& setup, int argc, char* argv[])
+{
+	PositionLayout<Size> layout = PositionLayout<Size>::FromSetup(setup);
+	if (!layout.IsValid())
+	{
+		std::cerr << "Setup can't be indexed: " << setup << std::endl;
+		return 1;
+	}
+	int rounds = std::max(1, getIntOption(argc, argv, "rounds", 1));
+
+	/* Every board of the layout once, legal or not. Repetition is the lowest digit, so even indices are the first repetition */
+	std::vector<BasicBoard<Size>> boards;
+	std::vector<Color> players;
+	for (int64_t index = 0; index < layout.GetCount(); index += 2)
+	{
+		BasicBoard<Size> board;
+		Color nextPlayer;
+		int repetitionCount;
+		if (layout.Decode(index, board, nextPlayer, repetitionCount))
+		{
+			boards.push_back(board);
+			players.push_back(nextPlayer);
+		}
+	}
+	size_t count = boards.size();
+
+	/* Scalar rules, keeping the states for the comparison */
+	std::vector<BasicGameState<Size>> states(count);
+	auto start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (size_t i = 0; i < count; i++)
+		{
+			states[i] = BasicGameState<Size>(boards[i], players[i]);
+			if (states[i].IsValidState())
+			{
+				states[i].FinalizeGameState();
+			}
+		}
+	}
+	double scalarSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	/* Bit-sliced rules, one batch of lanes at a time */
+	BitslicedRules<Size, Lanes> rules;
+	constexpr int LANE_COUNT = BitslicedRules<Size, Lanes>::LANE_COUNT;
+	size_t batchesWithMoves = 0;
+	start = std::chrono::steady_clock::now();
+	for (int round = 0; round < rounds; round++)
+	{
+		for (size_t first = 0; first < count; first += LANE_COUNT)
+		{
+			rules.Clear();
+			for (size_t i = first; i < count && i < first + LANE_COUNT; i++)
+			{
+				rules.SetPosition(static_cast<int>(i - first), boards[i], players[i]);
+			}
+			rules.Evaluate();
+			batchesWithMoves += IsEmpty(rules.GetHasMoves()) ? 0 : 1;
+		}
+	}
+	double bitslicedSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	/* Compare lane by lane */
+	size_t valid = 0;
+	size_t mismatches = 0;
+	for (size_t first = 0; first < count; first += LANE_COUNT)
+	{
+		rules.Clear();
+		for (size_t i = first; i < count && i < first + LANE_COUNT; i++)
+		{
+			rules.SetPosition(static_cast<int>(i - first), boards[i], players[i]);
+		}
+		rules.Evaluate();
+
+		for (size_t i = first; i < count && i < first + LANE_COUNT; i++)
+		{
+			const BasicGameState<Size>& state = states[i];
+			int lane = static_cast<int>(i - first);
+
+			bool bMatch = GetLane(rules.GetValid(), lane) == state.IsValidState();
+			if (bMatch && state.IsValidState())
+			{
+				valid++;
+				bMatch = GetLane(rules.GetInCheck(), lane) == state.IsInCheck()
+					&& rules.GetMoveCount(lane) == static_cast<int>(state.GetMoves().size())
+					&& GetLane(rules.GetMate(), lane) == state.IsMate()
+					&& (GetLane(rules.GetStalemate(), lane) || GetLane(rules.GetInsufficientMaterial(), lane)) == state.IsDraw();
+				for (const Move& move : state.GetMoves())
+				{
+					bMatch = bMatch && GetLane(rules.GetMoves(move.from, move.to), lane);
+				}
+			}
+
+			if (!bMatch)
+			{
+				if (mismatches < 10)
+				{
+					std::cout << "Mismatch: " << boards[i] << (players[i] == Color::White ? " w" : " b") << std::endl;
+				}
+				mismatches++;
+			}
+		}
+	}
+
+	double positions = static_cast<double>(count) * rounds;
+	std::cout << "Positions: " << count << " (" << valid << " legal), " << rounds << " round(s), " << batchesWithMoves << " batches with moves" << std::endl;
+	std::cout << "GameState positions/s: " << positions / (scalarSeconds > 0.0 ? scalarSeconds : 1e-9) << std::endl;
+	std::cout << "Bit-sliced (" << LANE_COUNT << " lanes) positions/s: " << positions / (bitslicedSeconds > 0.0 ? bitslicedSeconds : 1e-9) << std::endl;
+	std::cout << "Speedup: " << scalarSeconds / (bitslicedSeconds > 0.0 ? bitslicedSeconds : 1e-9) << std::endl;
+	std::cout << "Mismatches: " << mismatches << std::endl;
+
+	return mismatches == 0 ? 0 : 1;
+}
+
+int runBitsliced(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	bool bWide = getIntOption(argc, argv, "lanes", 64) == 256;
+
+	return dispatchBySize(setup, [&](auto size)
+	{
+		constexpr int Size = decltype(size)::value;
+		return bWide ? runBitslicedOfSize<Size, Lanes256>(setup, argc, argv) : runBitslicedOfSize<Size, uint64_t>(setup, argc, argv);
+	});
+}
+
+/* Locality mode for one board size: Table walk, frontier solve (with and without prefetching) and depth-first solve of both layout orders */
+template<int Size>
+int runLocalityOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	uint64_t maxPositions = static_cast<uint64_t>(getIntOption(argc, argv, "max", INT_MAX));
+	std::string tables[2];
+	std::string searchTables[2];
+
+	for (LayoutOrder order : { LayoutOrder::Setup, LayoutOrder::Locality })
+	{
+		PositionLayout<Size> layout = PositionLayout<Size>::FromSetup(setup, order);
+		if (!layout.IsValid())
+		{
+			std::cerr << "Setup can't be indexed: " << setup << std::endl;
+			return 1;
+		}
+
+		std::cout << (order == LayoutOrder::Setup ? "Setup" : "Locality") << " order ";
+		LayoutReport<Size>::PrintOrder(std::cout, layout);
+		std::cout << std::endl;
+		LayoutReport<Size>::PrintStats(std::cout, LayoutReport<Size>::Measure(layout, maxPositions));
+
+		for (bool bPrefetch : { false, true })
+		{
+			FrontierSolver<Size> solver(board, order);
+			solver.SetPrefetch(bPrefetch);
+			if (solver.Run() == -2)
+			{
+				std::cerr << "Setup is no legal position: " << setup << std::endl;
+				return 1;
+			}
+			std::cout << "Frontier solve" << (bPrefetch ? " with" : " without") << " prefetching: expansion " << solver.GetExpandSeconds()
+				<< " s, propagation " << solver.GetPropagateSeconds() << " s" << std::endl;
+
+			std::ostringstream table;
+			solver.ExportTable(table);
+			tables[order == LayoutOrder::Setup ? 0 : 1] = table.str();
+		}
+
+		BasicEvaluationTree<Size> tree(board, order);
+		BasicGameState<Size> state(board, Color::White);
+		state.FinalizeGameState();
+		tree.SetVerbose(false);
+
+		auto start = std::chrono::steady_clock::now();
+		tree.Evaluate(state);
+		double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+		std::cout << "Depth-first solve: " << seconds << " s" << std::endl;
+
+		std::ostringstream table;
+		tree.SaveTable(table);
+		searchTables[order == LayoutOrder::Setup ? 0 : 1] = table.str();
+		std::cout << std::endl;
+	}
+
+	/* Both orders must solve to the same table */
+	bool bMatch = tables[0] == tables[1] && searchTables[0] == searchTables[1];
+	std::cout << "Tables " << (bMatch ? "match" : "differ") << std::endl;
+	return bMatch ? 0 : 1;
+}
+
+int runLocality(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runLocalityOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Anytime mode for one board size: Iterative deepening within a time or node budget */
+template<int Size>
+int runAnytimeOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	AnytimeSearchConfig config;
+	config.seconds = getIntOption(argc, argv, "time", static_cast<int>(config.seconds * 1000)) / 1000.0;
+	config.maxNodes = static_cast<uint64_t>(std::max(0, getIntOption(argc, argv, "nodes", 0)));
+	config.maxDepth = getIntOption(argc, argv, "depth", config.maxDepth);
+	config.memoryBytes = static_cast<size_t>(std::max(1, getIntOption(argc, argv, "memory", static_cast<int>(config.memoryBytes >> 20)))) << 20;
+	AnytimeSearch<Size> search(config);
+
+	BasicGameState<Size> state(board, Color::White);
+	state.FinalizeGameState();
+
+	/* Cancel from another thread, like a user interrupting */
+	std::thread canceller;
+	int cancelMilliseconds = getIntOption(argc, argv, "cancel", 0);
+	if (cancelMilliseconds > 0)
+	{
+		canceller = std::thread([&search, cancelMilliseconds]()
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(cancelMilliseconds));
+			search.Cancel();
+		});
+	}
+
+	AnytimeSearchResult result = search.Run(state, &std::cout);
+	if (canceller.joinable())
+	{
+		canceller.join();
+	}
+
+	std::cout << setup << ": ";
+	if (result.moveNumber >= 0)
+	{
+		std::cout << "best move " << result.move << ", ";
+	}
+	if (result.IsProven())
+	{
+		std::cout << (result.lowerBound == 1 ? "White wins" : result.lowerBound == -1 ? "Black wins" : "Draw") << " (proven)" << std::endl;
+	}
+	else
+	{
+		std::cout << "value in [" << result.lowerBound << ", " << result.upperBound << "]" << (result.bPathDependent ? ", relies on a repetition" : "") << std::endl;
+	}
+	std::cout << "Depth: " << result.depth << ", nodes: " << result.nodes << ", " << result.seconds << " s" << (result.bStopped ? ", stopped" : "") << std::endl;
+
+	/* Reference solve with the index cache */
+	if (getIntOption(argc, argv, "compare", 0) != 0)
+	{
+		BasicEvaluationTree<Size> eval(board);
+		eval.SetVerbose(false);
+		int value = eval.Evaluate(state);
+		std::cout << "Indexed: " << value << std::endl;
+		return value >= result.lowerBound && value <= result.upperBound ? 0 : 1;
+	}
+
+	return 0;
+}
+
+int runAnytime(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runAnytimeOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Line mode for one board size: Optimal line and proof tree of a position, built from the solved cache */
+template<int Size>
+int runLineOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	BasicEvaluationTree<Size> eval(board);
+	if (!prepareTree(eval, board, setup, argc, argv))
+	{
+		return 1;
+	}
+
+	/* Any position of the setup's pieces, the setup itself by default */
+	BasicBoard<Size> position = board;
+	if (const char* text = findOption(argc, argv, "position"))
+	{
+		if (!BasicBoard<Size>::FromString(text, position))
+		{
+			std::cerr << "Invalid position " << text << std::endl;
+			return 1;
+		}
+	}
+	const char* side = findOption(argc, argv, "side");
+	BasicGameState<Size> state(position, side != nullptr && side[0] == 'b' ? Color::Black : Color::White);
+	state.FinalizeGameState();
+
+	LineExtractorConfig config;
+	config.maxDistance = getIntOption(argc, argv, "distance", config.maxDistance);
+	config.maxPlies = getIntOption(argc, argv, "plies", config.maxPlies);
+	config.maxProofNodes = getIntOption(argc, argv, "nodes", static_cast<int>(config.maxProofNodes));
+	LineExtractor<Size> lines(eval, config);
+
+	auto start = std::chrono::steady_clock::now();
+	int value = lines.GetValue(state);
+	std::cout << state.GetBoard() << ", " << (state.GetNextPlayer() == Color::White ? "white" : "black") << " to move: " << gEvalTable[value + 2] << std::endl;
+
+	int distance = lines.GetMateDistance(state);
+	if (distance >= 0)
+	{
+		std::cout << "Mate in " << distance << " plies" << std::endl;
+	}
+
+	std::vector<Move> line = lines.GetPrincipalVariation(state);
+	std::cout << "Line: ";
+	LineExtractor<Size>::PrintLine(std::cout, line);
+
+	if (getIntOption(argc, argv, "tree", 0) != 0)
+	{
+		ProofTreeNode root;
+		if (lines.GetProofTree(state, root))
+		{
+			LineExtractor<Size>::PrintProofTree(std::cout, root);
+		}
+		else
+		{
+			std::cout << "No proof tree: " << (distance < 0 ? "no win" : "more than " + std::to_string(config.maxProofNodes) + " nodes") << std::endl;
+		}
+	}
+
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	std::cout << "Extracted in " << seconds << " s, " << lines.GetBoundCount() << " positions searched" << std::endl;
+
+	return 0;
+}
+
+int runLine(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runLineOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+int runCompress(int argc, char* argv[])
+{
+	if (argc < 4)
+	{
+		std::cerr << "Usage: --compress table compressed [block=positions] [cache=blocks] [probes=N]" << std::endl;
+		return 1;
+	}
+
+	MappedTable table;
+	if (!table.Open(argv[2]))
+	{
+		std::cerr << "Could not open " << argv[2] << std::endl;
+		return 1;
+	}
+
+	/* Compressed tables are indexed by int */
+	if (table.GetPositionCount() > std::numeric_limits<int>::max())
+	{
+		std::cerr << argv[2] << " has too many positions to compress" << std::endl;
+		return 1;
+	}
+	int positionCount = static_cast<int>(table.GetPositionCount());
+
+	{
+		std::ofstream file(argv[3], std::ios::binary);
+		if (!file || !CompressedTable::Write(file, table.GetSetup(), table.GetEntries(), positionCount,
+			getIntOption(argc, argv, "block", CompressedTable::DEFAULT_BLOCK_POSITIONS)))
+		{
+			std::cerr << "Could not write " << argv[3] << std::endl;
+			return 1;
+		}
+	}
+
+	CompressedTable compressed;
+	if (!compressed.Open(argv[3], getIntOption(argc, argv, "cache", static_cast<int>(CompressedTable::DEFAULT_CACHED_BLOCKS))))
+	{
+		std::cerr << "Could not open " << argv[3] << std::endl;
+		return 1;
+	}
+
+	size_t rawBytes = table.GetEntryBytes();
+	std::cout << table.GetSetup() << ": " << table.GetPositionCount() << " positions in " << compressed.GetBlockCount() << " blocks of " << compressed.GetBlockPositions() << std::endl;
+	std::cout << "Entries: " << rawBytes << " bytes, compressed: " << compressed.GetFileBytes() << " bytes, ratio " << static_cast<double>(rawBytes) / compressed.GetFileBytes() << std::endl;
+
+	int mismatches = 0;
+	for (int index = 0; index < positionCount; index++)
+	{
+		mismatches += compressed.GetEntry(index) != table.GetEntry(index) ? 1 : 0;
+	}
+	std::cout << "Mismatches: " << mismatches << std::endl;
+
+	/* Fresh cache, so the hit rate is that of random probes only */
+	compressed.Open(argv[3], getIntOption(argc, argv, "cache", static_cast<int>(CompressedTable::DEFAULT_CACHED_BLOCKS)));
+	int probes = getIntOption(argc, argv, "probes", 1000000);
+	std::mt19937 random(1);
+	std::uniform_int_distribution<int> positions(0, positionCount - 1);
+	std::vector<int> indices(probes);
+	for (int& index : indices)
+	{
+		index = positions(random);
+	}
+
+	int sum = 0;
+	auto start = std::chrono::steady_clock::now();
+	for (int index : indices)
+	{
+		sum += compressed.GetEntry(index);
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	uint64_t loads = compressed.GetBlockLoads();
+	std::cout << "Random probes: " << probes << ", " << seconds * 1e6 / std::max(probes, 1) << " us per probe (checksum " << sum << ")" << std::endl;
+	std::cout << "Block loads: " << loads << ", hit rate " << 1.0 - static_cast<double>(loads) / std::max(probes, 1) << std::endl;
+
+	return mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+/* Modes measuring and explaining the solvers: bit-sliced rules, index locality, anytime search, lines and table compression. Arguments as given to main, options are "key=value" */
+
+/* Bit-sliced mode: Check the bit-sliced rules against GameState and compare the throughput */
+int runBitsliced(int argc, char* argv[]);
+
+/* Locality mode: Compare the index layouts for cache locality */
+int runLocality(int argc, char* argv[]);
+
+/* Anytime mode: Best move and proven bounds of a setup within a budget */
+int runAnytime(int argc, char* argv[]);
+
+/* Line mode: Show the optimal line and proof tree of a position */
+int runLine(int argc, char* argv[]);
+
+/* Compress mode: Write a compressed copy of a table file, check it entry by entry and measure random probes */
+int runCompress(int argc, char* argv[]);
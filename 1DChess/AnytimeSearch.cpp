@@ -0,0 +1,197 @@
+#include "AnytimeSearch.h"
+#include <algorithm>
+#include <numeric>
+#include <vector>
+
+template<int Size>
+AnytimeSearch<Size>::AnytimeSearch(const AnytimeSearchConfig& config) : m_config(config)
+{
+	TranspositionTableConfig tableConfig;
+	tableConfig.memoryBytes = config.memoryBytes;
+	m_table = std::make_unique<TranspositionTable>(tableConfig);
+}
+
+template<int Size>
+AnytimeSearchResult AnytimeSearch<Size>::Run(const GameState& state, std::ostream* progress)
+{
+	m_bCancel.store(false, std::memory_order_relaxed);
+	m_bStop = false;
+	m_nodes = 0;
+	m_start = std::chrono::steady_clock::now();
+
+	AnytimeSearchResult result;
+	if (state.IsGameOver())
+	{
+		int value = state.IsMate() ? (state.GetWinner() == Color::White ? 1 : -1) : 0;
+		result.lowerBound = value;
+		result.upperBound = value;
+		return result;
+	}
+
+	const std::vector<Move>& moves = state.GetMoves();
+	bool bWhite = state.GetNextPlayer() == Color::White;
+
+	/* Root moves in search order, the best of the last iteration first */
+	std::vector<int> order(moves.size());
+	std::iota(order.begin(), order.end(), 0);
+
+	for (int depth = 1; depth <= m_config.maxDepth && !result.IsProven(); depth++)
+	{
+		/* Bounds from the view of the side to move, so larger is better. The root takes the best of each bound,
+		 * the best move is the one with the best lower bound */
+		int bestMove = -1;
+		int bestLower = -2;
+		int bestUpper = -2;
+		int rootUpper = -1;
+		bool bPathDependent = false;
+
+		for (int moveNumber : order)
+		{
+			GameState successor = state;
+			successor.MakeMove(moves[moveNumber]);
+			successor.FinalizeGameState();
+
+			Bounds child = Search(successor, depth - 1);
+			if (m_bStop)
+			{
+				break;
+			}
+
+			int lower = bWhite ? child.lower : -child.upper;
+			int upper = bWhite ? child.upper : -child.lower;
+			rootUpper = std::max(rootUpper, upper);
+			bPathDependent = bPathDependent || child.bPathDependent;
+			if (lower > bestLower || (lower == bestLower && upper > bestUpper))
+			{
+				bestMove = moveNumber;
+				bestLower = lower;
+				bestUpper = upper;
+			}
+
+			/* A proven win is final, even if the iteration doesn't finish. Like in Search, it only depends on its own line */
+			if (bestLower == 1)
+			{
+				bPathDependent = child.bPathDependent;
+				break;
+			}
+		}
+
+		if (bestMove >= 0 && (!m_bStop || bestLower == 1))
+		{
+			result.moveNumber = bestMove;
+			result.move = moves[bestMove];
+			result.lowerBound = bWhite ? bestLower : -rootUpper;
+			result.upperBound = bWhite ? rootUpper : -bestLower;
+			result.depth = depth;
+			result.bPathDependent = bPathDependent;
+
+			auto best = std::find(order.begin(), order.end(), bestMove);
+			std::rotate(order.begin(), best, best + 1);
+		}
+
+		if (m_bStop)
+		{
+			break;
+		}
+
+		if (progress != nullptr)
+		{
+			*progress << "Depth " << depth << ": " << result.move << " [" << result.lowerBound << ", " << result.upperBound << "], "
+				<< m_nodes << " nodes, " << std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() << " s" << std::endl;
+		}
+	}
+
+	result.nodes = m_nodes;
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count();
+	result.bStopped = m_bStop && !result.IsProven();
+	return result;
+}
+
+template<int Size>
+typename AnytimeSearch<Size>::Bounds AnytimeSearch<Size>::Search(const GameState& state, int depth)
+{
+	if (state.IsGameOver())
+	{
+		int value = state.IsMate() ? (state.GetWinner() == Color::White ? 1 : -1) : 0;
+		return { value, value, state.IsDraw() && state.GetRepetitionCount() >= 3 };
+	}
+	if (depth <= 0 || IsOutOfBudget())
+	{
+		return { -1, 1, false };
+	}
+
+	uint64_t key = GetPositionKey(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount());
+	TranspositionEntry entry;
+	if (m_table->Probe(key, entry))
+	{
+		if (entry.depth >= depth)
+		{
+			return UnpackBounds(entry.value);
+		}
+	}
+	m_nodes++;
+
+	/* Maximum (white) or minimum (black) of both bounds over the moves */
+	bool bWhite = state.GetNextPlayer() == Color::White;
+	Bounds bounds = bWhite ? Bounds{ -1, -1, false } : Bounds{ 1, 1, false };
+	for (const Move& move : state.GetMoves())
+	{
+		GameState successor = state;
+		successor.MakeMove(move);
+		successor.FinalizeGameState();
+
+		Bounds child = Search(successor, depth - 1);
+		if (m_bStop)
+		{
+			return { -1, 1, false };
+		}
+
+		bounds.lower = bWhite ? std::max(bounds.lower, child.lower) : std::min(bounds.lower, child.lower);
+		bounds.upper = bWhite ? std::max(bounds.upper, child.upper) : std::min(bounds.upper, child.upper);
+		bounds.bPathDependent = bounds.bPathDependent || child.bPathDependent;
+
+		/* A proven win can't be improved. It holds on every path unless it relies on a repetition itself */
+		if (bWhite ? bounds.lower == 1 : bounds.upper == -1)
+		{
+			bounds.bPathDependent = child.bPathDependent;
+			break;
+		}
+	}
+
+	/* Bounds relying on a repetition are not stored at all, another path or iteration may reach the position without it */
+	if (!bounds.bPathDependent)
+	{
+		entry.value = PackBounds(bounds);
+		entry.depth = bounds.lower == bounds.upper ? PROVEN_DEPTH : depth;
+		m_table->Store(key, entry);
+	}
+
+	return bounds;
+}
+
+template<int Size>
+bool AnytimeSearch<Size>::IsOutOfBudget()
+{
+	if (m_bStop)
+	{
+		return true;
+	}
+
+	if (m_config.maxNodes > 0 && m_nodes >= m_config.maxNodes)
+	{
+		m_bStop = true;
+	}
+	/* The clock and other threads only every 1024 nodes */
+	else if (m_nodes % 1024 == 0)
+	{
+		m_bStop = m_bCancel.load(std::memory_order_relaxed)
+			|| (m_config.seconds > 0.0 && std::chrono::duration<double>(std::chrono::steady_clock::now() - m_start).count() >= m_config.seconds);
+	}
+
+	return m_bStop;
+}
+
+/* Supported board sizes */
+template class AnytimeSearch<8>;
+template class AnytimeSearch<10>;
+template class AnytimeSearch<12>;
@@ -0,0 +1,104 @@
+#pragma once
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include "Game.h"
+#include "TranspositionTable.h"
+
+struct AnytimeSearchConfig
+{
+	/* Wall-clock budget, 0 = none */
+	double seconds = 1.0;
+
+	/* Node budget, 0 = none */
+	uint64_t maxNodes = 0;
+
+	/* Last iteration */
+	int maxDepth = 1000;
+
+	/* Size of the transposition table holding the results between iterations */
+	size_t memoryBytes = 16 << 20;
+};
+
+struct AnytimeSearchResult
+{
+	/* Best known move of the root, number in GameState::GetMoves order. -1 if no iteration finished or the game is over */
+	int moveNumber = -1;
+	Move move = {};
+
+	/* What is proven about the root: -1, 0 or 1 for both, else the range the value lies in */
+	int lowerBound = -1;
+	int upperBound = 1;
+
+	/* Deepest finished iteration, in plies */
+	int depth = 0;
+
+	uint64_t nodes = 0;
+	double seconds = 0.0;
+
+	/* If the budget or Cancel ended the search before the value was proven */
+	bool bStopped = false;
+
+	/* The bounds rely on a draw by threefold repetition in the searched lines. They hold for this game, but are not
+	 * counted as proven, so deeper iterations go on */
+	bool bPathDependent = false;
+
+	bool IsProven() const { return lowerBound == upperBound && !bPathDependent; }
+};
+
+/* Search with a budget for latency-bound callers and setups too large to solve: Depth-limited minimax over the game states,
+ * one iteration per depth. A node returns bounds of its value: Exact at the end of the game, [-1, 1] at the depth limit.
+ * Results are kept in a TranspositionTable, so each iteration reuses what earlier ones proved, and searches the best
+ * root move of the previous iteration first. Runs until the root is proven or the budget is spent, then the last
+ * finished iteration (plus root moves proven to win meanwhile) gives the answer */
+template<int Size>
+class AnytimeSearch
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	explicit AnytimeSearch(const AnytimeSearchConfig& config = AnytimeSearchConfig());
+
+	/* Search a finalized state. Progress of every iteration goes to the stream, if any */
+	AnytimeSearchResult Run(const GameState& state, std::ostream* progress = nullptr);
+
+	/* Stop the running search as soon as possible, callable from any thread. Run returns the best known result */
+	void Cancel() { m_bCancel.store(true, std::memory_order_relaxed); }
+
+	/* Forget all results of earlier runs */
+	void Clear() { m_table->Clear(); }
+
+private:
+	struct Bounds
+	{
+		int lower;
+		int upper;
+
+		/* Derived from a draw by threefold repetition, which only holds for the path the search took */
+		bool bPathDependent;
+	};
+
+	/* Depth of proven entries, they are valid for every depth. Path dependent bounds are never stored */
+	static constexpr int PROVEN_DEPTH = 0xFFFF;
+
+	/* Bounds of a state within depth plies. Meaningless once m_bStop is set */
+	Bounds Search(const GameState& state, int depth);
+
+	/* Check the budget, sets m_bStop */
+	bool IsOutOfBudget();
+
+	static int PackBounds(const Bounds& bounds) { return (bounds.lower + 1) | ((bounds.upper + 1) << 2); }
+	static Bounds UnpackBounds(int value) { return { (value & 0b11) - 1, ((value >> 2) & 0b11) - 1, false }; }
+
+	AnytimeSearchConfig m_config;
+	std::unique_ptr<TranspositionTable> m_table;
+
+	std::atomic<bool> m_bCancel{ false };
+	bool m_bStop = false;
+
+	uint64_t m_nodes = 0;
+	std::chrono::steady_clock::time_point m_start;
+};
@@ -0,0 +1,133 @@
+#include "ArchiveModes.h"
+#include <algorithm>
+#include <fstream>
+#include <iostream>
+#include <random>
+#include <string>
+#include <vector>
+#include "CommandLine.h"
+#include "GameAnnotator.h"
+#include "GameArchive.h"
+
+/* Record mode for one board size */
+template<int Size>
+int runRecordOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	/* Solved, not loaded: Best moves come from the move cache */
+	BasicEvaluationTree<Size> eval(board);
+	eval.SetVerbose(false);
+	BasicGameState<Size> start(board, Color::White);
+	start.FinalizeGameState();
+	eval.Evaluate(start);
+
+	int games = getIntOption(argc, argv, "games", 10000);
+	int maxPlies = std::min(getIntOption(argc, argv, "maxplies", 200), GameArchive::MAX_PLIES);
+	double randomMoveRate = getDoubleOption(argc, argv, "random", 0.2);
+	std::mt19937_64 rng(static_cast<unsigned int>(getIntOption(argc, argv, "seed", 1)));
+
+	std::ofstream file(argv[2], std::ios::binary);
+	if (!file || !GameArchive::WriteHeader(file))
+	{
+		std::cerr << "Could not write " << argv[2] << std::endl;
+		return 1;
+	}
+
+	/* Perfect play with random mistakes, so there are blunders to find */
+	std::vector<Move> moves;
+	for (int game = 0; game < games; game++)
+	{
+		BasicGameState<Size> state = start;
+		moves.clear();
+		while (!state.IsGameOver() && static_cast<int>(moves.size()) < maxPlies)
+		{
+			int number = std::uniform_real_distribution<double>(0.0, 1.0)(rng) < randomMoveRate ? -1 : eval.GetBestMove(state);
+			if (number < 0)
+			{
+				number = static_cast<int>(rng() % state.GetMoves().size());
+			}
+			moves.push_back(state.GetMoves()[number]);
+			state.MakeMove(moves.back());
+			state.FinalizeGameState();
+		}
+		GameArchive::WriteGame(file, Size, Color::White, board.Pack(), moves);
+	}
+
+	std::cout << "Games: " << games << std::endl;
+	return file ? 0 : 1;
+}
+
+/* Annotate mode for one board size */
+template<int Size>
+int runAnnotateOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	GameArchive archive;
+	if (!archive.Open(argv[2]))
+	{
+		std::cerr << "Could not open " << argv[2] << std::endl;
+		return 1;
+	}
+
+	BasicEvaluationTree<Size> eval(board);
+	if (!prepareTree(eval, board, setup, argc, argv))
+	{
+		return 1;
+	}
+
+	GameAnnotatorConfig config;
+	config.threads = getIntOption(argc, argv, "threads", config.threads);
+	config.batchGames = getIntOption(argc, argv, "batch", config.batchGames);
+	config.bDistance = getIntOption(argc, argv, "dtm", 0) != 0;
+	config.maxDistance = getIntOption(argc, argv, "distance", config.maxDistance);
+	GameAnnotator<Size> annotator(eval, config);
+
+	GameAnnotatorResult result;
+	if (const char* path = findOption(argc, argv, "out"))
+	{
+		std::ofstream file(path);
+		if (!file)
+		{
+			std::cerr << "Could not open " << path << std::endl;
+			return 1;
+		}
+		result = annotator.Run(archive, file);
+	}
+	else
+	{
+		result = annotator.Run(archive, std::cout);
+	}
+
+	GameAnnotator<Size>::PrintResult(result, std::cerr);
+	return 0;
+}
+
+int runArchive(bool bAnnotate, int argc, char* argv[])
+{
+	if (argc < 3)
+	{
+		std::cerr << "Usage: " << argv[1] << " archive [setup=...] [options]" << std::endl;
+		return 1;
+	}
+
+	const char* setupOption = findOption(argc, argv, "setup");
+	std::string setup = setupOption != nullptr ? std::string(setupOption) : std::string(STARTING_SETUP);
+
+	return dispatchBySize(setup, [&](auto size)
+	{
+		constexpr int Size = decltype(size)::value;
+		return bAnnotate ? runAnnotateOfSize<Size>(setup, argc, argv) : runRecordOfSize<Size>(setup, argc, argv);
+	});
+}
@@ -0,0 +1,6 @@
+#pragma once
+
+/* Game archive modes, see GameArchive and GameAnnotator. Arguments as given to main, options are "key=value" */
+
+/* Archive modes: --record writes games of a setup to an archive, --annotate tags every ply of the games in one */
+int runArchive(bool bAnnotate, int argc, char* argv[]);
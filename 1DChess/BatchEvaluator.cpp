@@ -0,0 +1,159 @@
+#include "BatchEvaluator.h"
+#include <cstring>
+#include <vector>
+#include "CommandLine.h"
+
+namespace
+{
+	/* Size of a single read from the input stream */
+	constexpr size_t READ_BUFFER_SIZE = 1 << 20;
+
+	/* Output is written when the buffer exceeds this size */
+	constexpr size_t WRITE_BUFFER_SIZE = 1 << 16;
+
+	/* Get next whitespace separated token, advances the line */
+	std::string_view NextToken(std::string_view& line)
+	{
+		size_t begin = line.find_first_not_of(" \t");
+		if (begin == std::string_view::npos)
+		{
+			line = {};
+			return {};
+		}
+
+		size_t end = line.find_first_of(" \t", begin);
+		if (end == std::string_view::npos)
+		{
+			end = line.size();
+		}
+
+		std::string_view token = line.substr(begin, end - begin);
+		line.remove_prefix(end);
+		return token;
+	}
+}
+
+size_t BatchEvaluator::Run(std::istream& input, std::ostream& output)
+{
+	m_lineCount = 0;
+	m_output.clear();
+	m_output.reserve(WRITE_BUFFER_SIZE * 2);
+
+	/* Lines are parsed in place from the read buffer. An incomplete line at the end of a chunk is moved to the front */
+	std::vector<char> buffer(READ_BUFFER_SIZE);
+	size_t carry = 0;
+
+	while (true)
+	{
+		input.read(buffer.data() + carry, buffer.size() - carry);
+		size_t filled = carry + static_cast<size_t>(input.gcount());
+		bool bEnd = filled == carry;
+
+		const char* begin = buffer.data();
+		const char* end = buffer.data() + filled;
+		const char* newline;
+
+		while ((newline = static_cast<const char*>(std::memchr(begin, '\n', end - begin))) != nullptr)
+		{
+			EvaluateLine(std::string_view(begin, newline - begin));
+			begin = newline + 1;
+
+			if (m_output.size() >= WRITE_BUFFER_SIZE)
+			{
+				Flush(output);
+			}
+		}
+
+		carry = end - begin;
+
+		/* Last line without newline, or a line not fitting in the buffer at all */
+		if ((bEnd && carry > 0) || carry == buffer.size())
+		{
+			EvaluateLine(std::string_view(begin, carry));
+			carry = 0;
+		}
+		else if (carry > 0)
+		{
+			std::memmove(buffer.data(), begin, carry);
+		}
+
+		if (bEnd)
+		{
+			break;
+		}
+	}
+
+	Flush(output);
+	output.flush();
+
+	return m_lineCount;
+}
+
+void BatchEvaluator::EvaluateLine(std::string_view line)
+{
+	m_lineCount++;
+
+	/* Windows line endings */
+	if (!line.empty() && line.back() == '\r')
+	{
+		line.remove_suffix(1);
+	}
+
+	std::string_view boardToken = NextToken(line);
+	std::string_view colorToken = NextToken(line);
+	std::string_view repetitionToken = NextToken(line);
+
+	Board board;
+	bool bValid = Board::FromString(boardToken, board) && colorToken.size() == 1 && (colorToken[0] == 'w' || colorToken[0] == 'b');
+
+	int repetitionCount = 1;
+	if (!repetitionToken.empty())
+	{
+		bValid = bValid && repetitionToken.size() == 1 && (repetitionToken[0] == '1' || repetitionToken[0] == '2');
+		repetitionCount = repetitionToken[0] - '0';
+	}
+
+	/* Trailing garbage */
+	bValid = bValid && NextToken(line).empty();
+
+	if (!bValid)
+	{
+		m_output.append("invalid\n");
+		return;
+	}
+
+	Color nextPlayer = colorToken[0] == 'w' ? Color::White : Color::Black;
+
+	/* Fast path: Direct cache lookup without any move generation */
+	int value = m_eval.GetPositionEvaluation(board, nextPlayer, repetitionCount);
+
+	if (value == -2)
+	{
+		/* Terminal positions are not cached, so check with the rules */
+		GameState state(board, nextPlayer);
+		if (!state.IsValidState())
+		{
+			m_output.append("invalid\n");
+			return;
+		}
+
+		state.FinalizeGameState();
+		if (state.IsMate())
+		{
+			value = state.GetWinner() == Color::White ? 1 : -1;
+		}
+		else if (state.IsDraw())
+		{
+			value = 0;
+		}
+	}
+
+	m_output.append(gEvalTable[value + 2]);
+	m_output.push_back('\n');
+}
+
+void BatchEvaluator::Flush(std::ostream& output)
+{
+	output.write(m_output.data(), m_output.size());
+	m_output.clear();
+}
@@ -0,0 +1,32 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <string_view>
+#include "EvaluationTree.h"
+
+/* Non-interactive evaluation of a stream of positions.
+ * Every input line holds a board in stream notation, the side to move (w/b) and optionally the repetition count (1/2),
+ * e.g. "KNR..rnk w" or "K.R.n.rk b 2".
+ * Every line is answered with one output line: 1, 0, -1, ? (not evaluated) or invalid */
+class BatchEvaluator
+{
+public:
+	BatchEvaluator(EvaluationTree& eval) : m_eval(eval), m_lineCount(0) {}
+
+	/* Process the whole input stream. Returns number of processed lines */
+	size_t Run(std::istream& input, std::ostream& output);
+
+private:
+	/* Evaluate a single line, result is appended to the output buffer */
+	void EvaluateLine(std::string_view line);
+
+	/* Write buffered output */
+	void Flush(std::ostream& output);
+
+	EvaluationTree& m_eval;
+
+	/* Output buffer, written in large chunks */
+	std::string m_output;
+
+	size_t m_lineCount;
+};
@@ -0,0 +1,235 @@
+#include "BitslicedRules.h"
+
+template<int Size, class Lanes>
+void BitslicedRules<Size, Lanes>::Clear()
+{
+	m_whiteToMove = Zero();
+	for (int piece = 0; piece < 6; piece++)
+	{
+		for (int field = 0; field < Size; field++)
+		{
+			m_pieces[piece][field] = Zero();
+		}
+	}
+}
+
+template<int Size, class Lanes>
+void BitslicedRules<Size, Lanes>::SetPosition(int lane, const Board& board, Color nextPlayer)
+{
+	for (int field = 0; field < Size; field++)
+	{
+		Piece piece = board.GetPiece(field);
+		if (piece != Piece::None)
+		{
+			SetLane(m_pieces[static_cast<int>(piece) - 1][field], lane);
+		}
+	}
+
+	if (nextPlayer == Color::White)
+	{
+		SetLane(m_whiteToMove, lane);
+	}
+}
+
+template<int Size, class Lanes>
+void BitslicedRules<Size, Lanes>::Evaluate()
+{
+	Lanes whiteToMove = m_whiteToMove;
+	Lanes blackToMove = ~m_whiteToMove;
+
+	/* Relative planes, index of Piece - 1: White rook, knight, king, then black */
+	Lanes own[Size];
+	m_anyNotKing = Zero();
+	for (int field = 0; field < Size; field++)
+	{
+		for (int type = 0; type < 3; type++)
+		{
+			m_planes[OwnRook + type][field] = (m_pieces[type][field] & whiteToMove) | (m_pieces[type + 3][field] & blackToMove);
+			m_planes[EnemyRook + type][field] = (m_pieces[type + 3][field] & whiteToMove) | (m_pieces[type][field] & blackToMove);
+		}
+
+		own[field] = m_planes[OwnRook][field] | m_planes[OwnKnight][field] | m_planes[OwnKing][field];
+		m_occupied[field] = own[field] | m_planes[EnemyRook][field] | m_planes[EnemyKnight][field] | m_planes[EnemyKing][field];
+		m_anyNotKing |= m_planes[OwnRook][field] | m_planes[OwnKnight][field] | m_planes[EnemyRook][field] | m_planes[EnemyKnight][field];
+	}
+
+	/* Exactly one king per side: Seen once, but not twice */
+	Lanes ownKingSeen = Zero();
+	Lanes ownKingTwice = Zero();
+	Lanes enemyKingSeen = Zero();
+	Lanes enemyKingTwice = Zero();
+	for (int field = 0; field < Size; field++)
+	{
+		ownKingTwice |= ownKingSeen & m_planes[OwnKing][field];
+		ownKingSeen |= m_planes[OwnKing][field];
+		enemyKingTwice |= enemyKingSeen & m_planes[EnemyKing][field];
+		enemyKingSeen |= m_planes[EnemyKing][field];
+	}
+
+	/* Checks on both sides */
+	Lanes enemyInCheck = IsKingAttacked(m_planes[EnemyKing], m_planes[OwnRook], m_planes[OwnKnight], m_planes[OwnKing], m_occupied);
+	m_inCheck = IsKingAttacked(m_planes[OwnKing], m_planes[EnemyRook], m_planes[EnemyKnight], m_planes[EnemyKing], m_occupied);
+	m_valid = ownKingSeen & ~ownKingTwice & enemyKingSeen & ~enemyKingTwice & ~enemyInCheck;
+
+	/* Moves: Candidates by piece movement like GameState::CalculateTargetFields, then the legality test */
+	m_hasMoves = Zero();
+	for (int from = 0; from < Size; from++)
+	{
+		for (int to = 0; to < Size; to++)
+		{
+			m_moves[from][to] = Zero();
+		}
+
+		for (int to : { from - 1, from + 1 })
+		{
+			if (to >= 0 && to < Size)
+			{
+				m_moves[from][to] |= m_planes[OwnKing][from] & ~own[to];
+			}
+		}
+
+		for (int to : { from - 2, from + 2 })
+		{
+			if (to >= 0 && to < Size)
+			{
+				m_moves[from][to] |= m_planes[OwnKnight][from] & ~own[to];
+			}
+		}
+
+		/* Rook rays, the rook stays in the lanes where the path is free */
+		Lanes reach = m_planes[OwnRook][from];
+		for (int to = from + 1; to < Size && !IsEmpty(reach); to++)
+		{
+			m_moves[from][to] |= reach & ~own[to];
+			reach &= ~m_occupied[to];
+		}
+		reach = m_planes[OwnRook][from];
+		for (int to = from - 1; to >= 0 && !IsEmpty(reach); to--)
+		{
+			m_moves[from][to] |= reach & ~own[to];
+			reach &= ~m_occupied[to];
+		}
+
+		for (int to = 0; to < Size; to++)
+		{
+			m_moves[from][to] = GetLegalLanes(from, to, m_moves[from][to] & m_valid);
+			m_hasMoves |= m_moves[from][to];
+		}
+	}
+}
+
+template<int Size, class Lanes>
+int BitslicedRules<Size, Lanes>::GetMoveCount(int lane) const
+{
+	int count = 0;
+	for (int from = 0; from < Size; from++)
+	{
+		for (int to = 0; to < Size; to++)
+		{
+			count += GetLane(m_moves[from][to], lane) ? 1 : 0;
+		}
+	}
+	return count;
+}
+
+template<int Size, class Lanes>
+void BitslicedRules<Size, Lanes>::CalculateAttacks(const Lanes* rooks, const Lanes* knights, const Lanes* kings, const Lanes* occupied, Lanes* attacked)
+{
+	for (int field = 0; field < Size; field++)
+	{
+		attacked[field] = Zero();
+	}
+
+	for (int field = 0; field < Size; field++)
+	{
+		if (field >= 1)
+		{
+			attacked[field - 1] |= kings[field];
+		}
+		if (field + 1 < Size)
+		{
+			attacked[field + 1] |= kings[field];
+		}
+		if (field >= 2)
+		{
+			attacked[field - 2] |= knights[field];
+		}
+		if (field + 2 < Size)
+		{
+			attacked[field + 2] |= knights[field];
+		}
+	}
+
+	/* One sweep per direction: The ray carries on over free fields and starts anew at every rook */
+	Lanes ray = Zero();
+	for (int field = 0; field < Size; field++)
+	{
+		attacked[field] |= ray;
+		ray = (ray & ~occupied[field]) | rooks[field];
+	}
+	ray = Zero();
+	for (int field = Size - 1; field >= 0; field--)
+	{
+		attacked[field] |= ray;
+		ray = (ray & ~occupied[field]) | rooks[field];
+	}
+}
+
+template<int Size, class Lanes>
+Lanes BitslicedRules<Size, Lanes>::IsKingAttacked(const Lanes* kings, const Lanes* rooks, const Lanes* knights, const Lanes* enemyKings, const Lanes* occupied)
+{
+	Lanes attacked[Size];
+	CalculateAttacks(rooks, knights, enemyKings, occupied, attacked);
+
+	Lanes result = Zero();
+	for (int field = 0; field < Size; field++)
+	{
+		result |= kings[field] & attacked[field];
+	}
+	return result;
+}
+
+template<int Size, class Lanes>
+Lanes BitslicedRules<Size, Lanes>::GetLegalLanes(int from, int to, Lanes candidates) const
+{
+	if (IsEmpty(candidates))
+	{
+		return candidates;
+	}
+
+	/* The position after the move, valid in the candidate lanes. The target holds no own piece there */
+	Lanes kings[Size];
+	Lanes rooks[Size];
+	Lanes knights[Size];
+	Lanes enemyKings[Size];
+	Lanes occupied[Size];
+	for (int field = 0; field < Size; field++)
+	{
+		kings[field] = m_planes[OwnKing][field];
+		rooks[field] = m_planes[EnemyRook][field];
+		knights[field] = m_planes[EnemyKnight][field];
+		enemyKings[field] = m_planes[EnemyKing][field];
+		occupied[field] = m_occupied[field];
+	}
+
+	kings[to] |= kings[from];
+	kings[from] = Zero();
+	rooks[to] = Zero();
+	knights[to] = Zero();
+	occupied[from] = Zero();
+	occupied[to] = ~Zero();
+
+	/* Taking the king leaves an invalid state in GameState as well */
+	Lanes legal = candidates & ~enemyKings[to];
+	enemyKings[to] = Zero();
+
+	return legal & ~IsKingAttacked(kings, rooks, knights, enemyKings, occupied);
+}
+
+/* Supported board sizes, 64 and 256 lanes */
+template class BitslicedRules<8>;
+template class BitslicedRules<10>;
+template class BitslicedRules<12>;
+template class BitslicedRules<8, Lanes256>;
+template class BitslicedRules<10, Lanes256>;
+template class BitslicedRules<12, Lanes256>;
@@ -0,0 +1,109 @@
+#pragma once
+#include <cstdint>
+#include "Board.h"
+
+/* 256 lanes in four words. The operators are plain loops, with AVX2 enabled (/arch:AVX2, -mavx2) they become single instructions */
+struct Lanes256
+{
+	uint64_t words[4];
+
+	friend Lanes256 operator&(const Lanes256& a, const Lanes256& b) { return { { a.words[0] & b.words[0], a.words[1] & b.words[1], a.words[2] & b.words[2], a.words[3] & b.words[3] } }; }
+	friend Lanes256 operator|(const Lanes256& a, const Lanes256& b) { return { { a.words[0] | b.words[0], a.words[1] | b.words[1], a.words[2] | b.words[2], a.words[3] | b.words[3] } }; }
+	friend Lanes256 operator~(const Lanes256& a) { return { { ~a.words[0], ~a.words[1], ~a.words[2], ~a.words[3] } }; }
+	Lanes256& operator&=(const Lanes256& other) { return *this = *this & other; }
+	Lanes256& operator|=(const Lanes256& other) { return *this = *this | other; }
+};
+
+/* Lane access for both lane types */
+inline bool GetLane(uint64_t lanes, int lane) { return (lanes >> lane) & 1; }
+inline void SetLane(uint64_t& lanes, int lane) { lanes |= uint64_t(1) << lane; }
+inline bool IsEmpty(uint64_t lanes) { return lanes == 0; }
+
+inline bool GetLane(const Lanes256& lanes, int lane) { return (lanes.words[lane / 64] >> (lane % 64)) & 1; }
+inline void SetLane(Lanes256& lanes, int lane) { lanes.words[lane / 64] |= uint64_t(1) << (lane % 64); }
+inline bool IsEmpty(const Lanes256& lanes) { return (lanes.words[0] | lanes.words[1] | lanes.words[2] | lanes.words[3]) == 0; }
+
+/* The rules of BasicGameState for many positions at once, bit-sliced: Every piece kind has one word of lanes per field,
+ * lane i of all words is position i. Every rule is a handful of bitwise operations on whole words, so all lanes are decided together.
+ * Covers what GameState computes without history: Checks, validity (IsValidState), legal moves and mate, stalemate and material draws.
+ * Repetitions need the history and are up to the caller */
+template<int Size, class Lanes = uint64_t>
+class BitslicedRules
+{
+public:
+	using Board = BasicBoard<Size>;
+
+	static constexpr int LANE_COUNT = sizeof(Lanes) * 8;
+
+	BitslicedRules() { Clear(); }
+
+	/* Empty all lanes. Empty lanes have no kings and come out invalid */
+	void Clear();
+
+	/* Put a position into an empty lane */
+	void SetPosition(int lane, const Board& board, Color nextPlayer);
+
+	/* Calculate all results below for every lane */
+	void Evaluate();
+
+	/* Both kings there and the side not to move not in check, like GameState::IsValidState. The other results only hold for valid lanes */
+	Lanes GetValid() const { return m_valid; }
+
+	/* Side to move in check */
+	Lanes GetInCheck() const { return m_inCheck; }
+
+	/* Lanes where the move from -> to is legal for the side to move */
+	Lanes GetMoves(int from, int to) const { return m_moves[from][to]; }
+
+	/* Lanes with at least one legal move */
+	Lanes GetHasMoves() const { return m_hasMoves; }
+
+	/* Lanes where the side to move is mated, stalemated, or only kings are left (in the precedence of GameState) */
+	Lanes GetMate() const { return m_valid & ~m_hasMoves & m_inCheck; }
+	Lanes GetStalemate() const { return m_valid & ~m_hasMoves & ~m_inCheck; }
+	Lanes GetInsufficientMaterial() const { return m_valid & m_hasMoves & ~m_anyNotKing; }
+
+	/* Number of legal moves of a lane */
+	int GetMoveCount(int lane) const;
+
+private:
+	/* Pieces relative to the side to move, so the rules are written once for both colors */
+	enum Plane
+	{
+		OwnRook,
+		OwnKnight,
+		OwnKing,
+		EnemyRook,
+		EnemyKnight,
+		EnemyKing,
+		PLANE_COUNT
+	};
+
+	using Planes = Lanes[PLANE_COUNT][Size];
+
+	/* Fields attacked by the pieces of one side. Rook rays stop at the first piece of either color */
+	static void CalculateAttacks(const Lanes* rooks, const Lanes* knights, const Lanes* kings, const Lanes* occupied, Lanes* attacked);
+
+	/* Lanes where a king of kings is attacked by the given pieces of the other side */
+	static Lanes IsKingAttacked(const Lanes* kings, const Lanes* rooks, const Lanes* knights, const Lanes* enemyKings, const Lanes* occupied);
+
+	/* Legal lanes of move candidates from one field to another: The mover's king must not be attacked afterwards, no king is captured */
+	Lanes GetLegalLanes(int from, int to, Lanes candidates) const;
+
+	static Lanes Zero() { return Lanes{}; }
+
+	/* Lanes with white to move */
+	Lanes m_whiteToMove;
+
+	/* Pieces as given by SetPosition, by Piece value - 1 */
+	Lanes m_pieces[6][Size];
+
+	/* Results of Evaluate */
+	Planes m_planes;
+	Lanes m_occupied[Size];
+	Lanes m_valid;
+	Lanes m_inCheck;
+	Lanes m_hasMoves;
+	Lanes m_anyNotKing;
+	Lanes m_moves[Size][Size];
+};
@@ -1,30 +1,36 @@
 #include "Board.h"
 
-Board::Board()
+template<int Size>
+BasicBoard<Size>::BasicBoard()
 {
-	for (int i = 0; i < BOARD_SIZE; i++)
+	for (int i = 0; i < Size; i++)
 	{
 		m_board[i] = Piece::None;
 	}
 }
 
-Board::Board(const Board& position)
+template<int Size>
+BasicBoard<Size>::BasicBoard(const BasicBoard& position)
 {
 	std::copy(std::begin(position.m_board), std::end(position.m_board), m_board);
 }
 
-Board& Board::operator=(const Board& position)
+template<int Size>
+BasicBoard<Size>& BasicBoard<Size>::operator=(const BasicBoard& position)
 {
 	std::copy(std::begin(position.m_board), std::end(position.m_board), m_board);
+	return *this;
 }
 
-Board::~Board()
+template<int Size>
+BasicBoard<Size>::~BasicBoard()
 {
 }
 
-bool Board::operator==(const Board& position) const
+template<int Size>
+bool BasicBoard<Size>::operator==(const BasicBoard& position) const
 {
-	for (int i = 0; i < BOARD_SIZE; i++)
+	for (int i = 0; i < Size; i++)
 	{
 		if (m_board[i] != position.m_board[i])
 		{
@@ -34,7 +40,8 @@ bool Board::operator==(const Board& position) const
 	return true;
 }
 
-Piece Board::GetPiece(int position) const
+template<int Size>
+Piece BasicBoard<Size>::GetPiece(int position) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -45,7 +52,8 @@ Piece Board::GetPiece(int position) const
 	return m_board[position];
 }
 
-void Board::SetPiece(int position, Piece piece)
+template<int Size>
+void BasicBoard<Size>::SetPiece(int position, Piece piece)
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -56,30 +64,90 @@ void Board::SetPiece(int position, Piece piece)
 	m_board[position] = piece;
 }
 
-void Board::SetStartingPosition()
+template<int Size>
+void BasicBoard<Size>::SetStartingPosition()
 {
-	m_board[0] = Piece::WhiteKing;
-	m_board[1] = Piece::WhiteKnight;
-	m_board[2] = Piece::WhiteRook;
-	m_board[3] = Piece::None;
-	m_board[4] = Piece::None;
-	m_board[5] = Piece::BlackRook;
-	m_board[6] = Piece::BlackKnight;
-	m_board[7] = Piece::BlackKing;
+	constexpr std::array<char, Size> setup = GetStartingSetup<Size>();
+	FromString(std::string_view(setup.data(), Size), *this);
 }
 
-Board Board::GetStartingPosition()
+template<int Size>
+BasicBoard<Size> BasicBoard<Size>::GetStartingPosition()
 {
-	Board position;
+	BasicBoard position;
 	position.SetStartingPosition();
 	return position;
 }
 
-std::ostream& operator<<(std::ostream& os, const Board& position)
+template<int Size>
+typename BasicBoard<Size>::Packed BasicBoard<Size>::Pack() const
 {
-	for (int i = 0; i < BOARD_SIZE; i++)
+	Packed packed = 0;
+	for (int i = 0; i < Size; i++)
 	{
-		switch (position.m_board[i])
+		packed |= static_cast<Packed>(m_board[i]) << (i * 4);
+	}
+	return packed;
+}
+
+template<int Size>
+BasicBoard<Size> BasicBoard<Size>::Unpack(Packed packed)
+{
+	BasicBoard position;
+	for (int i = 0; i < Size; i++)
+	{
+		position.m_board[i] = static_cast<Piece>((packed >> (i * 4)) & 0xF);
+	}
+	return position;
+}
+
+template<int Size>
+bool BasicBoard<Size>::FromString(std::string_view text, BasicBoard& position)
+{
+	if (text.size() != Size)
+	{
+		return false;
+	}
+
+	/* Inverse of the stream operator */
+	for (int i = 0; i < Size; i++)
+	{
+		switch (text[i])
+		{
+		case '.':
+			position.m_board[i] = Piece::None;
+			break;
+		case 'R':
+			position.m_board[i] = Piece::WhiteRook;
+			break;
+		case 'N':
+			position.m_board[i] = Piece::WhiteKnight;
+			break;
+		case 'K':
+			position.m_board[i] = Piece::WhiteKing;
+			break;
+		case 'r':
+			position.m_board[i] = Piece::BlackRook;
+			break;
+		case 'n':
+			position.m_board[i] = Piece::BlackKnight;
+			break;
+		case 'k':
+			position.m_board[i] = Piece::BlackKing;
+			break;
+		default:
+			return false;
+		}
+	}
+	return true;
+}
+
+template<int Size>
+std::ostream& operator<<(std::ostream& os, const BasicBoard<Size>& position)
+{
+	for (int i = 0; i < Size; i++)
+	{
+		switch (position.GetPiece(i))
 		{
 		case Piece::None:
 			os << ".";
@@ -107,7 +175,8 @@ std::ostream& operator<<(std::ostream& os, const Board& position)
 	return os;
 }
 
-Color Board::GetColor(int position) const
+template<int Size>
+Color BasicBoard<Size>::GetColor(int position) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -130,7 +199,8 @@ Color Board::GetColor(int position) const
 	}
 }
 
-PieceType Board::GetPieceType(int position) const
+template<int Size>
+PieceType BasicBoard<Size>::GetPieceType(int position) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -154,12 +224,14 @@ PieceType Board::GetPieceType(int position) const
 	}
 }
 
-bool Board::IsOnBoard(int position) const
+template<int Size>
+bool BasicBoard<Size>::IsOnBoard(int position) const
 {
-	return position >= 0 && position < BOARD_SIZE;
+	return position >= 0 && position < Size;
 }
 
-bool Board::IsFree(int position) const
+template<int Size>
+bool BasicBoard<Size>::IsFree(int position) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -170,7 +242,8 @@ bool Board::IsFree(int position) const
 	return m_board[position] == Piece::None;
 }
 
-bool Board::IsOwnPiece(int position, Color color) const
+template<int Size>
+bool BasicBoard<Size>::IsOwnPiece(int position, Color color) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -186,7 +259,8 @@ bool Board::IsOwnPiece(int position, Color color) const
 	return GetColor(position) == color;
 }
 
-bool Board::IsEnemyPiece(int position, Color color) const
+template<int Size>
+bool BasicBoard<Size>::IsEnemyPiece(int position, Color color) const
 {
 	/* Range check */
 	if (!IsOnBoard(position))
@@ -200,4 +274,12 @@ bool Board::IsEnemyPiece(int position, Color color) const
 	}
 
 	return GetColor(position) != color;
-}
\ No newline at end of file
+}
+
+/* Supported board sizes */
+template class BasicBoard<8>;
+template class BasicBoard<10>;
+template class BasicBoard<12>;
+template std::ostream& operator<<(std::ostream& os, const BasicBoard<8>& position);
+template std::ostream& operator<<(std::ostream& os, const BasicBoard<10>& position);
+template std::ostream& operator<<(std::ostream& os, const BasicBoard<12>& position);
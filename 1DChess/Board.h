@@ -1,9 +1,36 @@
 #pragma once
 
+#include <array>
+#include <cstdint>
 #include <iostream>
+#include <string_view>
+#include <type_traits>
 
+/* Size of the standard board. Boards and rules are templates on the size, instantiated for 8, 10 and 12 fields (see end of Board.cpp and Game.cpp) */
 constexpr int BOARD_SIZE = 8;
 
+/* Starting position in stream notation */
+constexpr std::string_view STARTING_SETUP = "KNR..rnk";
+
+/* Starting position of any board size in stream notation: King, knight and rook at each end, free fields in the middle */
+template<int Size>
+constexpr std::array<char, Size> GetStartingSetup()
+{
+	static_assert(Size >= 6, "The starting pieces need 6 fields");
+	std::array<char, Size> setup = {};
+	for (int i = 0; i < Size; i++)
+	{
+		setup[i] = '.';
+	}
+	setup[0] = 'K';
+	setup[1] = 'N';
+	setup[2] = 'R';
+	setup[Size - 3] = 'r';
+	setup[Size - 2] = 'n';
+	setup[Size - 1] = 'k';
+	return setup;
+}
+
 /* Enum for pieces */
 enum class PieceType
 {
@@ -37,16 +64,23 @@ enum class Piece
 
 
 /* Board state for 1D-chess */
-class Board
+template<int Size>
+class BasicBoard
 {
 public:
-	Board();
-	Board(const Board& position);
-	Board& operator=(const Board& position);
-	~Board();
+	static constexpr int FieldCount = Size;
+
+	/* Board packed into one word: 4 bits per field holding the Piece value, field 0 in the lowest bits */
+	static_assert(Size <= 16, "Packed boards hold at most 16 fields");
+	using Packed = std::conditional_t<(Size <= 8), uint32_t, uint64_t>;
+
+	BasicBoard();
+	BasicBoard(const BasicBoard& position);
+	BasicBoard& operator=(const BasicBoard& position);
+	~BasicBoard();
 
 	/* Comparison for threefold repetition */
-	bool operator==(const Board& position) const;
+	bool operator==(const BasicBoard& position) const;
 
 	/* Get piece at position */
 	Piece GetPiece(int position) const;
@@ -72,16 +106,28 @@ public:
 	/* Is position on board */
 	bool IsOnBoard(int position) const;
 
-	/* Set to starting position */
+	/* Set to starting position, see GetStartingSetup */
 	void SetStartingPosition();
 
 	/* Static generator for starting board */
-	static Board GetStartingPosition();
+	static BasicBoard GetStartingPosition();
 
-	/* Stream operator to human readably print */
-	friend std::ostream& operator<<(std::ostream& os, const Board& position);
+	/* Binary encoding, see Packed */
+	Packed Pack() const;
+	static BasicBoard Unpack(Packed packed);
+
+	/* Parse the notation printed by the stream operator (e.g. "KNR..rnk"). Returns false if the text is no board */
+	static bool FromString(std::string_view text, BasicBoard& position);
 
 private:
-	Piece m_board[BOARD_SIZE];
+	Piece m_board[Size];
+
+};
+
+/* Stream operator to human readably print */
+template<int Size>
+std::ostream& operator<<(std::ostream& os, const BasicBoard<Size>& position);
 
-};
\ No newline at end of file
+/* The standard board */
+using Board = BasicBoard<BOARD_SIZE>;
+using PackedBoard = Board::Packed;
@@ -0,0 +1,103 @@
+#include "BucketStore.h"
+#include <algorithm>
+#include <cstdio>
+
+BucketStore::~BucketStore()
+{
+	Remove();
+}
+
+bool BucketStore::Create(const std::string& path, size_t bucketCount, size_t recordWords, size_t bufferRecords)
+{
+	Remove();
+
+	m_path = path;
+	m_recordWords = std::max<size_t>(1, recordWords);
+	m_bufferRecords = std::max<size_t>(1, bufferRecords);
+	m_buckets.clear();
+	m_buckets.resize(bucketCount);
+	m_freeBlocks.clear();
+	m_blockCount = 0;
+
+	/* Open for the whole solve, blocks are written and read in place */
+	m_file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	m_bFailed = !m_file;
+	return !m_bFailed;
+}
+
+void BucketStore::Remove()
+{
+	if (m_file.is_open())
+	{
+		m_file.close();
+		std::remove(m_path.c_str());
+	}
+	m_buckets.clear();
+	m_freeBlocks.clear();
+}
+
+void BucketStore::Append(size_t bucket, const uint64_t* record)
+{
+	Bucket& current = m_buckets[bucket];
+	current.buffer.insert(current.buffer.end(), record, record + m_recordWords);
+	current.records++;
+
+	if (current.buffer.size() >= m_bufferRecords * m_recordWords)
+	{
+		FlushBucket(current);
+	}
+}
+
+bool BucketStore::FlushBucket(Bucket& bucket)
+{
+	if (m_bFailed)
+	{
+		return false;
+	}
+
+	uint64_t block = m_blockCount;
+	if (!m_freeBlocks.empty())
+	{
+		block = m_freeBlocks.back();
+		m_freeBlocks.pop_back();
+	}
+	else
+	{
+		m_blockCount++;
+	}
+
+	size_t bytes = bucket.buffer.size() * sizeof(uint64_t);
+	m_file.seekp(static_cast<std::streamoff>(block * bytes));
+	m_file.write(reinterpret_cast<const char*>(bucket.buffer.data()), bytes);
+	if (!m_file)
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	m_bytesWritten += bytes;
+	bucket.blocks.push_back(block);
+	bucket.buffer.clear();
+	return true;
+}
+
+bool BucketStore::ReadBlock(uint64_t block)
+{
+	if (m_bFailed)
+	{
+		return false;
+	}
+
+	m_readBlock.resize(m_bufferRecords * m_recordWords);
+	size_t bytes = m_readBlock.size() * sizeof(uint64_t);
+	m_file.seekg(static_cast<std::streamoff>(block * bytes));
+	m_file.read(reinterpret_cast<char*>(m_readBlock.data()), bytes);
+	if (!m_file)
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	m_bytesRead += bytes;
+	return true;
+}
@@ -0,0 +1,111 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+
+/* Records of a fixed number of 64 bit words in many buckets on disk, all in one file.
+ * Appends are buffered per bucket. A full buffer is written as one block of the file, so every block has the same size,
+ * and a bucket is the list of its blocks plus its buffer. Drain reads a bucket back in the order of appending and empties it,
+ * its blocks are reused by later appends. Records appended meanwhile (even to the same bucket) are kept for the next Drain.
+ * StreamingSolver defers work to the chunk it touches this way, so every chunk is only accessed while it is resident */
+class BucketStore
+{
+public:
+	BucketStore() = default;
+	~BucketStore();
+
+	/* Empty buckets in the file at path. bufferRecords records of every bucket are held in memory */
+	bool Create(const std::string& path, size_t bucketCount, size_t recordWords, size_t bufferRecords);
+
+	/* Close and delete the file */
+	void Remove();
+
+	void Append(size_t bucket, const uint64_t* record);
+
+	/* Visit every record of a bucket (as const uint64_t*) and empty it. False on I/O errors */
+	template<class Visit>
+	bool Drain(size_t bucket, Visit visit)
+	{
+		Bucket& current = m_buckets[bucket];
+		std::vector<uint64_t> buffer;
+		buffer.swap(current.buffer);
+		std::vector<uint64_t> blocks;
+		blocks.swap(current.blocks);
+		current.records = 0;
+
+		/* A block is free once it is read, appends of the visitor may already reuse it */
+		for (uint64_t block : blocks)
+		{
+			if (!ReadBlock(block))
+			{
+				break;
+			}
+			m_freeBlocks.push_back(block);
+
+			for (size_t i = 0; i < m_readBlock.size(); i += m_recordWords)
+			{
+				visit(m_readBlock.data() + i);
+			}
+		}
+
+		for (size_t i = 0; i < buffer.size(); i += m_recordWords)
+		{
+			visit(buffer.data() + i);
+		}
+
+		/* Keep the memory for the next appends */
+		if (current.buffer.empty())
+		{
+			buffer.clear();
+			current.buffer.swap(buffer);
+		}
+
+		return !m_bFailed;
+	}
+
+	/* Records in a bucket, buffered or on disk */
+	uint64_t GetRecordCount(size_t bucket) const { return m_buckets[bucket].records; }
+
+	/* False after any I/O error */
+	bool IsGood() const { return !m_bFailed; }
+
+	/* Memory of all bucket buffers and the read block when full */
+	size_t GetBufferBytes() const { return (m_buckets.size() + 1) * m_bufferRecords * m_recordWords * sizeof(uint64_t); }
+
+	/* I/O statistics */
+	uint64_t GetBytesRead() const { return m_bytesRead; }
+	uint64_t GetBytesWritten() const { return m_bytesWritten; }
+
+	/* Size of the file in blocks, free ones included */
+	uint64_t GetBlockCount() const { return m_blockCount; }
+
+private:
+	struct Bucket
+	{
+		std::vector<uint64_t> buffer;
+		std::vector<uint64_t> blocks;
+		uint64_t records = 0;
+	};
+
+	/* Write the full buffer of a bucket to a free block */
+	bool FlushBucket(Bucket& bucket);
+
+	/* Read a block into m_readBlock */
+	bool ReadBlock(uint64_t block);
+
+	std::string m_path;
+	std::fstream m_file;
+	size_t m_recordWords = 1;
+	size_t m_bufferRecords = 1;
+
+	std::vector<Bucket> m_buckets;
+	std::vector<uint64_t> m_freeBlocks;
+	std::vector<uint64_t> m_readBlock;
+	uint64_t m_blockCount = 0;
+
+	bool m_bFailed = false;
+
+	uint64_t m_bytesRead = 0;
+	uint64_t m_bytesWritten = 0;
+};
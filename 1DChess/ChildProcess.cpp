@@ -0,0 +1,131 @@
+#include "ChildProcess.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <cerrno>
+#include <spawn.h>
+#include <sys/wait.h>
+
+extern char** environ;
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+	/* Quote an argument for the command line, so the C runtime of the child splits it back into the same argument */
+	void AppendQuoted(std::string& commandLine, const std::string& argument)
+	{
+		if (!commandLine.empty())
+		{
+			commandLine.push_back(' ');
+		}
+		if (!argument.empty() && argument.find_first_of(" \t\n\v\"") == std::string::npos)
+		{
+			commandLine.append(argument);
+			return;
+		}
+
+		/* Backslashes are only special before a quote, then they are doubled */
+		commandLine.push_back('"');
+		size_t backslashes = 0;
+		for (char c : argument)
+		{
+			if (c == '\\')
+			{
+				backslashes++;
+				continue;
+			}
+
+			commandLine.append(c == '"' ? backslashes * 2 + 1 : backslashes, '\\');
+			backslashes = 0;
+			commandLine.push_back(c);
+		}
+		commandLine.append(backslashes * 2, '\\');
+		commandLine.push_back('"');
+	}
+#endif
+}
+
+ChildProcess::~ChildProcess()
+{
+	Wait();
+}
+
+bool ChildProcess::Start(const std::vector<std::string>& arguments)
+{
+	Wait();
+	if (arguments.empty())
+	{
+		return false;
+	}
+
+#if defined(_WIN32)
+	std::string commandLine;
+	for (const std::string& argument : arguments)
+	{
+		AppendQuoted(commandLine, argument);
+	}
+
+	STARTUPINFOA startupInfo = {};
+	startupInfo.cb = sizeof(startupInfo);
+	PROCESS_INFORMATION processInfo = {};
+	if (!CreateProcessA(nullptr, &commandLine[0], nullptr, nullptr, FALSE, 0, nullptr, nullptr, &startupInfo, &processInfo))
+	{
+		return false;
+	}
+
+	CloseHandle(processInfo.hThread);
+	m_process = processInfo.hProcess;
+	return true;
+#else
+	std::vector<char*> argv;
+	for (const std::string& argument : arguments)
+	{
+		argv.push_back(const_cast<char*>(argument.c_str()));
+	}
+	argv.push_back(nullptr);
+
+	pid_t pid;
+	if (posix_spawnp(&pid, argv[0], nullptr, nullptr, argv.data(), environ) != 0)
+	{
+		return false;
+	}
+
+	m_pid = pid;
+	return true;
+#endif
+}
+
+int ChildProcess::Wait()
+{
+#if defined(_WIN32)
+	if (m_process == nullptr)
+	{
+		return -1;
+	}
+
+	DWORD exitCode = 0;
+	bool bExited = WaitForSingleObject(m_process, INFINITE) == WAIT_OBJECT_0 && GetExitCodeProcess(m_process, &exitCode);
+	CloseHandle(m_process);
+	m_process = nullptr;
+
+	return bExited ? static_cast<int>(exitCode) : -1;
+#else
+	if (m_pid < 0)
+	{
+		return -1;
+	}
+
+	int status = 0;
+	pid_t result;
+	do
+	{
+		result = waitpid(m_pid, &status, 0);
+	} while (result < 0 && errno == EINTR);
+	m_pid = -1;
+
+	return result >= 0 && WIFEXITED(status) ? WEXITSTATUS(status) : -1;
+#endif
+}
@@ -0,0 +1,28 @@
+#pragma once
+#include <string>
+#include <vector>
+
+/* Process started from an argument vector, without a shell in between, so arguments reach it unchanged (spaces, quotes).
+ * The first argument is the program, searched in PATH if it has no directory. The destructor waits for a started process */
+class ChildProcess
+{
+public:
+	ChildProcess() = default;
+	~ChildProcess();
+
+	ChildProcess(const ChildProcess&) = delete;
+	ChildProcess& operator=(const ChildProcess&) = delete;
+
+	/* False if the program can't be started */
+	bool Start(const std::vector<std::string>& arguments);
+
+	/* Wait for the process to end. Returns its exit code, -1 if it wasn't started or didn't exit normally */
+	int Wait();
+
+private:
+#if defined(_WIN32)
+	void* m_process = nullptr;
+#else
+	int m_pid = -1;
+#endif
+};
@@ -0,0 +1,217 @@
+#include "ChunkedTable.h"
+#include <algorithm>
+
+ChunkedTable::~ChunkedTable()
+{
+	Flush();
+}
+
+bool ChunkedTable::Create(const std::string& path, int64_t entryCount, int64_t chunkEntries, size_t maxResidentChunks)
+{
+	m_path = path;
+	m_entryCount = entryCount;
+	m_chunkEntries = std::max<int64_t>(4, (chunkEntries + 3) / 4 * 4);
+	m_chunkCount = (entryCount + m_chunkEntries - 1) / m_chunkEntries;
+	m_totalBytes = (entryCount + 3) / 4;
+
+	m_slots.clear();
+	m_slots.resize(std::max<size_t>(1, std::min<size_t>(maxResidentChunks, static_cast<size_t>(m_chunkCount))));
+	m_chunkSlots.assign(static_cast<size_t>(m_chunkCount), -1);
+	m_lastChunk = -1;
+	m_lastData = nullptr;
+	m_bFailed = false;
+
+	m_file.open(path, std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_file)
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	/* Zero the file in chunk sized writes */
+	std::unique_ptr<char[]> zeros = std::make_unique<char[]>(static_cast<size_t>(m_chunkEntries / 4));
+	std::fill_n(zeros.get(), m_chunkEntries / 4, 0);
+	for (int64_t chunk = 0; chunk < m_chunkCount; chunk++)
+	{
+		m_file.write(zeros.get(), GetChunkBytes(chunk));
+		m_bytesWritten += GetChunkBytes(chunk);
+	}
+	m_file.flush();
+
+	m_bFailed = !m_file;
+	return !m_bFailed;
+}
+
+int ChunkedTable::Get(int64_t index)
+{
+	if (index < 0 || index >= m_entryCount)
+	{
+		return 0;
+	}
+
+	unsigned char* data = GetChunk(index / m_chunkEntries);
+	if (data == nullptr)
+	{
+		return 0;
+	}
+
+	int64_t entry = index % m_chunkEntries;
+	return (data[entry / 4] >> (entry % 4 * 2)) & 0b11;
+}
+
+void ChunkedTable::Set(int64_t index, int value)
+{
+	if (index < 0 || index >= m_entryCount)
+	{
+		return;
+	}
+
+	int64_t chunk = index / m_chunkEntries;
+	unsigned char* data = GetChunk(chunk);
+	if (data == nullptr)
+	{
+		return;
+	}
+
+	int64_t entry = index % m_chunkEntries;
+	unsigned char& cacheByte = data[entry / 4];
+	cacheByte &= ~(0b11 << (entry % 4 * 2));
+	cacheByte |= (value & 0b11) << (entry % 4 * 2);
+
+	m_slots[m_chunkSlots[chunk]].bDirty = true;
+}
+
+bool ChunkedTable::Flush()
+{
+	for (Slot& slot : m_slots)
+	{
+		WriteBack(slot);
+	}
+
+	if (m_file.is_open())
+	{
+		m_file.flush();
+	}
+
+	return !m_bFailed;
+}
+
+bool ChunkedTable::CopyTo(std::ostream& os)
+{
+	if (!Flush())
+	{
+		return false;
+	}
+
+	/* Straight from the file, resident chunks are clean after the flush */
+	std::unique_ptr<char[]> buffer = std::make_unique<char[]>(static_cast<size_t>(m_chunkEntries / 4));
+	m_file.seekg(0);
+	for (int64_t chunk = 0; chunk < m_chunkCount; chunk++)
+	{
+		int64_t bytes = GetChunkBytes(chunk);
+		m_file.read(buffer.get(), bytes);
+		os.write(buffer.get(), bytes);
+		m_bytesRead += bytes;
+	}
+
+	m_bFailed = m_bFailed || !m_file;
+	return !m_bFailed && static_cast<bool>(os);
+}
+
+unsigned char* ChunkedTable::GetChunk(int64_t chunk)
+{
+	m_useCounter++;
+
+	if (chunk == m_lastChunk && !m_bFailed)
+	{
+		m_slots[m_chunkSlots[chunk]].lastUse = m_useCounter;
+		return m_lastData;
+	}
+
+	int slotIndex = m_chunkSlots[chunk];
+	if (slotIndex < 0)
+	{
+		if (m_bFailed)
+		{
+			return nullptr;
+		}
+
+		/* Replace the least recently used chunk */
+		slotIndex = 0;
+		for (size_t i = 1; i < m_slots.size(); i++)
+		{
+			if (m_slots[i].lastUse < m_slots[slotIndex].lastUse)
+			{
+				slotIndex = static_cast<int>(i);
+			}
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		if (!WriteBack(slot))
+		{
+			return nullptr;
+		}
+
+		/* The evicted chunk may be the last one, its memory is about to be overwritten */
+		if (slot.chunk >= 0)
+		{
+			m_chunkSlots[slot.chunk] = -1;
+			slot.chunk = -1;
+		}
+		m_lastChunk = -1;
+		m_lastData = nullptr;
+		if (!slot.data)
+		{
+			slot.data = std::make_unique<unsigned char[]>(static_cast<size_t>(m_chunkEntries / 4));
+		}
+
+		int64_t bytes = GetChunkBytes(chunk);
+		m_file.seekg(chunk * (m_chunkEntries / 4));
+		m_file.read(reinterpret_cast<char*>(slot.data.get()), bytes);
+		if (!m_file)
+		{
+			m_bFailed = true;
+			slot.chunk = -1;
+			return nullptr;
+		}
+
+		slot.chunk = chunk;
+		m_chunkSlots[chunk] = slotIndex;
+		m_bytesRead += bytes;
+		m_chunkLoads++;
+	}
+
+	Slot& slot = m_slots[slotIndex];
+	slot.lastUse = m_useCounter;
+	m_lastChunk = chunk;
+	m_lastData = slot.data.get();
+
+	return m_lastData;
+}
+
+int64_t ChunkedTable::GetChunkBytes(int64_t chunk) const
+{
+	int64_t offset = chunk * (m_chunkEntries / 4);
+	return std::min(m_chunkEntries / 4, m_totalBytes - offset);
+}
+
+bool ChunkedTable::WriteBack(Slot& slot)
+{
+	if (slot.chunk < 0 || !slot.bDirty)
+	{
+		return true;
+	}
+
+	int64_t bytes = GetChunkBytes(slot.chunk);
+	m_file.seekp(slot.chunk * (m_chunkEntries / 4));
+	m_file.write(reinterpret_cast<const char*>(slot.data.get()), bytes);
+	if (!m_file)
+	{
+		m_bFailed = true;
+		return false;
+	}
+
+	slot.bDirty = false;
+	m_bytesWritten += bytes;
+	return true;
+}
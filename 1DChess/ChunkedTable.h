@@ -0,0 +1,85 @@
+#pragma once
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <vector>
+
+/* Table of 2 bit entries (4 per byte, like the position cache of EvaluationTree) in a file on disk, split into chunks.
+ * Entries are accessed through the chunk holding them. At most maxResidentChunks chunks are held in memory,
+ * the least recently used one is written back when another one is needed. Chunks are read and written as a whole */
+class ChunkedTable
+{
+public:
+	ChunkedTable() = default;
+	~ChunkedTable();
+
+	/* Create a zeroed table file. chunkEntries is rounded up to a multiple of 4, maxResidentChunks is at least 1 */
+	bool Create(const std::string& path, int64_t entryCount, int64_t chunkEntries, size_t maxResidentChunks);
+
+	/* Entry 0..3. Indices outside of the table read as 0 */
+	int Get(int64_t index);
+	void Set(int64_t index, int value);
+
+	/* Write back all modified chunks */
+	bool Flush();
+
+	/* Write the packed entries of the whole table to a stream, chunk by chunk */
+	bool CopyTo(std::ostream& os);
+
+	/* False after any I/O error */
+	bool IsGood() const { return !m_bFailed; }
+
+	int64_t GetEntryCount() const { return m_entryCount; }
+	int64_t GetChunkEntries() const { return m_chunkEntries; }
+	int64_t GetChunkCount() const { return m_chunkCount; }
+
+	/* Chunks held in memory at most */
+	size_t GetResidentChunks() const { return m_slots.size(); }
+
+	/* I/O statistics */
+	uint64_t GetBytesRead() const { return m_bytesRead; }
+	uint64_t GetBytesWritten() const { return m_bytesWritten; }
+	uint64_t GetChunkLoads() const { return m_chunkLoads; }
+
+private:
+	struct Slot
+	{
+		int64_t chunk = -1;
+		std::unique_ptr<unsigned char[]> data;
+		bool bDirty = false;
+		uint64_t lastUse = 0;
+	};
+
+	/* Memory of a chunk, loading it if needed. nullptr on I/O error */
+	unsigned char* GetChunk(int64_t chunk);
+
+	/* Size of a chunk in bytes, the last one can be shorter */
+	int64_t GetChunkBytes(int64_t chunk) const;
+
+	bool WriteBack(Slot& slot);
+
+	std::fstream m_file;
+	std::string m_path;
+
+	int64_t m_entryCount = 0;
+	int64_t m_chunkEntries = 0;
+	int64_t m_chunkCount = 0;
+	int64_t m_totalBytes = 0;
+
+	std::vector<Slot> m_slots;
+
+	/* Slot of every chunk, -1 if not resident */
+	std::vector<int> m_chunkSlots;
+
+	/* Chunk of the last access, most accesses hit it again */
+	int64_t m_lastChunk = -1;
+	unsigned char* m_lastData = nullptr;
+
+	uint64_t m_useCounter = 0;
+	bool m_bFailed = false;
+
+	uint64_t m_bytesRead = 0;
+	uint64_t m_bytesWritten = 0;
+	uint64_t m_chunkLoads = 0;
+};
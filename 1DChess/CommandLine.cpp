@@ -0,0 +1,41 @@
+#include "CommandLine.h"
+#include <cstdlib>
+
+/* Hack table to convert -2 to unknown eval in case we don't have one somehow */
+const char* gEvalTable[] = {
+	"?", "-1", "0", "1"
+};
+
+const char* findOption(int argc, char* argv[], std::string_view key)
+{
+	for (int i = 2; i < argc; i++)
+	{
+		std::string_view argument(argv[i]);
+		if (argument.size() > key.size() && argument.substr(0, key.size()) == key && argument[key.size()] == '=')
+		{
+			return argv[i] + key.size() + 1;
+		}
+	}
+	return nullptr;
+}
+
+int getIntOption(int argc, char* argv[], std::string_view key, int defaultValue)
+{
+	const char* value = findOption(argc, argv, key);
+	return value != nullptr ? std::atoi(value) : defaultValue;
+}
+
+double getDoubleOption(int argc, char* argv[], std::string_view key, double defaultValue)
+{
+	const char* value = findOption(argc, argv, key);
+	return value != nullptr ? std::atof(value) : defaultValue;
+}
+
+std::string getSetupArgument(int argc, char* argv[])
+{
+	if (argc > 2 && std::string_view(argv[2]).find('=') == std::string_view::npos)
+	{
+		return argv[2];
+	}
+	return std::string(STARTING_SETUP);
+}
@@ -0,0 +1,63 @@
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <string_view>
+#include <type_traits>
+#include "EvaluationTree.h"
+
+/* Helpers of the command line modes. Arguments are "1DChess --mode [positional ...] [key=value ...]" */
+
+/* Values -1, 0, 1 and -2 for unknown as text, index with value + 2 */
+extern const char* gEvalTable[];
+
+/* Value of a "key=value" argument, nullptr if not given */
+const char* findOption(int argc, char* argv[], std::string_view key);
+
+int getIntOption(int argc, char* argv[], std::string_view key, int defaultValue);
+
+double getDoubleOption(int argc, char* argv[], std::string_view key, double defaultValue);
+
+/* Setup given as first argument after the mode (any argument without "="), the standard setup otherwise */
+std::string getSetupArgument(int argc, char* argv[]);
+
+/* Call run with the board size of the setup as std::integral_constant<int, Size>, for the sizes the templates are instantiated for:
+ * return dispatchBySize(setup, [&](auto size) { return runXOfSize<decltype(size)::value>(setup, argc, argv); }); */
+template<class F>
+int dispatchBySize(const std::string& setup, F run)
+{
+	switch (setup.size())
+	{
+	case 8:
+		return run(std::integral_constant<int, 8>());
+	case 10:
+		return run(std::integral_constant<int, 10>());
+	case 12:
+		return run(std::integral_constant<int, 12>());
+	default:
+		std::cerr << "Boards have 8, 10 or 12 fields" << std::endl;
+		return 1;
+	}
+}
+
+/* Load the table given by "table=path" into the tree, or solve the setup if there is none. False if the table doesn't load */
+template<int Size>
+bool prepareTree(BasicEvaluationTree<Size>& eval, const BasicBoard<Size>& board, const std::string& setup, int argc, char* argv[])
+{
+	eval.SetVerbose(false);
+	if (const char* path = findOption(argc, argv, "table"))
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!eval.LoadTable(file))
+		{
+			std::cerr << "Could not load " << path << " for " << setup << std::endl;
+			return false;
+		}
+		return true;
+	}
+
+	BasicGameState<Size> state(board, Color::White);
+	state.FinalizeGameState();
+	eval.Evaluate(state);
+	return true;
+}
@@ -0,0 +1,295 @@
+#include "CompressedTable.h"
+#include <algorithm>
+#include <cstring>
+
+bool CompressedTable::Write(std::ostream& os, std::string_view setup, const unsigned char* entries, int positionCount, int blockPositions)
+{
+	uint32_t setupLength = static_cast<uint32_t>(setup.size());
+	uint32_t count = positionCount;
+	uint32_t positions = std::max(4, (blockPositions + 3) / 4 * 4);
+	uint32_t blockCount = (count + positions - 1) / positions;
+
+	/* Compress everything first, the block index comes before the blocks */
+	std::vector<uint64_t> offsets(1, 0);
+	std::vector<unsigned char> blocks;
+	for (uint32_t block = 0; block < blockCount; block++)
+	{
+		int first = static_cast<int>(block * positions);
+		CompressBlock(entries, first, std::min<int>(positions, positionCount - first), blocks);
+		offsets.push_back(blocks.size());
+	}
+
+	os.write(COMPRESSED_TABLE_MAGIC, sizeof(COMPRESSED_TABLE_MAGIC));
+	os.write(reinterpret_cast<const char*>(&COMPRESSED_TABLE_VERSION), sizeof(COMPRESSED_TABLE_VERSION));
+	os.write(reinterpret_cast<const char*>(&setupLength), sizeof(setupLength));
+	os.write(setup.data(), setupLength);
+	os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+	os.write(reinterpret_cast<const char*>(&positions), sizeof(positions));
+	os.write(reinterpret_cast<const char*>(&blockCount), sizeof(blockCount));
+	os.write(reinterpret_cast<const char*>(offsets.data()), offsets.size() * sizeof(uint64_t));
+	os.write(reinterpret_cast<const char*>(blocks.data()), blocks.size());
+
+	return static_cast<bool>(os);
+}
+
+bool CompressedTable::Open(const std::string& path, size_t cachedBlocks)
+{
+	Close();
+	if (!m_file.Open(path))
+	{
+		return false;
+	}
+
+	const unsigned char* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	/* Fixed part of the header, then the setup, then the counts */
+	uint32_t version = 0;
+	uint32_t setupLength = 0;
+	size_t prefix = sizeof(COMPRESSED_TABLE_MAGIC) + sizeof(version) + sizeof(setupLength);
+	if (size < prefix || std::memcmp(data, COMPRESSED_TABLE_MAGIC, sizeof(COMPRESSED_TABLE_MAGIC)) != 0)
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&version, data + sizeof(COMPRESSED_TABLE_MAGIC), sizeof(version));
+	std::memcpy(&setupLength, data + sizeof(COMPRESSED_TABLE_MAGIC) + sizeof(version), sizeof(setupLength));
+
+	uint32_t counts[3] = {};
+	if (version != COMPRESSED_TABLE_VERSION || setupLength > 64 || size < prefix + setupLength + sizeof(counts))
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(counts, data + prefix + setupLength, sizeof(counts));
+
+	uint32_t positionCount = counts[0];
+	uint32_t blockPositions = counts[1];
+	uint32_t blockCount = counts[2];
+	size_t indexStart = prefix + setupLength + sizeof(counts);
+	size_t blocksStart = indexStart + (static_cast<size_t>(blockCount) + 1) * sizeof(uint64_t);
+	if (positionCount == 0 || positionCount > INT32_MAX || blockPositions == 0 || blockPositions % 4 != 0
+		|| blockCount != (static_cast<uint64_t>(positionCount) + blockPositions - 1) / blockPositions || blocksStart > size)
+	{
+		Close();
+		return false;
+	}
+
+	m_setup = std::string_view(reinterpret_cast<const char*>(data + prefix), setupLength);
+	m_positionCount = static_cast<int>(positionCount);
+	m_blockPositions = static_cast<int>(blockPositions);
+	m_blockCount = static_cast<int>(blockCount);
+	m_offsets = data + indexStart;
+	m_blocks = data + blocksStart;
+
+	/* The last offset is the end of the file */
+	uint64_t end = 0;
+	std::memcpy(&end, m_offsets + blockCount * sizeof(uint64_t), sizeof(end));
+	if (end != size - blocksStart)
+	{
+		Close();
+		return false;
+	}
+
+	m_slots.clear();
+	m_slots.resize(std::max<size_t>(1, std::min<size_t>(cachedBlocks, blockCount)));
+	m_blockSlots.assign(blockCount, -1);
+	return true;
+}
+
+void CompressedTable::Close()
+{
+	m_file.Close();
+	m_setup = std::string_view();
+	m_positionCount = 0;
+	m_blockPositions = 0;
+	m_blockCount = 0;
+	m_offsets = nullptr;
+	m_blocks = nullptr;
+
+	m_slots.clear();
+	m_blockSlots.clear();
+	m_lastBlock = -1;
+	m_lastData = nullptr;
+	m_useCounter = 0;
+	m_probes = 0;
+	m_blockLoads = 0;
+}
+
+int CompressedTable::GetEntry(int positionIndex)
+{
+	if (positionIndex < 0 || positionIndex >= m_positionCount)
+	{
+		return 0;
+	}
+
+	m_probes++;
+	const unsigned char* data = GetBlock(positionIndex / m_blockPositions);
+	if (data == nullptr)
+	{
+		return 0;
+	}
+
+	int entry = positionIndex % m_blockPositions;
+	return (data[entry / 4] >> (entry % 4 * 2)) & 0b11;
+}
+
+void CompressedTable::CompressBlock(const unsigned char* entries, int first, int count, std::vector<unsigned char>& out)
+{
+	size_t start = out.size();
+	out.push_back(BLOCK_RUNS);
+
+	/* Token per run: (length - 1) << 2 | value, as varint of 7 bits per byte */
+	int i = 0;
+	while (i < count)
+	{
+		int value = (entries[(first + i) / 4] >> ((first + i) % 4 * 2)) & 0b11;
+		int length = 1;
+		while (i + length < count && ((entries[(first + i + length) / 4] >> ((first + i + length) % 4 * 2)) & 0b11) == value)
+		{
+			length++;
+		}
+
+		uint32_t token = (static_cast<uint32_t>(length - 1) << 2) | value;
+		while (token >= 0x80)
+		{
+			out.push_back(static_cast<unsigned char>(token | 0x80));
+			token >>= 7;
+		}
+		out.push_back(static_cast<unsigned char>(token));
+		i += length;
+	}
+
+	/* Noisy blocks stay raw. first is a multiple of 4, so the block starts at a byte */
+	size_t rawBytes = (static_cast<size_t>(count) + 3) / 4;
+	if (out.size() - start > 1 + rawBytes)
+	{
+		out.resize(start);
+		out.push_back(BLOCK_RAW);
+		out.insert(out.end(), entries + first / 4, entries + first / 4 + rawBytes);
+	}
+}
+
+const unsigned char* CompressedTable::GetBlock(int block)
+{
+	m_useCounter++;
+
+	if (block == m_lastBlock)
+	{
+		m_slots[m_blockSlots[block]].lastUse = m_useCounter;
+		return m_lastData;
+	}
+
+	int slotIndex = m_blockSlots[block];
+	if (slotIndex < 0)
+	{
+		/* Replace the least recently used block */
+		slotIndex = 0;
+		for (size_t i = 1; i < m_slots.size(); i++)
+		{
+			if (m_slots[i].lastUse < m_slots[slotIndex].lastUse)
+			{
+				slotIndex = static_cast<int>(i);
+			}
+		}
+
+		Slot& slot = m_slots[slotIndex];
+		if (slot.block >= 0)
+		{
+			m_blockSlots[slot.block] = -1;
+			slot.block = -1;
+		}
+		if (!slot.data)
+		{
+			slot.data = std::make_unique<unsigned char[]>(m_blockPositions / 4);
+		}
+
+		if (!DecompressBlock(block, slot.data.get()))
+		{
+			m_lastBlock = -1;
+			return nullptr;
+		}
+
+		slot.block = block;
+		m_blockSlots[block] = slotIndex;
+		m_blockLoads++;
+	}
+
+	Slot& slot = m_slots[slotIndex];
+	slot.lastUse = m_useCounter;
+	m_lastBlock = block;
+	m_lastData = slot.data.get();
+
+	return m_lastData;
+}
+
+bool CompressedTable::DecompressBlock(int block, unsigned char* out) const
+{
+	uint64_t offsets[2];
+	std::memcpy(offsets, m_offsets + block * sizeof(uint64_t), sizeof(offsets));
+	uint64_t end = 0;
+	std::memcpy(&end, m_offsets + m_blockCount * sizeof(uint64_t), sizeof(end));
+	if (offsets[0] >= offsets[1] || offsets[1] > end)
+	{
+		return false;
+	}
+
+	const unsigned char* data = m_blocks + offsets[0];
+	const unsigned char* dataEnd = m_blocks + offsets[1];
+	int count = std::min(m_blockPositions, m_positionCount - block * m_blockPositions);
+	size_t rawBytes = (static_cast<size_t>(count) + 3) / 4;
+
+	if (*data == BLOCK_RAW)
+	{
+		if (static_cast<size_t>(dataEnd - data - 1) != rawBytes)
+		{
+			return false;
+		}
+		std::memcpy(out, data + 1, rawBytes);
+		return true;
+	}
+	if (*data != BLOCK_RUNS)
+	{
+		return false;
+	}
+
+	std::memset(out, 0, m_blockPositions / 4);
+	data++;
+
+	int i = 0;
+	while (i < count && data < dataEnd)
+	{
+		uint32_t token = 0;
+		for (int shift = 0; data < dataEnd && shift < 32; shift += 7)
+		{
+			token |= static_cast<uint32_t>(*data & 0x7F) << shift;
+			if (!(*data++ & 0x80))
+			{
+				break;
+			}
+		}
+
+		int value = token & 0b11;
+		int length = static_cast<int>(token >> 2) + 1;
+		if (length > count - i)
+		{
+			return false;
+		}
+
+		/* Entry by entry up to the next byte, then whole bytes of four equal entries */
+		int runEnd = i + length;
+		for (; i < runEnd && i % 4 != 0; i++)
+		{
+			out[i / 4] |= value << (i % 4 * 2);
+		}
+		int wholeBytes = (runEnd - i) / 4;
+		std::memset(out + i / 4, value * 0b01010101, wholeBytes);
+		i += wholeBytes * 4;
+		for (; i < runEnd; i++)
+		{
+			out[i / 4] |= value << (i % 4 * 2);
+		}
+	}
+
+	return i == count && data == dataEnd;
+}
@@ -0,0 +1,91 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <string_view>
+#include <vector>
+#include "MappedFile.h"
+
+/* Compressed table file header: Magic, version, setup length, setup, number of positions, positions per block, number of blocks,
+ * then the offsets of the blocks (one more than blocks, relative to the first block) and the blocks */
+constexpr char COMPRESSED_TABLE_MAGIC[4] = { '1', 'D', 'C', 'Z' };
+constexpr uint32_t COMPRESSED_TABLE_VERSION = 1;
+
+/* Table file split into blocks of consecutive position indices, each compressed on its own.
+ * Values come in long runs (both repetition indices of a position, whole ranges of lost or drawn positions),
+ * so a block is stored as runs of one value with varint lengths, or raw if that is smaller.
+ * A probe decompresses just the block of its index. The least recently used of the decompressed blocks is replaced
+ * by the next one needed, most probes hit a cached block. Not thread-safe, open one instance per thread (the file is shared) */
+class CompressedTable
+{
+public:
+	static constexpr int DEFAULT_BLOCK_POSITIONS = 1 << 14;
+	static constexpr size_t DEFAULT_CACHED_BLOCKS = 64;
+
+	/* Compress packed entries (4 per byte, see MappedTable::GetEntries). blockPositions is rounded up to a multiple of 4 */
+	static bool Write(std::ostream& os, std::string_view setup, const unsigned char* entries, int positionCount, int blockPositions = DEFAULT_BLOCK_POSITIONS);
+
+	/* Map a compressed table file and check its header and block index. cachedBlocks is at least 1 */
+	bool Open(const std::string& path, size_t cachedBlocks = DEFAULT_CACHED_BLOCKS);
+	void Close();
+
+	bool IsOpen() const { return m_file.IsOpen(); }
+
+	/* Setup in stream notation, its length is the board size */
+	std::string_view GetSetup() const { return m_setup; }
+	int GetPositionCount() const { return m_positionCount; }
+	int GetBlockPositions() const { return m_blockPositions; }
+	int GetBlockCount() const { return m_blockCount; }
+	size_t GetFileBytes() const { return m_file.GetSize(); }
+
+	/* Entry 0..3 of a position index, 0 (unknown) outside of the table or for a damaged block */
+	int GetEntry(int positionIndex);
+
+	/* Cache statistics */
+	uint64_t GetProbes() const { return m_probes; }
+	uint64_t GetBlockLoads() const { return m_blockLoads; }
+
+private:
+	struct Slot
+	{
+		int block = -1;
+		std::unique_ptr<unsigned char[]> data;
+		uint64_t lastUse = 0;
+	};
+
+	/* First byte of a block */
+	static constexpr unsigned char BLOCK_RAW = 0;
+	static constexpr unsigned char BLOCK_RUNS = 1;
+
+	static void CompressBlock(const unsigned char* entries, int first, int count, std::vector<unsigned char>& out);
+
+	/* Packed entries of a block, decompressing it if needed. nullptr for a damaged block */
+	const unsigned char* GetBlock(int block);
+	bool DecompressBlock(int block, unsigned char* out) const;
+
+	MappedFile m_file;
+
+	std::string_view m_setup;
+	int m_positionCount = 0;
+	int m_blockPositions = 0;
+	int m_blockCount = 0;
+
+	/* Block index and the compressed blocks, both in the mapped file */
+	const unsigned char* m_offsets = nullptr;
+	const unsigned char* m_blocks = nullptr;
+
+	std::vector<Slot> m_slots;
+
+	/* Slot of every block, -1 if not cached */
+	std::vector<int> m_blockSlots;
+
+	/* Block of the last probe, most probes hit it again */
+	int m_lastBlock = -1;
+	const unsigned char* m_lastData = nullptr;
+
+	uint64_t m_useCounter = 0;
+	uint64_t m_probes = 0;
+	uint64_t m_blockLoads = 0;
+};
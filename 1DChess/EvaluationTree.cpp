@@ -1,7 +1,70 @@
 #include "EvaluationTree.h"
+#include <climits>
+#include <cstring>
+#include <numeric>
+#include <sstream>
+#include "MappedTable.h"
 
+#if defined(__AVX2__)
+#include <immintrin.h>
+#endif
 
-int EvaluationTree::Evaluate(const GameState& state)
+/* The batch probe reads the atomic cache bytes as plain memory */
+static_assert(sizeof(std::atomic<unsigned char>) == 1, "Cache entries must be single bytes");
+
+/* Upper bound of pending priority requests, older ones are dropped */
+constexpr size_t MAX_PRIORITY_REQUESTS = 64;
+
+template<int Size>
+BasicEvaluationTree<Size>::BasicEvaluationTree(const Board& setup, LayoutOrder order) : Root(nullptr), m_setup(setup)
+{
+	/* Init position cache */
+	/* Cache for the position, see PositionLayout for the combinatory elements
+	* Divide by 4 as we can store 4 eval results in one byte (3 different values for eval + 1 for not evaluated = 2 bits)
+	* [Standard setup: 6 * 5 * 7 * 7 * 5 * 6 * 2 * 2 / 4 = 44,100]
+	* Padding at the end, so the batch probe can gather whole words
+	*/
+	std::ostringstream setupText;
+	setupText << setup;
+	m_layout = PositionLayout<Size>::FromSetup(setupText.str(), order);
+	if (m_layout.GetCount() > INT_MAX)
+	{
+		/* The cache is in memory and indexed by int, such setups are for StreamingSolver */
+		m_layout = PositionLayout<Size>();
+	}
+	m_bStandardLayout = Size == BOARD_SIZE && setup == Board::GetStartingPosition() && order == LayoutOrder::Setup;
+
+	int positionCount = m_layout.IsValid() ? static_cast<int>(m_layout.GetCount()) : 0;
+	m_cacheSize = (positionCount + 3) / 4;
+
+	m_positionCache = std::make_unique<std::atomic<unsigned char>[]>(m_cacheSize + CACHE_PADDING);
+	m_moveCache = std::make_unique<std::atomic<uint32_t>[]>(positionCount);
+
+	std::fill_n(m_positionCache.get(), m_cacheSize + CACHE_PADDING, 0);
+	std::fill_n(m_moveCache.get(), positionCount, 0);
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::EnableProfile()
+{
+	m_profile = std::make_unique<SearchProfile>(m_layout.IsValid() ? static_cast<int>(m_layout.GetCount()) : 0);
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::SetTranspositionTable(std::shared_ptr<TranspositionTable> table, bool bHashAll)
+{
+	m_transpositionTable = std::move(table);
+	m_bHashAll = bHashAll && m_transpositionTable;
+}
+
+template<int Size>
+BasicEvaluationTree<Size>::~BasicEvaluationTree()
+{
+	CancelEvaluation();
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::Evaluate(const GameState& state)
 {
     /* Evaluation strategy: 
        1. Iterate depth-first through the moves, creating nodes for each moves (Don't store gamestate in tree to be memory-efficient.). 
@@ -20,21 +83,447 @@ int EvaluationTree::Evaluate(const GameState& state)
 
 
 	/* Evaluate the position */
-	Root->value = EvaluateRecursive(state, Root.get());
+	Root->value = EvaluateRecursive(state, GetPositionIndex(state), Root.get());
 
-	std::cout << "----------------" << std::endl;
-	std::cout << "Evaluation stats:" << std::endl;
-	std::cout << "Total node number: " << Root->CountRecursive() << std::endl;
-	std::cout << "Highest depth: " << m_highestDepth << std::endl;
-	std::cout << "Cache hits: " << m_cacheHits << std::endl;
-	std::cout << "Saved node evaluations through caching: " << m_cacheSaved << std::endl;
+	if (m_bVerbose)
+	{
+		std::cout << "----------------" << std::endl;
+		std::cout << "Evaluation stats:" << std::endl;
+		std::cout << "Total node number: " << Root->CountRecursive() << std::endl;
+		std::cout << "Highest depth: " << m_highestDepth << std::endl;
+		std::cout << "Cache hits: " << m_cacheHits << std::endl;
+		if (m_profile)
+		{
+			std::cout << "Saved node evaluations through caching: " << m_profile->GetSavedNodes() << std::endl;
+		}
+	}
 
 	return Root->value;
 }
 
-int EvaluationTree::GetGameStateEvaluation(const GameState& state)
+template<int Size>
+void BasicEvaluationTree<Size>::StartEvaluation(const GameState& state)
+{
+	/* One evaluation at a time */
+	WaitForEvaluation();
+
+	m_bCancel = false;
+	m_bRunning = true;
+	m_worker = std::thread([this, state]()
+	{
+		Evaluate(state);
+		m_bRunning.store(false, std::memory_order_release);
+	});
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::WaitForEvaluation()
+{
+	if (m_worker.joinable())
+	{
+		m_worker.join();
+	}
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::CancelEvaluation()
+{
+	m_bCancel = true;
+	WaitForEvaluation();
+	m_bCancel = false;
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::RequestPriority(const GameState& state)
+{
+	if (!IsEvaluationRunning() || GetCacheEntry(state) != CachedEvaluation::Unknown || state.IsGameOver())
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(m_priorityMutex);
+	if (m_priorityRequests.size() >= MAX_PRIORITY_REQUESTS)
+	{
+		m_priorityRequests.pop_front();
+	}
+	m_priorityRequests.push_back(state);
+	m_bPriorityPending.store(true, std::memory_order_release);
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::ServicePriorityRequests()
+{
+	/* Requests are evaluated with the same recursion, so don't nest */
+	m_bServicingPriority = true;
+
+	while (!m_bCancel)
+	{
+		GameState state;
+		{
+			std::lock_guard<std::mutex> lock(m_priorityMutex);
+			if (m_priorityRequests.empty())
+			{
+				m_bPriorityPending = false;
+				break;
+			}
+			/* Newest request first, that is what the user looks at */
+			state = m_priorityRequests.back();
+			m_priorityRequests.pop_back();
+		}
+
+		if (GetCacheEntry(state) == CachedEvaluation::Unknown)
+		{
+			EvaluationTreeNode node;
+			node.depth = 0;
+			node.value = 0;
+			EvaluateRecursive(state, GetPositionIndex(state), &node);
+		}
+	}
+
+	m_bServicingPriority = false;
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::GetGameStateEvaluation(const GameState& state) const
+{
+	return GetEvaluationValue(GetCacheEntry(state));
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::GetPositionEvaluation(const Board& board, Color nextPlayer, int repetitionCount) const
+{
+	return GetEvaluationValue(GetCacheEntry(GetPositionIndex(board, nextPlayer, repetitionCount)));
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::ProbeBatch(const PackedBoard* boards, const unsigned char* sideRepetition, size_t count, signed char* results) const
+{
+	/* CachedEvaluation to value */
+	static const signed char valueTable[] = { -2, 1, 0, -1 };
+
+	/* Work in blocks, so the indices stay in L1 */
+	constexpr size_t BLOCK_SIZE = 256;
+	int indices[BLOCK_SIZE];
+
+	for (size_t offset = 0; offset < count; offset += BLOCK_SIZE)
+	{
+		size_t blockCount = count - offset < BLOCK_SIZE ? count - offset : BLOCK_SIZE;
+
+		bool bKernel = false;
+		if constexpr (Size == BOARD_SIZE)
+		{
+			if (m_bStandardLayout)
+			{
+				PositionIndex::GetBatch(boards + offset, sideRepetition + offset, blockCount, indices);
+				bKernel = true;
+			}
+		}
+
+		if (!bKernel)
+		{
+			/* No kernel for variant layouts */
+			for (size_t i = 0; i < blockCount; i++)
+			{
+				unsigned char side = sideRepetition[offset + i];
+				indices[i] = side >= 4 ? -1 : static_cast<int>(m_layout.Get(Board::Unpack(boards[offset + i]), side >= 2 ? Color::Black : Color::White, side % 2 + 1));
+			}
+		}
+
+		size_t i = 0;
+#if defined(__AVX2__)
+		/* Gather the byte of 8 entries at once. Invalid indices are masked and read as unknown */
+		const __m256i zero = _mm256_setzero_si256();
+		for (; i + 8 <= blockCount; i += 8)
+		{
+			__m256i index = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(indices + i));
+			__m256i valid = _mm256_cmpgt_epi32(index, _mm256_set1_epi32(-1));
+			__m256i bytes = _mm256_mask_i32gather_epi32(zero, reinterpret_cast<const int*>(m_positionCache.get()), _mm256_srai_epi32(index, 2), valid, 1);
+			__m256i shift = _mm256_slli_epi32(_mm256_and_si256(index, _mm256_set1_epi32(3)), 1);
+			__m256i entries = _mm256_and_si256(_mm256_srlv_epi32(bytes, shift), _mm256_set1_epi32(0b11));
+
+			alignas(32) int entryValues[8];
+			_mm256_store_si256(reinterpret_cast<__m256i*>(entryValues), entries);
+			for (int lane = 0; lane < 8; lane++)
+			{
+				results[offset + i + lane] = valueTable[entryValues[lane]];
+			}
+		}
+#endif
+		for (; i < blockCount; i++)
+		{
+			results[offset + i] = valueTable[static_cast<int>(GetCacheEntry(indices[i]))];
+		}
+	}
+}
+
+template<int Size>
+bool BasicEvaluationTree<Size>::SaveTable(std::ostream& os) const
+{
+	WriteTableHeader(os, m_setup, m_layout.GetCount());
+
+	if (m_layout.GetOrder() == LayoutOrder::Setup)
+	{
+		/* Atomic bytes are plain bytes, see static_assert above */
+		os.write(reinterpret_cast<const char*>(m_positionCache.get()), m_cacheSize);
+		return static_cast<bool>(os);
+	}
+
+	/* Same positions, other digit order: Every entry goes to its index in the setup layout */
+	std::vector<int> indices = GetSetupOrderIndices();
+	std::vector<unsigned char> table(m_cacheSize, 0);
+	for (int i = 0; i < static_cast<int>(indices.size()); i++)
+	{
+		if (indices[i] >= 0)
+		{
+			table[GetCacheIndex(i)] |= static_cast<unsigned char>(GetCacheEntry(indices[i])) << (GetIntraByteIndex(i) * 2);
+		}
+	}
+
+	os.write(reinterpret_cast<const char*>(table.data()), table.size());
+	return static_cast<bool>(os);
+}
+
+template<int Size>
+bool BasicEvaluationTree<Size>::WriteTableHeader(std::ostream& os, const Board& setup, int64_t positionCount)
+{
+	/* Header: magic, version, setup length, setup, number of positions. Then the packed cache */
+	std::ostringstream setupText;
+	setupText << setup;
+	uint32_t setupLength = Size;
+	uint64_t count = static_cast<uint64_t>(positionCount);
+
+	os.write(TABLE_MAGIC, sizeof(TABLE_MAGIC));
+	os.write(reinterpret_cast<const char*>(&TABLE_VERSION), sizeof(TABLE_VERSION));
+	os.write(reinterpret_cast<const char*>(&setupLength), sizeof(setupLength));
+	os.write(setupText.str().data(), Size);
+	os.write(reinterpret_cast<const char*>(&count), sizeof(count));
+
+	return static_cast<bool>(os);
+}
+
+template<int Size>
+bool BasicEvaluationTree<Size>::LoadTable(std::istream& is)
+{
+	char magic[sizeof(TABLE_MAGIC)];
+	uint32_t version = 0;
+	uint32_t setupLength = 0;
+	char setup[Size];
+	uint64_t positionCount = 0;
+
+	is.read(magic, sizeof(magic));
+	is.read(reinterpret_cast<char*>(&version), sizeof(version));
+	is.read(reinterpret_cast<char*>(&setupLength), sizeof(setupLength));
+	if (!is || std::memcmp(magic, TABLE_MAGIC, sizeof(magic)) != 0 || version != TABLE_VERSION || setupLength != Size)
+	{
+		return false;
+	}
+
+	is.read(setup, sizeof(setup));
+	is.read(reinterpret_cast<char*>(&positionCount), sizeof(positionCount));
+
+	Board setupBoard;
+	if (!is || !Board::FromString(std::string_view(setup, sizeof(setup)), setupBoard) || !(setupBoard == m_setup)
+		|| positionCount != static_cast<uint64_t>(m_layout.GetCount()))
+	{
+		return false;
+	}
+
+	/* No evaluation may run meanwhile */
+	CancelEvaluation();
+
+	std::unique_ptr<char[]> table = std::make_unique<char[]>(m_cacheSize);
+	is.read(table.get(), m_cacheSize);
+	if (!is)
+	{
+		return false;
+	}
+
+	if (m_layout.GetOrder() == LayoutOrder::Setup)
+	{
+		for (int i = 0; i < m_cacheSize; i++)
+		{
+			m_positionCache[i].store(static_cast<unsigned char>(table[i]), std::memory_order_relaxed);
+		}
+	}
+	else
+	{
+		/* Entries of the file are in setup order */
+		std::fill_n(m_positionCache.get(), m_cacheSize, 0);
+		std::vector<int> indices = GetSetupOrderIndices();
+		for (int i = 0; i < static_cast<int>(indices.size()); i++)
+		{
+			if (indices[i] >= 0)
+			{
+				SetCacheEntry(indices[i], static_cast<CachedEvaluation>((table[GetCacheIndex(i)] >> (GetIntraByteIndex(i) * 2)) & 0b11));
+			}
+		}
+	}
+	std::atomic_thread_fence(std::memory_order_release);
+
+	return true;
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::GetMoveEvaluation(const GameState& state, size_t moveNumber) const
+{
+	int positionIndex = GetPositionIndex(state);
+	if (positionIndex < 0 || moveNumber >= MAX_CACHED_MOVES)
+	{
+		return -2;
+	}
+
+	uint32_t moveEntry = m_moveCache[positionIndex].load(std::memory_order_acquire);
+	return GetEvaluationValue(static_cast<CachedEvaluation>((moveEntry >> (moveNumber * 2)) & 0b11));
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::GetBestMove(const GameState& state) const
+{
+	int positionIndex = GetPositionIndex(state);
+	if (positionIndex < 0)
+	{
+		return -1;
+	}
+
+	uint32_t moveEntry = m_moveCache[positionIndex].load(std::memory_order_acquire);
+	size_t moveCount = state.GetMoves().size() < MAX_CACHED_MOVES ? state.GetMoves().size() : MAX_CACHED_MOVES;
+
+	/* White maximizes, black minimizes. Take the first move with the best value */
+	int sign = state.GetNextPlayer() == Color::White ? 1 : -1;
+	int bestMove = -1;
+	int bestValue = INT_MIN;
+	bool bComplete = true;
+	for (size_t i = 0; i < moveCount; i++)
+	{
+		int value = GetEvaluationValue(static_cast<CachedEvaluation>((moveEntry >> (i * 2)) & 0b11));
+		if (value == -2)
+		{
+			/* Not evaluated, e.g. skipped after a winning move with move ordering */
+			bComplete = false;
+			continue;
+		}
+
+		if (value * sign > bestValue)
+		{
+			bestValue = value * sign;
+			bestMove = static_cast<int>(i);
+		}
+	}
+
+	/* Without all values only a win is known to be best */
+	return bComplete || bestValue == 1 ? bestMove : -1;
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::OrderMoves(const GameState& state, int depth, std::vector<int>& order)
+{
+	const Board& board = state.GetBoard();
+	const std::vector<Move>& moves = state.GetMoves();
+	Color player = state.GetNextPlayer();
+
+	/* Piece values for captures */
+	static const int captureValues[] = { 0, 5, 3, 0 };
+
+	std::vector<int> scores(moves.size(), 0);
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		const Move& move = moves[i];
+		int score = 0;
+
+		if (board.IsEnemyPiece(move.to, player))
+		{
+			score += CAPTURE_SCORE + captureValues[static_cast<int>(board.GetPieceType(move.to))];
+		}
+
+		if (GivesCheck(board, move, player))
+		{
+			score += CHECK_SCORE;
+		}
+
+		if (depth < static_cast<int>(m_killerMoves.size()))
+		{
+			if (m_killerMoves[depth][0] == move)
+			{
+				score += KILLER_SCORE;
+			}
+			else if (m_killerMoves[depth][1] == move)
+			{
+				score += KILLER_SCORE / 2;
+			}
+		}
+
+		score += std::min(m_historyScores[static_cast<int>(board.GetPiece(move.from))][move.to], KILLER_SCORE / 2 - 1);
+		scores[i] = score;
+	}
+
+	/* Equal scores keep the generation order */
+	std::stable_sort(order.begin(), order.end(), [&scores](int a, int b) { return scores[a] > scores[b]; });
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::RecordCutoff(const GameState& state, int depth, const Move& move)
+{
+	if (depth >= static_cast<int>(m_killerMoves.size()))
+	{
+		m_killerMoves.resize(depth + 1, { Move{ -1, -1, PieceType::None }, Move{ -1, -1, PieceType::None } });
+	}
+
+	std::array<Move, 2>& killers = m_killerMoves[depth];
+	if (!(killers[0] == move))
+	{
+		killers[1] = killers[0];
+		killers[0] = move;
+	}
+
+	m_historyScores[static_cast<int>(state.GetBoard().GetPiece(move.from))][move.to]++;
+}
+
+template<int Size>
+bool BasicEvaluationTree<Size>::GivesCheck(const Board& board, const Move& move, Color player)
+{
+	/* Field of the enemy king */
+	Piece enemyKing = player == Color::White ? Piece::BlackKing : Piece::WhiteKing;
+	int king = -1;
+	for (int i = 0; i < Size; i++)
+	{
+		if (board.GetPiece(i) == enemyKing)
+		{
+			king = i;
+			break;
+		}
+	}
+
+	if (king < 0)
+	{
+		return false;
+	}
+
+	switch (move.piece)
+	{
+	case PieceType::Knight:
+		return move.to - king == 2 || king - move.to == 2;
+	case PieceType::Rook:
+	{
+		/* Free line to the king, the start field is empty after the move */
+		int step = king > move.to ? 1 : -1;
+		for (int i = move.to + step; i != king; i += step)
+		{
+			if (i != move.from && !board.IsFree(i))
+			{
+				return false;
+			}
+		}
+		return true;
+	}
+	default:
+		/* Discovered checks are not detected, this is only for ordering */
+		return false;
+	}
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::GetEvaluationValue(CachedEvaluation eval)
 {
-	CachedEvaluation eval = GetCacheEntry(state);
 	switch (eval)
 	{
 		case CachedEvaluation::WhiteWins:
@@ -48,11 +537,51 @@ int EvaluationTree::GetGameStateEvaluation(const GameState& state)
 	}
 }
 
-int EvaluationTree::EvaluateRecursive(const GameState& state, EvaluationTreeNode* node)
+template<int Size>
+typename BasicEvaluationTree<Size>::CachedEvaluation BasicEvaluationTree<Size>::GetCachedEvaluation(int value)
+{
+	if (value == 1)
+	{
+		return CachedEvaluation::WhiteWins;
+	}
+	else if (value == -1)
+	{
+		return CachedEvaluation::BlackWins;
+	}
+	else
+	{
+		return CachedEvaluation::Draw;
+	}
+}
+
+template<int Size>
+int BasicEvaluationTree<Size>::EvaluateRecursive(const GameState& state, int positionIndex, EvaluationTreeNode* node)
 {
+	/* Unwind without storing anything */
+	if (m_bCancel.load(std::memory_order_relaxed))
+	{
+		return 0;
+	}
+
+	/* Positions the user looks at jump ahead */
+	if (m_bPriorityPending.load(std::memory_order_acquire) && !m_bServicingPriority)
+	{
+		ServicePriorityRequests();
+	}
+
+	if (m_profile)
+	{
+		m_profile->RecordVisit(node->depth, positionIndex);
+	}
+
     /* If the game is over, this is a leaf node. Return the value of the game */
 	if (state.IsGameOver())
 	{
+		if (m_profile)
+		{
+			m_profile->RecordTerminal(node->depth);
+		}
+
 		/* Stat: Check if depth record */
 		if (node->depth > m_highestDepth)
 		{
@@ -70,17 +599,23 @@ int EvaluationTree::EvaluateRecursive(const GameState& state, EvaluationTreeNode
 	}
 
 	/* Check if we already calculated that position */
-	CachedEvaluation result = GetCacheEntry(state);
+	CachedEvaluation result = GetCacheEntry(state, positionIndex);
 	if (result != CachedEvaluation::Unknown)
 	{
-		for (int i = 0; i < node->depth; i++)
+		if (m_bVerbose)
 		{
-			std::cout << "  ";
+			for (int i = 0; i < node->depth; i++)
+			{
+				std::cout << "  ";
+			}
+			std::cout << "Cache hit" << std::endl;
 		}
-		std::cout << "Cache hit" << std::endl;
 		m_cacheHits++;
 
-		m_cacheSaved += m_cacheStat[GetPositionIndex(state)];
+		if (m_profile)
+		{
+			m_profile->RecordHit(node->depth, positionIndex);
+		}
 
 		switch (result)
 		{
@@ -95,8 +630,30 @@ int EvaluationTree::EvaluateRecursive(const GameState& state, EvaluationTreeNode
 
 	/* Enumerate moves */
 	const std::vector<Move>& moves = state.GetMoves();
-	for (const Move& move : moves)
+	if (m_profile)
+	{
+		m_profile->RecordMiss(node->depth, moves.size());
+	}
+
+	/* Value per move in move order, -2 for moves skipped after a cutoff */
+	std::vector<int> moveValues(moves.size(), -2);
+	std::vector<int> order(moves.size());
+	std::iota(order.begin(), order.end(), 0);
+	if (m_bMoveOrdering)
+	{
+		OrderMoves(state, node->depth, order);
+	}
+
+	std::vector<int> successors;
+	PrefetchSuccessors(state, successors);
+
+	/* Best value the side to move can get */
+	int winValue = state.GetNextPlayer() == Color::White ? 1 : -1;
+
+	for (int moveNumber : order)
 	{
+		const Move& move = moves[moveNumber];
+
 		/* Make the move */
 		GameState newState = state;
 		newState.MakeMove(move);
@@ -106,23 +663,44 @@ int EvaluationTree::EvaluateRecursive(const GameState& state, EvaluationTreeNode
 		EvaluationTreeNode* newNode = new EvaluationTreeNode();
 		node->AddChild(newNode, move);
 
-		for (int i = 0; i < node->depth; i++)
+		if (m_bVerbose)
+		{
+			for (int i = 0; i < node->depth; i++)
+			{
+				std::cout << "  ";
+			}
+			std::cout << "Recursing into move: " << newNode->depth << ". " << move << "      " << newState.GetBoard() << std::endl;
+		}
+
+		newNode->value = EvaluateRecursive(newState, GetRepetitionIndex(successors[moveNumber], newState.GetRepetitionCount()), newNode);
+
+		if (m_bVerbose)
 		{
-			std::cout << "  ";
+			for (int i = 0; i < node->depth; i++)
+			{
+				std::cout << "  ";
+			}
+			std::cout << "Move " << newNode->depth << ". " << move << " has value " << newNode->value << std::endl;
 		}
-		std::cout << "Recursing into move: " << newNode->depth << ". " << move << "      " << newState.GetBoard() << std::endl;
 
-		newNode->value = EvaluateRecursive(newState, newNode);
+		moveValues[moveNumber] = newNode->value;
 
-		for (int i = 0; i < node->depth; i++)
+		/* A win can't be improved, the other moves don't matter */
+		if (m_bMoveOrdering && newNode->value == winValue && !m_bCancel.load(std::memory_order_relaxed))
 		{
-			std::cout << "  ";
+			RecordCutoff(state, node->depth, move);
+			break;
 		}
-		std::cout << "Move " << newNode->depth << ". " << move << " has value " << newNode->value << std::endl;
+	}
+
+	/* Children of a cancelled evaluation have no valid values */
+	if (m_bCancel.load(std::memory_order_relaxed))
+	{
+		return 0;
 	}
 
 	/* Calculate the value of the node */
-	if (node->depth % 2 == 0)
+	if (state.GetNextPlayer() == Color::White)
 	{
 		/* Maximize */
 		int max = INT_MIN;
@@ -149,136 +727,186 @@ int EvaluationTree::EvaluateRecursive(const GameState& state, EvaluationTreeNode
 		node->value = min;
 	}
 
-	/* Store the value in the cache */
-	CachedEvaluation value;
-	if (node->value == 1)
+	/* Everything below is known from the cache or the rules now, so the subtree is only counted */
+	if (!m_bKeepTree)
 	{
-		value = CachedEvaluation::WhiteWins;
+		node->PruneChildren();
 	}
-	else if (node->value == -1)
+
+	/* Positions outside of the layout can only be cached by hash. Closer to the root means a larger subtree, so that is the depth */
+	if (IsHashed(positionIndex))
 	{
-		value = CachedEvaluation::BlackWins;
+		TranspositionEntry entry;
+		entry.value = static_cast<int>(GetCachedEvaluation(node->value));
+		entry.depth = std::max(0, 0xFFFF - node->depth);
+		m_transpositionTable->Store(GetPositionKey(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount()), entry);
+		return node->value;
 	}
-	else
+	if (positionIndex < 0)
+	{
+		return node->value;
+	}
+
+	/* Store the outcome of every move, so annotation and engine play need no successor states.
+	   Written before the position entry, so readers seeing the position as known also see its moves */
+	uint32_t moveEntry = 0;
+	for (size_t i = 0; i < moveValues.size() && i < MAX_CACHED_MOVES; i++)
 	{
-		value = CachedEvaluation::Draw;
+		if (moveValues[i] != -2)
+		{
+			moveEntry |= static_cast<uint32_t>(GetCachedEvaluation(moveValues[i])) << (i * 2);
+		}
 	}
-	SetCacheEntry(state, value);
+	m_moveCache[positionIndex].store(moveEntry, std::memory_order_release);
+
+	/* Store the value in the cache */
+	SetCacheEntry(positionIndex, GetCachedEvaluation(node->value));
 
-	/* Also save how many nodes that saves in future */
-	m_cacheStat[GetPositionIndex(state)] = node->CountRecursive() - 1;
+	/* Also save how many nodes that saves in future. Counting is expensive, so only when profiling */
+	if (m_profile)
+	{
+		m_profile->RecordSubtree(positionIndex, node->CountRecursive() - 1);
+	}
 
 	return node->value;
 }
 
-EvaluationTree::CachedEvaluation EvaluationTree::GetCacheEntry(const GameState& state)
+template<int Size>
+void BasicEvaluationTree<Size>::PrefetchSuccessors(const GameState& state, std::vector<int>& indices) const
 {
-	int positionIndex = GetPositionIndex(state);
-	int cacheByte = m_positionCache[GetCacheIndex(positionIndex)];
-	int bitIndex = GetIntraByteIndex(positionIndex);
+	/* First repetition, the second one is in the same byte */
+	Color opponent = state.GetNextPlayer() == Color::White ? Color::Black : Color::White;
+	const std::vector<Move>& moves = state.GetMoves();
+	indices.resize(moves.size());
+	for (size_t i = 0; i < moves.size(); i++)
+	{
+		Board child = state.GetBoard();
+		child.SetPiece(moves[i].to, child.GetPiece(moves[i].from));
+		child.SetPiece(moves[i].from, Piece::None);
 
-	return static_cast<CachedEvaluation>((cacheByte >> (bitIndex * 2)) & 0b11);
+		indices[i] = GetPositionIndex(child, opponent, 1);
+
+		/* Hashed positions don't read the cache */
+		if (!m_bHashAll)
+		{
+			PrefetchIndex(indices[i]);
+		}
+	}
 }
 
-void EvaluationTree::SetCacheEntry(const GameState& state, CachedEvaluation value)
+template<int Size>
+int BasicEvaluationTree<Size>::GetRepetitionIndex(int firstIndex, int repetitionCount)
 {
-	int positionIndex = GetPositionIndex(state);
-	int cacheIndex = GetCacheIndex(positionIndex);
-	int bitIndex = GetIntraByteIndex(positionIndex);
-
-	unsigned char& cacheByte = m_positionCache[cacheIndex];
-	cacheByte &= ~(0b11 << (bitIndex * 2));
-	cacheByte |= (static_cast<unsigned char>(value) << (bitIndex * 2));
+	/* A third repetition is a draw by the rules and has no index, like in PositionLayout::Get */
+	if (firstIndex < 0 || repetitionCount < 1 || repetitionCount > 2)
+	{
+		return -1;
+	}
+	return firstIndex + repetitionCount - 1;
 }
 
-int EvaluationTree::GetPositionIndex(const GameState& state)
+template<int Size>
+std::vector<int> BasicEvaluationTree<Size>::GetSetupOrderIndices() const
 {
-	enum Elements {
-		WhiteKing,
-		WhiteKnight,
-		WhiteRook,
-		BlackRook,
-		BlackKnight,
-		BlackKing,
-		Turn,
-		Repetition
-	};
-
-	int index = 0;
+	std::ostringstream setupText;
+	setupText << m_setup;
+	PositionLayout<Size> setupLayout = PositionLayout<Size>::FromSetup(setupText.str());
 
-	/* Calculate unique index for position: Take index of single combinatory element and combine it with the remaining combination of possiblities. Add all elements up */
+	std::vector<int> indices(static_cast<size_t>(setupLayout.GetCount()), -1);
+	for (int i = 0; i < static_cast<int>(indices.size()); i++)
+	{
+		Board board;
+		Color nextPlayer;
+		int repetitionCount;
+		if (setupLayout.Decode(i, board, nextPlayer, repetitionCount))
+		{
+			indices[i] = static_cast<int>(m_layout.Get(board, nextPlayer, repetitionCount));
+		}
+	}
+	return indices;
+}
 
-	/* Possibilities for every combinatory element */
-	const int possibilities[] = {6, 5, 7, 7, 5, 6, 2, 2};
-	/* Actual state of element. Populate for pieces with the value for "taken" */
-	int elementIdentifiers[8] = {-1, 4, 6, 6, 4, 5, -1, -1};
+template<int Size>
+typename BasicEvaluationTree<Size>::CachedEvaluation BasicEvaluationTree<Size>::GetCacheEntry(const GameState& state) const
+{
+	return GetCacheEntry(state, GetPositionIndex(state));
+}
 
-	/* Accelerate by iterating over the board and calculate on occasion. Pieces not found have already the correct value initialized */
-	for (int i = 0; i < BOARD_SIZE; i++)
+template<int Size>
+typename BasicEvaluationTree<Size>::CachedEvaluation BasicEvaluationTree<Size>::GetCacheEntry(const GameState& state, int positionIndex) const
+{
+	if (IsHashed(positionIndex))
 	{
-		Piece piece = state.GetBoard().GetPiece(i);
+		TranspositionEntry entry;
+		bool bFound = m_transpositionTable->Probe(GetPositionKey(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount()), entry);
+		return bFound ? static_cast<CachedEvaluation>(entry.value) : CachedEvaluation::Unknown;
+	}
+	return GetCacheEntry(positionIndex);
+}
 
-		switch (piece)
-		{
-		case Piece::WhiteKing:
-			/* Take actual position. 6 and 7 are not reachable */
-			elementIdentifiers[WhiteKing] = i;
-			break;
-		case Piece::WhiteKnight:
-			/* Division by 2 yields index [1, 3, 5, 7] -> [0, 1, 2, 3] */
-			elementIdentifiers[WhiteKnight] = i / 2;
-			break;
-		case Piece::WhiteRook:
-			/* Shift, because left corner is not reachable (right corner too) */
-			elementIdentifiers[WhiteRook] = i - 1;
-			break;
-		case Piece::BlackRook:
-			/* Shift, because left corner is not reachable (right corner too) */
-			elementIdentifiers[BlackRook] = i - 1;
-			break;
-		case Piece::BlackKnight:
-			/* Division by 2 yields index [0, 2, 4, 6] -> [0, 1, 2, 3] */
-			elementIdentifiers[BlackKnight] = i / 2;
-			break;
-		case Piece::BlackKing:
-			/* Shift by 2 since 0 and 1 are not reachable */
-			elementIdentifiers[BlackKing] = i - 2;
-			break;
-		default:
-			break;
-		}
+template<int Size>
+typename BasicEvaluationTree<Size>::CachedEvaluation BasicEvaluationTree<Size>::GetCacheEntry(int positionIndex) const
+{
+	/* Positions without index were never evaluated */
+	if (positionIndex < 0)
+	{
+		return CachedEvaluation::Unknown;
 	}
 
-	/* Turn */
-	elementIdentifiers[Turn] = state.GetNextPlayer() == Color::White ? 0 : 1;
+	int cacheByte = m_positionCache[GetCacheIndex(positionIndex)].load(std::memory_order_acquire);
+	int bitIndex = GetIntraByteIndex(positionIndex);
+
+	return static_cast<CachedEvaluation>((cacheByte >> (bitIndex * 2)) & 0b11);
+}
+
+template<int Size>
+void BasicEvaluationTree<Size>::SetCacheEntry(int positionIndex, CachedEvaluation value)
+{
+	int cacheIndex = GetCacheIndex(positionIndex);
+	int bitIndex = GetIntraByteIndex(positionIndex);
+
+	/* Only the solver thread writes, so load and store don't need to be one atomic operation */
+	std::atomic<unsigned char>& cacheEntry = m_positionCache[cacheIndex];
+	unsigned char cacheByte = cacheEntry.load(std::memory_order_relaxed);
+	cacheByte &= ~(0b11 << (bitIndex * 2));
+	cacheByte |= (static_cast<unsigned char>(value) << (bitIndex * 2));
+	cacheEntry.store(cacheByte, std::memory_order_release);
+}
 
-	/* Repetition: A third repetition should never land here */
-	elementIdentifiers[Repetition] = state.GetRepetitionCount() - 1;
+template<int Size>
+int BasicEvaluationTree<Size>::GetPositionIndex(const GameState& state) const
+{
+	return GetPositionIndex(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount());
+}
 
-	/* Calculate index */
-	for (int i = 0; i < 8; i++)
+template<int Size>
+int BasicEvaluationTree<Size>::GetPositionIndex(const Board& board, Color nextPlayer, int repetitionCount) const
+{
+	if constexpr (Size == BOARD_SIZE)
 	{
-		/* Calculate remaining possibilities according to order */
-		int remaining = 1;
-		for (int j = i + 1; j < 8; j++)
+		if (m_bStandardLayout)
 		{
-			remaining *= possibilities[j];
+			return PositionIndex::Get(board, nextPlayer, repetitionCount);
 		}
-
-		index += elementIdentifiers[i] * remaining;
 	}
-
-	return index;
+	return static_cast<int>(m_layout.Get(board, nextPlayer, repetitionCount));
 }
 
-int EvaluationTree::GetCacheIndex(int positionIndex)
+template<int Size>
+int BasicEvaluationTree<Size>::GetCacheIndex(int positionIndex)
 {
 	/* We have 4 positions per byte stored (each 2 bit) */
 	return positionIndex / 4;
 }
 
-int EvaluationTree::GetIntraByteIndex(int positionIndex)
+template<int Size>
+int BasicEvaluationTree<Size>::GetIntraByteIndex(int positionIndex)
 {
 	/* We have 4 positions per byte stored (each 2 bit) */
 	return positionIndex % 4;
 }
+
+/* Supported board sizes */
+template class BasicEvaluationTree<8>;
+template class BasicEvaluationTree<10>;
+template class BasicEvaluationTree<12>;
@@ -1,6 +1,16 @@
 #pragma once
+#include <algorithm>
+#include <atomic>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include "Game.h"
+#include "PositionIndex.h"
+#include "PositionLayout.h"
+#include "Prefetch.h"
+#include "SearchProfile.h"
+#include "TranspositionTable.h"
 
 struct EvaluationTreeNode
 {
@@ -15,6 +25,9 @@ struct EvaluationTreeNode
 
 	std::vector<EvaluationTreeNodeTransition> children;
 
+	/* Nodes below this one which were released by PruneChildren */
+	uint64_t prunedNodes = 0;
+
 	void AddChild(EvaluationTreeNode* node, const Move& move)
 	{
 		node->depth = depth + 1;
@@ -43,9 +56,9 @@ struct EvaluationTreeNode
 		children = node->children;
 	}
 
-	int CountRecursive() const
+	uint64_t CountRecursive() const
 	{
-		int count = 1;
+		uint64_t count = 1 + prunedNodes;
 		for (const EvaluationTreeNodeTransition& transition : children)
 		{
 			count += transition.node->CountRecursive();
@@ -54,6 +67,13 @@ struct EvaluationTreeNode
 		return count;
 	}
 
+	/* Release the subtree, only its node count is kept */
+	void PruneChildren()
+	{
+		prunedNodes = CountRecursive() - 1;
+		children.clear();
+	}
+
 	~EvaluationTreeNode()
 	{
 		children.clear();
@@ -62,32 +82,94 @@ struct EvaluationTreeNode
 
 };
 
-class EvaluationTree
+/* Solver for boards with Size fields. The piece inventory comes from the setup, its index layout is derived by PositionLayout */
+template<int Size>
+class BasicEvaluationTree
 {
 public:
-	EvaluationTree() : Root(nullptr) {
-	/* Init position cache */
-	/* Cache for the position
-	* 6 positions for each king (can't approach other king)
-	* 4 positions for each knight (only one field color) + 1 for taken
-	* 6 positions for each rook (-1 due to own king to the left, -1 due to enemy king to the right, no possibility to "overtake"), + 1 for taken
-	* 2 in case there is same position with different turn
-	* 2 for for repetition counter (third repetition does not need cache, since it is detected as draw)
-	* Divide by 4 as we can store 4 eval results in one byte (3 different values for eval + 1 for not evaluated = 2 bits)
-	* [6 * 5 * 7 * 7 * 5 * 6 * 2 * 2 / 4 = 44,100]
-	*/
-		m_positionCache = std::make_unique<unsigned char[]>(44100);
-		m_cacheStat = std::make_unique<unsigned short[]>(44100 * 4);
-
-		std::fill_n(m_positionCache.get(), 44100, 0);
-	}
-	~EvaluationTree() = default;
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+	using PackedBoard = typename Board::Packed;
+
+	/* Tree for the starting setup of this size */
+	BasicEvaluationTree() : BasicEvaluationTree(Board::GetStartingPosition()) {}
+
+	/* Tree for a variant starting setup, see PositionLayout. The cache is indexed in the given digit order */
+	BasicEvaluationTree(const Board& setup, LayoutOrder order = LayoutOrder::Setup);
+
+	~BasicEvaluationTree();
 
 	/* Evaluate the position to the end */
 	int Evaluate(const GameState& state);
 
+	/* Evaluate on a worker thread. All getters can be used meanwhile and return unknown for positions not solved yet */
+	void StartEvaluation(const GameState& state);
+
+	/* If the worker thread is still solving */
+	bool IsEvaluationRunning() const { return m_bRunning.load(std::memory_order_acquire); }
+
+	/* Block until the worker thread is done */
+	void WaitForEvaluation();
+
+	/* Stop the worker thread. Unfinished positions stay unknown */
+	void CancelEvaluation();
+
+	/* Solve this position next, interrupting the running evaluation */
+	void RequestPriority(const GameState& state);
+
 	/* Returns evaluation for game state */
-	int GetGameStateEvaluation(const GameState& state);
+	int GetGameStateEvaluation(const GameState& state) const;
+
+	/* Returns evaluation for a bare position without building a game state. -2 if unknown or not indexable */
+	int GetPositionEvaluation(const Board& board, Color nextPlayer, int repetitionCount) const;
+
+	/* Hint that the entry of a position index is read soon, see PrefetchRead */
+	void PrefetchIndex(int positionIndex) const { PrefetchRead(&m_positionCache[GetCacheIndex(std::max(0, positionIndex))]); }
+
+	/* Returns evaluation of a position index of GetLayout. -2 if unknown */
+	int GetIndexEvaluation(int positionIndex) const { return GetEvaluationValue(GetCacheEntry(positionIndex)); }
+
+	/* Index layout of the setup, in the order of the constructor */
+	const PositionLayout<Size>& GetLayout() const { return m_layout; }
+
+	/* Returns evaluation after the move with the given number (order of GameState::GetMoves) without making the move. -2 if unknown */
+	int GetMoveEvaluation(const GameState& state, size_t moveNumber) const;
+
+	/* Returns number of an optimal move for the side to move, -1 if unknown */
+	int GetBestMove(const GameState& state) const;
+
+	/* Evaluate many packed positions (see PositionIndex::PackSideRepetition) at once. Results are -1, 0, 1 or -2 for unknown */
+	void ProbeBatch(const PackedBoard* boards, const unsigned char* sideRepetition, size_t count, signed char* results) const;
+
+	/* If the setup can be cached at all (one king per color) */
+	bool IsValidSetup() const { return m_layout.IsValid(); }
+
+	/* Write the position cache to a table file, read it back. Load fails if the file belongs to another setup.
+	 * Table files are in setup order, a cache in another order is converted */
+	bool SaveTable(std::ostream& os) const;
+	bool LoadTable(std::istream& is);
+
+	/* Header of a table file, followed by (positionCount + 3) / 4 packed cache bytes. For writers other than SaveTable */
+	static bool WriteTableHeader(std::ostream& os, const Board& setup, int64_t positionCount);
+
+	/* Record a SearchProfile in the following evaluations. Costs 12 bytes per position and time */
+	void EnableProfile();
+	const SearchProfile* GetProfile() const { return m_profile.get(); }
+
+	/* Search captures, checks, killer and history moves first and skip the remaining moves after a winning one.
+	 * Fewer nodes, but skipped moves stay unknown in GetMoveEvaluation */
+	void SetMoveOrdering(bool moveOrdering) { m_bMoveOrdering = moveOrdering; }
+
+	/* Cache positions without index (outside of the layout, or setups too large to index) in a transposition table, which can be
+	 * shared with other trees. With bHashAll it caches every position instead of the index cache; move evaluations stay unknown then */
+	void SetTranspositionTable(std::shared_ptr<TranspositionTable> table, bool bHashAll = false);
+
+	/* Keep the search tree below Root after Evaluate. Off by default: Every node is released once its value is known,
+	 * lines and proof trees are built from the cache on demand by LineExtractor */
+	void SetKeepTree(bool keepTree) { m_bKeepTree = keepTree; }
+
+	/* Toggle the node trace and stats output of Evaluate */
+	void SetVerbose(bool verbose) { m_bVerbose = verbose; }
 
 	std::unique_ptr<EvaluationTreeNode> Root;
 
@@ -101,29 +183,114 @@ private:
 		BlackWins
 	};
 
-	int EvaluateRecursive(const GameState& state, EvaluationTreeNode* node);
+	/* The position index of the state comes from the caller, see PrefetchSuccessors */
+	int EvaluateRecursive(const GameState& state, int positionIndex, EvaluationTreeNode* node);
+
+	/* Indices of all successors (in move order) at their first repetition. Their cache entries are prefetched,
+	 * before the first of them is searched */
+	void PrefetchSuccessors(const GameState& state, std::vector<int>& indices) const;
+
+	/* Index of a position at a repetition count, from the index of its first repetition (the lowest digit in every layout) */
+	static int GetRepetitionIndex(int firstIndex, int repetitionCount);
+
+	/* Index of every position of the setup order in m_layout, -1 for indices without position. For the table files */
+	std::vector<int> GetSetupOrderIndices() const;
+
+	/* Index layout of the setup. The standard setup in setup order uses the specialized PositionIndex instead */
+	Board m_setup;
+	PositionLayout<Size> m_layout;
+	bool m_bStandardLayout;
+
+	/* 4 positions per byte */
+	int m_cacheSize;
+	static constexpr int CACHE_PADDING = 4;
+
+	/* Cache for the position. Atomic, so it can be read while the worker thread writes */
+	std::unique_ptr<std::atomic<unsigned char>[]> m_positionCache;
+
+	/* Outcome of every move per position, 2 bits (CachedEvaluation) per move in move order. 0 = not evaluated */
+	static constexpr size_t MAX_CACHED_MOVES = 16;
+	std::unique_ptr<std::atomic<uint32_t>[]> m_moveCache;
+
+	/* Evaluate requested positions, called by the solver between nodes */
+	void ServicePriorityRequests();
+
+	/* Worker thread and its state */
+	std::thread m_worker;
+	std::atomic<bool> m_bRunning{ false };
+	std::atomic<bool> m_bCancel{ false };
+
+	/* Positions to solve next */
+	std::mutex m_priorityMutex;
+	std::deque<GameState> m_priorityRequests;
+	std::atomic<bool> m_bPriorityPending{ false };
+	bool m_bServicingPriority = false;
 
-	/* Cache for the position */
-	std::unique_ptr<unsigned char[]> m_positionCache;
+	/* Hashed cache, see SetTranspositionTable */
+	std::shared_ptr<TranspositionTable> m_transpositionTable;
+	bool m_bHashAll = false;
 
-	std::unique_ptr<unsigned short[]> m_cacheStat;
+	/* If a state is cached in the transposition table instead of the index cache */
+	bool IsHashed(int positionIndex) const { return m_transpositionTable && (m_bHashAll || positionIndex < 0); }
+
+	/* Profiling data, only recorded if enabled */
+	std::unique_ptr<SearchProfile> m_profile;
 
 	/* get cache entry */
-	CachedEvaluation GetCacheEntry(const GameState& state);
-	void SetCacheEntry(const GameState& state, CachedEvaluation value);
+	CachedEvaluation GetCacheEntry(const GameState& state) const;
+	CachedEvaluation GetCacheEntry(const GameState& state, int positionIndex) const;
+	CachedEvaluation GetCacheEntry(int positionIndex) const;
+	void SetCacheEntry(int positionIndex, CachedEvaluation value);
+
+	/* Translate cache entry to -1, 0, 1 or -2 for unknown */
+	static int GetEvaluationValue(CachedEvaluation eval);
+
+	/* Translate -1, 0, 1 to cache entry */
+	static CachedEvaluation GetCachedEvaluation(int value);
 
 	/* Cache index calculation */
 	/* Compute unambiguous value for a certain position/state */
-	int GetPositionIndex(const GameState& state);
+	int GetPositionIndex(const GameState& state) const;
+	int GetPositionIndex(const Board& board, Color nextPlayer, int repetitionCount) const;
+
 
 	/* Computes index in cache from position index */
-	int GetCacheIndex(int positionIndex);
+	static int GetCacheIndex(int positionIndex);
 
 	/* Computes index of 2-bit group inside byte */
-	int GetIntraByteIndex(int positionIndex);
+	static int GetIntraByteIndex(int positionIndex);
 
 	/* Some nice stats */
 	int m_highestDepth = 0;
-	int m_cacheHits = 0;
-	int m_cacheSaved = 0;
+	uint64_t m_cacheHits = 0;
+
+	/* Print node trace and stats */
+	bool m_bVerbose = true;
+
+	/* See SetKeepTree */
+	bool m_bKeepTree = false;
+
+	/* Move ordering */
+	bool m_bMoveOrdering = false;
+	static constexpr int CAPTURE_SCORE = 4000;
+	static constexpr int CHECK_SCORE = 2000;
+	static constexpr int KILLER_SCORE = 1000;
+
+	/* Sort move numbers by score */
+	void OrderMoves(const GameState& state, int depth, std::vector<int>& order);
+
+	/* Remember a move which won, as killer of its depth and in the history of its piece and target */
+	void RecordCutoff(const GameState& state, int depth, const Move& move);
+
+	/* If the moved piece attacks the enemy king from its target */
+	static bool GivesCheck(const Board& board, const Move& move, Color player);
+
+	/* Two killer moves per depth */
+	std::vector<std::array<Move, 2>> m_killerMoves;
+
+	/* Wins per piece and target field */
+	int m_historyScores[7][Size] = {};
 };
+
+/* Solver for the standard board */
+using EvaluationTree = BasicEvaluationTree<BOARD_SIZE>;
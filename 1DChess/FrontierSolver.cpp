@@ -0,0 +1,281 @@
+#include "FrontierSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <sstream>
+#include "BitslicedRules.h"
+#include "EvaluationTree.h"
+#include "Prefetch.h"
+
+template<int Size>
+FrontierSolver<Size>::FrontierSolver(const Board& setup, LayoutOrder order) : m_setup(setup)
+{
+	std::ostringstream setupText;
+	setupText << setup;
+	m_layout = PositionLayout<Size>::FromSetup(setupText.str(), order);
+}
+
+template<int Size>
+int FrontierSolver<Size>::Run()
+{
+	int rootIndex = IsValidSetup() ? static_cast<int>(m_layout.Get(m_setup, Color::White, 1)) : -1;
+	if (rootIndex < 0)
+	{
+		return -2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	m_table.assign((m_layout.GetCount() + 3) / 4, 0);
+	m_discovered.assign((m_layout.GetCount() + 63) / 64, 0);
+	m_positions = Positions();
+	m_successors.clear();
+	m_levelStarts.assign(1, 0);
+	m_passes = 0;
+	m_outsideLayout = 0;
+
+	/* Level by level until a level discovers nothing new */
+	Discover(m_setup, Color::White, rootIndex);
+	while (m_levelStarts.back() < m_positions.indices.size())
+	{
+		size_t begin = m_levelStarts.back();
+		size_t end = m_positions.indices.size();
+		m_levelStarts.push_back(end);
+		ExpandLevel(begin, end);
+	}
+	m_positions.successorStarts.push_back(static_cast<int>(m_successors.size()));
+
+	auto expanded = std::chrono::steady_clock::now();
+	m_expandSeconds = std::chrono::duration<double>(expanded - start).count();
+
+	while (PropagationPass() > 0)
+	{
+	}
+
+	/* Remaining open positions are draws */
+	for (int index : m_positions.indices)
+	{
+		if (GetEntry(index) == Rules::ENTRY_UNKNOWN)
+		{
+			SetValue(index, Rules::ENTRY_DRAW);
+		}
+	}
+
+	m_propagateSeconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - expanded).count();
+
+	switch (GetEntry(rootIndex))
+	{
+	case Rules::ENTRY_WHITE_WINS:
+		return 1;
+	case Rules::ENTRY_BLACK_WINS:
+		return -1;
+	default:
+		return 0;
+	}
+}
+
+template<int Size>
+bool FrontierSolver<Size>::ExportTable(std::ostream& os) const
+{
+	BasicEvaluationTree<Size>::WriteTableHeader(os, m_setup, m_layout.GetCount());
+	if (m_layout.GetOrder() == LayoutOrder::Setup)
+	{
+		os.write(reinterpret_cast<const char*>(m_table.data()), m_table.size());
+		return static_cast<bool>(os);
+	}
+
+	/* Same positions, other digit order: Move every solved entry to its index in the setup layout */
+	std::ostringstream setupText;
+	setupText << m_setup;
+	PositionLayout<Size> setupLayout = PositionLayout<Size>::FromSetup(setupText.str());
+
+	std::vector<unsigned char> table(m_table.size(), 0);
+	for (size_t i = 0; i < m_positions.indices.size(); i++)
+	{
+		int index = static_cast<int>(setupLayout.Get(Board::Unpack(m_positions.boards[i]), static_cast<Color>(m_positions.sides[i]), 1));
+		if (index < 0)
+		{
+			continue;
+		}
+		int value = GetEntry(m_positions.indices[i]);
+		for (int target : { index, Rules::GetSecondRepetition(setupLayout, index) })
+		{
+			table[target / 4] |= value << (target % 4 * 2);
+		}
+	}
+
+	os.write(reinterpret_cast<const char*>(table.data()), table.size());
+	return static_cast<bool>(os);
+}
+
+template<int Size>
+void FrontierSolver<Size>::PrintStats(std::ostream& os) const
+{
+	size_t widest = 0;
+	for (size_t level = 0; level + 1 < m_levelStarts.size(); level++)
+	{
+		widest = std::max(widest, m_levelStarts[level + 1] - m_levelStarts[level]);
+	}
+
+	os << "Levels: " << m_levelStarts.size() - 1 << ", widest: " << widest << " positions" << std::endl;
+	os << "Reachable positions: " << m_positions.indices.size() << " of " << m_layout.GetCount() / 2 << " indices" << std::endl;
+	os << "Successors: " << m_successors.size() << std::endl;
+	if (m_outsideLayout > 0)
+	{
+		os << "Successors outside of the layout: " << m_outsideLayout << std::endl;
+	}
+	os << "Passes: " << m_passes << std::endl;
+	os << "Expansion: " << m_expandSeconds << " s, propagation: " << m_propagateSeconds << " s" << std::endl;
+}
+
+template<int Size>
+void FrontierSolver<Size>::Discover(const Board& board, Color nextPlayer, int index)
+{
+	uint64_t& word = m_discovered[index / 64];
+	uint64_t bit = uint64_t(1) << (index % 64);
+	if (word & bit)
+	{
+		return;
+	}
+	word |= bit;
+
+	m_positions.boards.push_back(board.Pack());
+	m_positions.sides.push_back(static_cast<unsigned char>(nextPlayer));
+	m_positions.repetitions.push_back(1);
+	m_positions.indices.push_back(index);
+}
+
+template<int Size>
+void FrontierSolver<Size>::ExpandLevel(size_t begin, size_t end)
+{
+	using Batch = BitslicedRules<Size>;
+	constexpr int LANE_COUNT = Batch::LANE_COUNT;
+
+	Batch rules;
+	Board boards[LANE_COUNT];
+	std::vector<int> laneSuccessors[LANE_COUNT];
+
+	for (size_t first = begin; first < end; first += LANE_COUNT)
+	{
+		int laneCount = static_cast<int>(std::min<size_t>(LANE_COUNT, end - first));
+
+		rules.Clear();
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			boards[lane] = Board::Unpack(m_positions.boards[first + lane]);
+			rules.SetPosition(lane, boards[lane], static_cast<Color>(m_positions.sides[first + lane]));
+			laneSuccessors[lane].clear();
+		}
+		rules.Evaluate();
+
+		/* The game ends with insufficient material, so those positions have no successors */
+		uint64_t expand = rules.GetHasMoves() & ~rules.GetInsufficientMaterial();
+
+		for (int from = 0; from < Size; from++)
+		{
+			for (int to = 0; to < Size; to++)
+			{
+				uint64_t moves = rules.GetMoves(from, to) & expand;
+				for (int lane = 0; lane < laneCount && !IsEmpty(moves); lane++)
+				{
+					if (!GetLane(moves, lane))
+					{
+						continue;
+					}
+
+					Board child = boards[lane];
+					child.SetPiece(to, child.GetPiece(from));
+					child.SetPiece(from, Piece::None);
+
+					Color opponent = static_cast<Color>(m_positions.sides[first + lane]) == Color::White ? Color::Black : Color::White;
+					int childIndex = static_cast<int>(m_layout.Get(child, opponent, 1));
+					if (childIndex < 0)
+					{
+						m_outsideLayout++;
+					}
+					else
+					{
+						Discover(child, opponent, childIndex);
+					}
+					laneSuccessors[lane].push_back(childIndex);
+				}
+			}
+		}
+
+		/* Successors in position order, mates and draws by rule */
+		for (int lane = 0; lane < laneCount; lane++)
+		{
+			m_positions.successorStarts.push_back(static_cast<int>(m_successors.size()));
+			m_successors.insert(m_successors.end(), laneSuccessors[lane].begin(), laneSuccessors[lane].end());
+
+			int index = m_positions.indices[first + lane];
+			Color player = static_cast<Color>(m_positions.sides[first + lane]);
+			if (GetLane(rules.GetMate(), lane))
+			{
+				SetValue(index, Rules::GetWinEntry(player == Color::White ? Color::Black : Color::White));
+			}
+			else if (GetLane(rules.GetStalemate(), lane) || GetLane(rules.GetInsufficientMaterial(), lane))
+			{
+				SetValue(index, Rules::ENTRY_DRAW);
+			}
+		}
+	}
+}
+
+template<int Size>
+size_t FrontierSolver<Size>::PropagationPass()
+{
+	m_passes++;
+
+	/* Deepest levels first, so values travel towards the setup within one pass */
+	size_t resolved = 0;
+	const int* successors = m_successors.data();
+	for (size_t i = m_positions.indices.size(); i-- > 0;)
+	{
+		/* Entries of positions ahead are scattered over the table, load them meanwhile: The entry of a position
+		 * two distances ahead, and the successor entries of one distance ahead if that is still open */
+		if (m_bPrefetch && i >= 2 * PREFETCH_DISTANCE)
+		{
+			PrefetchRead(&m_table[m_positions.indices[i - 2 * PREFETCH_DISTANCE] / 4]);
+		}
+		if (m_bPrefetch && i >= PREFETCH_DISTANCE && GetEntry(m_positions.indices[i - PREFETCH_DISTANCE]) == Rules::ENTRY_UNKNOWN)
+		{
+			size_t ahead = i - PREFETCH_DISTANCE;
+			for (int j = m_positions.successorStarts[ahead]; j < m_positions.successorStarts[ahead + 1]; j++)
+			{
+				PrefetchRead(&m_table[std::max(0, successors[j]) / 4]);
+			}
+		}
+
+		int index = m_positions.indices[i];
+		if (GetEntry(index) != Rules::ENTRY_UNKNOWN)
+		{
+			continue;
+		}
+
+		int entry = Rules::Resolve(static_cast<Color>(m_positions.sides[i]), successors + m_positions.successorStarts[i], successors + m_positions.successorStarts[i + 1],
+			[this](int successor) { return successor < 0 ? Rules::ENTRY_UNKNOWN : GetEntry(successor); });
+		if (entry != Rules::ENTRY_UNKNOWN)
+		{
+			SetValue(index, entry);
+			resolved++;
+		}
+	}
+
+	return resolved;
+}
+
+template<int Size>
+void FrontierSolver<Size>::SetValue(int index, int value)
+{
+	for (int target : { index, Rules::GetSecondRepetition(m_layout, index) })
+	{
+		unsigned char& cacheByte = m_table[target / 4];
+		cacheByte &= ~(0b11 << (target % 4 * 2));
+		cacheByte |= value << (target % 4 * 2);
+	}
+}
+
+/* Supported board sizes */
+template class FrontierSolver<8>;
+template class FrontierSolver<10>;
+template class FrontierSolver<12>;
@@ -0,0 +1,97 @@
+#pragma once
+#include <climits>
+#include <iostream>
+#include <vector>
+#include "Game.h"
+#include "PositionLayout.h"
+#include "Retrograde.h"
+
+/* Solver without recursion: Breadth-first from the setup, one ply (level) at a time.
+ * Every level is expanded as a whole, in batches of BitslicedRules, and new positions are deduplicated by their index.
+ * The successor indices of all positions are kept in one array, so the following retrograde passes
+ * (like StreamingSolver, but only over the reachable positions) are sequential loops without any game state.
+ * Positions carry no history, so both repetition indices of a position get the same value.
+ * The table has the layout of the EvaluationTree cache, positions not reachable from the setup stay unknown.
+ * The solve itself can use another LayoutOrder for better locality, the export converts to the setup order */
+template<int Size>
+class FrontierSolver
+{
+public:
+	using Board = BasicBoard<Size>;
+	using PackedBoard = typename Board::Packed;
+
+	FrontierSolver(const Board& setup, LayoutOrder order = LayoutOrder::Setup);
+
+	/* If the setup can be indexed at all (one king per color, and int indices as the table is in memory) */
+	bool IsValidSetup() const { return m_layout.IsValid() && m_layout.GetCount() <= INT_MAX; }
+
+	/* Solve all reachable positions. Returns the value of the setup with white to move, -2 if the setup is invalid */
+	int Run();
+
+	/* Prefetch the entries of the successors of upcoming positions in the propagation passes.
+	 * Off by default: Most positions are resolved in the first pass, and --locality measured the passes slower with it */
+	void SetPrefetch(bool prefetch) { m_bPrefetch = prefetch; }
+
+	/* Write the solved table in the format of EvaluationTree::SaveTable */
+	bool ExportTable(std::ostream& os) const;
+
+	/* Levels, passes and timing */
+	void PrintStats(std::ostream& os) const;
+
+	double GetExpandSeconds() const { return m_expandSeconds; }
+	double GetPropagateSeconds() const { return m_propagateSeconds; }
+
+private:
+	using Rules = Retrograde<Size>;
+
+	/* Positions the prefetches of the propagation run ahead */
+	static constexpr size_t PREFETCH_DISTANCE = 8;
+
+	/* Reached positions as structure of arrays, in level order. Positions of level l are [m_levelStarts[l], m_levelStarts[l + 1]) */
+	struct Positions
+	{
+		std::vector<PackedBoard> boards;
+		std::vector<unsigned char> sides;
+
+		/* Repetition of the position index. Positions found by the expansion have no history, so always the first */
+		std::vector<unsigned char> repetitions;
+		std::vector<int> indices;
+
+		/* Successors of position i are m_successors[successorStarts[i]..successorStarts[i + 1]) */
+		std::vector<int> successorStarts;
+	};
+
+	/* Add a position if its index is new */
+	void Discover(const Board& board, Color nextPlayer, int index);
+
+	/* Expand the positions [begin, end): Record their successors, discover new ones and set mates and draws by rule */
+	void ExpandLevel(size_t begin, size_t end);
+
+	/* One sweep over the open positions from the last level to the first. Returns the number of resolved positions */
+	size_t PropagationPass();
+
+	/* Value for both repetition indices */
+	void SetValue(int index, int value);
+	int GetEntry(int index) const { return (m_table[index / 4] >> (index % 4 * 2)) & 0b11; }
+
+	Board m_setup;
+	PositionLayout<Size> m_layout;
+
+	Positions m_positions;
+	std::vector<size_t> m_levelStarts;
+	std::vector<int> m_successors;
+
+	/* Indices found so far, one bit each */
+	std::vector<uint64_t> m_discovered;
+
+	/* Packed table, 4 entries per byte */
+	std::vector<unsigned char> m_table;
+
+	bool m_bPrefetch = false;
+
+	/* Stats */
+	int m_passes = 0;
+	size_t m_outsideLayout = 0;
+	double m_expandSeconds = 0.0;
+	double m_propagateSeconds = 0.0;
+};
@@ -1,28 +1,34 @@
 #include "Game.h"
+#include <algorithm>
 
 
-bool GameState::IsGameOver() const
+template<int Size>
+bool BasicGameState<Size>::IsGameOver() const
 {
 	return IsDraw() || IsMate();
 }
 
-bool GameState::IsDraw() const
+template<int Size>
+bool BasicGameState<Size>::IsDraw() const
 {
 	return m_gameResult == GameResult::Draw;
 }
 
-bool GameState::IsMate() const
+template<int Size>
+bool BasicGameState<Size>::IsMate() const
 {
 	return m_gameResult == GameResult::WhiteWon || m_gameResult == GameResult::BlackWon;
 }
 
-Color GameState::GetWinner() const
+template<int Size>
+Color BasicGameState<Size>::GetWinner() const
 {
 	return m_gameResult == GameResult::WhiteWon ? Color::White : Color::Black;
 }
 
 
-void GameState::CalculateMoves()
+template<int Size>
+void BasicGameState<Size>::CalculateMoves()
 {
 	m_moves.clear();
 	/* A move candidate qualifies, when the resulting game state is valid */
@@ -31,7 +37,7 @@ void GameState::CalculateMoves()
 	for (const Move& move : m_moveCandidates)
 	{
 		/* Create a copy of the current game state */
-		GameState copy = *this;
+		BasicGameState copy = *this;
 		/* Make the move */
 		copy.MakeMoveUnchecked(move);
 		/* If the resulting game state is valid */
@@ -43,7 +49,8 @@ void GameState::CalculateMoves()
 	}
 }
 
-void GameState::CalculateAttackedFields()
+template<int Size>
+void BasicGameState<Size>::CalculateAttackedFields()
 {
 	/* Clear the attacked fields */
 	m_ownAttackedFields = {};
@@ -53,7 +60,7 @@ void GameState::CalculateAttackedFields()
 	m_notKingCount = 0;
 
 	/* Iterate over all fields */
-	for (int i = 0; i < BOARD_SIZE; i++)
+	for (int i = 0; i < Size; i++)
 	{
 		/* If the field is empty */
 		if (m_board.IsFree(i))
@@ -105,7 +112,8 @@ void GameState::CalculateAttackedFields()
 	}
 }
 
-void GameState::CalculateChecks()
+template<int Size>
+void BasicGameState<Size>::CalculateChecks()
 {
 	/* Clear the checks */
 	m_bOwnInCheck = false;
@@ -114,7 +122,7 @@ void GameState::CalculateChecks()
 	Color color = m_nextPlayer;
 
 	/* Iterate over all fields */
-	for (int i = 0; i < BOARD_SIZE; i++)
+	for (int i = 0; i < Size; i++)
 	{
 		/* If the field is empty */
 		if (m_board.IsFree(i))
@@ -142,7 +150,8 @@ void GameState::CalculateChecks()
 	}
 }
 
-void GameState::CalculateGameResult()
+template<int Size>
+void BasicGameState<Size>::CalculateGameResult()
 {
 	/* First: Check for mate
 	* For that we check if the player is in chess and there are 0 moves possible. We can directly see a draw reason, if there are 0 moves and no check */
@@ -173,7 +182,7 @@ void GameState::CalculateGameResult()
 		/* We have that board right now, so start with 1 */
 		int count = 1;
 		/* Check for threefold repetition */
-		for (const Board& board : m_history)
+		for (const BoardType& board : m_history)
 		{
 			if (board == m_board)
 			{
@@ -190,7 +199,8 @@ void GameState::CalculateGameResult()
 
 }
 
-void GameState::CalculateTargetFields(int position, std::vector<int>& targetFields)
+template<int Size>
+void BasicGameState<Size>::CalculateTargetFields(int position, std::vector<int>& targetFields)
 {
 	/* Early exit if the position is empty */
 	if (m_board.GetPiece(position) == Piece::None)
@@ -208,7 +218,7 @@ void GameState::CalculateTargetFields(int position, std::vector<int>& targetFiel
 	{
 		/* Rook movement is one-dimensional. So we just need to walk to paths and stop if any piece is encountered */
 		/* First path */
-		for (int j = position + 1; j < BOARD_SIZE; j++)
+		for (int j = position + 1; j < Size; j++)
 		{
 			/* If the position is empty or has an enemy piece */
 			if (!m_board.IsOwnPiece(j, color))
@@ -293,26 +303,30 @@ void GameState::CalculateTargetFields(int position, std::vector<int>& targetFiel
 	}
 }
 
-void GameState::CalculateBasicGameState()
+template<int Size>
+void BasicGameState<Size>::CalculateBasicGameState()
 {
 	/* We need those two to compute validity. Computing the moves would lead to recursion */
 	CalculateAttackedFields();
 	CalculateChecks();
 }
 
-void GameState::FinalizeGameState()
+template<int Size>
+void BasicGameState<Size>::FinalizeGameState()
 {
 	/* Compute remaining stuff, requiring computation of next level of game states */
 	CalculateMoves();
 	CalculateGameResult();
 }
 
-const std::vector<Move>& GameState::GetMoves() const
+template<int Size>
+const std::vector<Move>& BasicGameState<Size>::GetMoves() const
 {
 	return m_moves;
 }
 
-void GameState::MakeMove(const Move& move)
+template<int Size>
+void BasicGameState<Size>::MakeMove(const Move& move)
 {
 	/* Early exit if the game is over */
 	if (IsGameOver())
@@ -329,7 +343,8 @@ void GameState::MakeMove(const Move& move)
 	MakeMoveUnchecked(move);
 }
 
-void GameState::MakeMoveUnchecked(const Move& move)
+template<int Size>
+void BasicGameState<Size>::MakeMoveUnchecked(const Move& move)
 {
 	/* Save in history */
 	m_history.push_back(m_board);
@@ -344,3 +359,8 @@ void GameState::MakeMoveUnchecked(const Move& move)
 	/* Basic state calculation */
 	CalculateBasicGameState();
 }
+
+/* Supported board sizes */
+template class BasicGameState<8>;
+template class BasicGameState<10>;
+template class BasicGameState<12>;
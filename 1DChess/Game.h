@@ -1,6 +1,7 @@
 #pragma once
 #include "Board.h"
 #include <array>
+#include <string>
 #include <vector>
 
 
@@ -13,13 +14,19 @@ struct Move
 	/* Which piece moves */
 	PieceType piece;
 
-	/* Stream output */
-	friend std::ostream& operator<<(std::ostream& os, const Move& move)
+	/* Piece and target field, e.g. "N4". The notation of the stream output, for writers building strings */
+	std::string ToString() const
 	{
 		/* Translation from PieceType to character */
-		static const char* pieceNames[] = { "?", "R", "N", "K" };
+		static const char pieceNames[] = { '?', 'R', 'N', 'K' };
+
+		return pieceNames[(int)piece] + std::to_string(to + 1);
+	}
 
-		os << pieceNames[(int)move.piece] << move.to + 1;
+	/* Stream output */
+	friend std::ostream& operator<<(std::ostream& os, const Move& move)
+	{
+		os << move.ToString();
 		return os;
 	}
 
@@ -31,11 +38,19 @@ struct Move
 };
 
 /* class which contains the rules and can calculate moves */
-class GameState
+template<int Size>
+class BasicGameState
 {
 public:
+	using BoardType = BasicBoard<Size>;
 
-	GameState() : m_board(Board::GetStartingPosition()), m_nextPlayer(Color::White), m_bOwnInCheck(false), m_bEnemyInCheck(false), m_gameResult(GameResult::NotFinished), m_kingCount(0), m_notKingCount(0), m_repetitionCount(1)
+	BasicGameState() : m_board(BoardType::GetStartingPosition()), m_nextPlayer(Color::White), m_bOwnInCheck(false), m_bEnemyInCheck(false), m_gameResult(GameResult::NotFinished), m_kingCount(0), m_notKingCount(0), m_repetitionCount(1)
+	{
+		CalculateBasicGameState();
+	}
+
+	/* Start from an arbitrary position without history */
+	BasicGameState(const BoardType& board, Color nextPlayer) : m_board(board), m_nextPlayer(nextPlayer), m_bOwnInCheck(false), m_bEnemyInCheck(false), m_gameResult(GameResult::NotFinished), m_kingCount(0), m_notKingCount(0), m_repetitionCount(1)
 	{
 		CalculateBasicGameState();
 	}
@@ -71,15 +86,18 @@ public:
 	/* If the state is valid, i.e. no inverse check is present from an illegal move and both kings there */
 	bool IsValidState() const { return (!m_bEnemyInCheck && m_kingCount == 2); }
 
+	/* If the side to move is in check */
+	bool IsInCheck() const { return m_bOwnInCheck; }
+
 	/* Returns the number of occurences of this position (1 = first time) */
 	int GetRepetitionCount() const { return m_repetitionCount; }
 
 
 
 	/* Getters */
-	Board GetBoard() const { return m_board; }
+	const BoardType& GetBoard() const { return m_board; }
 	Color GetNextPlayer() const { return m_nextPlayer; }
-	std::vector<Board> GetHistory() const { return m_history; }
+	std::vector<BoardType> GetHistory() const { return m_history; }
 
 private:
 
@@ -107,12 +125,12 @@ private:
 	/* Calculates target fields for a piece on a given position */
 	void CalculateTargetFields(int position, std::vector<int>& targetFields);
 
-	Board m_board;
+	BoardType m_board;
 	Color m_nextPlayer;
 
 	/* History of states, to check for 3 move rule */
 	/* Currently this does not respect whose move it is */
-	std::vector<Board> m_history;
+	std::vector<BoardType> m_history;
 
 	/* internal helper states */
 	bool m_bOwnInCheck;
@@ -132,6 +150,9 @@ private:
 	std::vector<Move> m_moves;
 
 	/* attacked fields, needed for check calculation */
-	std::array<bool, BOARD_SIZE> m_ownAttackedFields;
-	std::array<bool, BOARD_SIZE> m_enemyAttackedFields;
-};
\ No newline at end of file
+	std::array<bool, Size> m_ownAttackedFields;
+	std::array<bool, Size> m_enemyAttackedFields;
+};
+
+/* The rules on the standard board */
+using GameState = BasicGameState<BOARD_SIZE>;
@@ -0,0 +1,204 @@
+#include "GameAnnotator.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <mutex>
+#include <sstream>
+#include <thread>
+#include <vector>
+
+namespace
+{
+	/* Value to text, shifted by 2 like in the interactive mode */
+	const char* gAnnotationValues[] = {
+		"?", "-1", "0", "1"
+	};
+
+	/* Batches done but not yet written, per thread. Workers wait instead of running further ahead of the output */
+	constexpr size_t PENDING_BATCHES_PER_THREAD = 4;
+}
+
+void GameAnnotatorResult::Add(const GameAnnotatorResult& other)
+{
+	games += other.games;
+	plies += other.plies;
+	blunders += other.blunders;
+	skipped += other.skipped;
+	illegal += other.illegal;
+}
+
+template<int Size>
+GameAnnotatorResult GameAnnotator<Size>::Run(const GameArchive& archive, std::ostream& output)
+{
+	int threadCount = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+
+	size_t batchGames = static_cast<size_t>(std::max(m_config.batchGames, 1));
+	size_t batchCount = (archive.GetGameCount() + batchGames - 1) / batchGames;
+	size_t window = PENDING_BATCHES_PER_THREAD * threadCount;
+
+	/* Lines of finished batches until they are written. Batches are taken in order, so the writer waits for few of them */
+	std::vector<std::string> outputs(batchCount);
+	std::vector<bool> done(batchCount, false);
+	size_t written = 0;
+	std::mutex mutex;
+	std::condition_variable changed;
+	std::atomic<size_t> nextBatch{ 0 };
+
+	std::vector<GameAnnotatorResult> results(threadCount);
+	std::vector<std::thread> workers;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back([&, i]()
+		{
+			std::string lines;
+			for (size_t batch = nextBatch++; batch < batchCount; batch = nextBatch++)
+			{
+				{
+					std::unique_lock<std::mutex> lock(mutex);
+					changed.wait(lock, [&]() { return batch < written + window; });
+				}
+
+				/* Remembered mate bounds are kept for one batch, so memory stays bounded */
+				LineExtractorConfig lineConfig;
+				lineConfig.maxDistance = m_config.maxDistance;
+				LineExtractor<Size> extractor(m_tree, lineConfig);
+
+				lines.clear();
+				size_t end = std::min((batch + 1) * batchGames, archive.GetGameCount());
+				for (size_t game = batch * batchGames; game < end; game++)
+				{
+					AnnotateGame(archive.GetGame(game), game + 1, extractor, lines, results[i]);
+				}
+
+				std::lock_guard<std::mutex> lock(mutex);
+				outputs[batch].swap(lines);
+				done[batch] = true;
+				changed.notify_all();
+			}
+		});
+	}
+
+	/* The calling thread writes, in one pass over the archive order */
+	for (size_t batch = 0; batch < batchCount; batch++)
+	{
+		std::string lines;
+		{
+			std::unique_lock<std::mutex> lock(mutex);
+			changed.wait(lock, [&]() { return done[batch]; });
+			lines.swap(outputs[batch]);
+			written = batch + 1;
+		}
+		changed.notify_all();
+		output.write(lines.data(), lines.size());
+	}
+
+	GameAnnotatorResult total;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers[i].join();
+		total.Add(results[i]);
+	}
+	output.flush();
+
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return total;
+}
+
+template<int Size>
+void GameAnnotator<Size>::PrintResult(const GameAnnotatorResult& result, std::ostream& os)
+{
+	double seconds = result.seconds > 0.0 ? result.seconds : 1e-9;
+
+	os << "Games: " << result.games << " in " << result.seconds << " s" << std::endl;
+	os << "Games/s: " << result.games / seconds << std::endl;
+	os << "Plies/s: " << result.plies / seconds << std::endl;
+	os << "Blunders: " << result.blunders << std::endl;
+	os << "Skipped: " << result.skipped << std::endl;
+	os << "Illegal: " << result.illegal << std::endl;
+}
+
+template<int Size>
+void GameAnnotator<Size>::AnnotateGame(const GameRecord& record, size_t number, LineExtractor<Size>& lines, std::string& output, GameAnnotatorResult& result) const
+{
+	output.append(std::to_string(number));
+
+	Board board = Board::Unpack(static_cast<typename Board::Packed>(record.startBoard));
+	GameState state(board, record.startPlayer);
+	if (record.fieldCount != Size || !state.IsValidState())
+	{
+		output.append(" skipped\n");
+		result.skipped++;
+		return;
+	}
+	state.FinalizeGameState();
+	result.games++;
+
+	std::ostringstream text;
+	text << ' ' << board << (record.startPlayer == Color::White ? " w " : " b ");
+	output.append(text.str());
+
+	int value = lines.GetValue(state);
+	AppendValue(state, value, lines, output);
+
+	for (int ply = 0; ply < record.plyCount; ply++)
+	{
+		/* The stored move without piece, matched against the legal ones */
+		Move stored = record.GetMove(ply);
+		const std::vector<Move>& moves = state.GetMoves();
+		auto move = std::find_if(moves.begin(), moves.end(), [&](const Move& legal) { return legal.from == stored.from && legal.to == stored.to; });
+		if (state.IsGameOver() || move == moves.end())
+		{
+			output.append(" illegal");
+			result.illegal++;
+			break;
+		}
+
+		Move played = *move;
+		state.MakeMove(played);
+		state.FinalizeGameState();
+		result.plies++;
+
+		output.push_back(' ');
+		output += played.ToString();
+		output.push_back(':');
+
+		int after = lines.GetValue(state);
+		AppendValue(state, after, lines, output);
+		if (value != -2 && after != -2 && after != value)
+		{
+			output.push_back('?');
+			result.blunders++;
+		}
+		value = after;
+	}
+
+	output.push_back('\n');
+}
+
+template<int Size>
+void GameAnnotator<Size>::AppendValue(const GameState& state, int value, LineExtractor<Size>& lines, std::string& output) const
+{
+	output.append(gAnnotationValues[value + 2]);
+	if (m_config.bDistance && (value == 1 || value == -1))
+	{
+		int distance = lines.GetMateDistance(state);
+		if (distance >= 0)
+		{
+			output.push_back('/');
+			output.append(std::to_string(distance));
+		}
+	}
+}
+
+/* Supported board sizes */
+template class GameAnnotator<8>;
+template class GameAnnotator<10>;
+template class GameAnnotator<12>;
@@ -0,0 +1,68 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include "EvaluationTree.h"
+#include "GameArchive.h"
+#include "LineExtractor.h"
+
+struct GameAnnotatorConfig
+{
+	/* 0 = one per hardware thread */
+	int threads = 0;
+
+	/* Games a thread annotates at once. Output is written per batch, in archive order */
+	int batchGames = 1024;
+
+	/* Mate distances of won and lost positions by LineExtractor, much slower than the values alone */
+	bool bDistance = false;
+	int maxDistance = 50;
+};
+
+struct GameAnnotatorResult
+{
+	uint64_t games = 0;
+	uint64_t plies = 0;
+
+	/* Moves changing the value of the game */
+	uint64_t blunders = 0;
+
+	/* Games of another board size than the tree, or with an impossible start */
+	uint64_t skipped = 0;
+
+	/* Games ending early at a move that isn't legal */
+	uint64_t illegal = 0;
+
+	double seconds = 0.0;
+
+	void Add(const GameAnnotatorResult& other);
+};
+
+/* Replays the games of an archive on all cores and writes one line per game:
+ * "<game> <start board> <w|b> <value>" and per ply "<move>:<value after it>", e.g. "3 KNR..rnk w 1 N4:1 R5:1 K2:0? ...".
+ * With distances a won or lost value is followed by "/<plies to mate>". A move changing the value is a blunder and marked by "?".
+ * Values come from the table and, at the end of a game, the rules, so repetitions count like in the game */
+template<int Size>
+class GameAnnotator
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	GameAnnotator(const BasicEvaluationTree<Size>& tree, const GameAnnotatorConfig& config) : m_tree(tree), m_config(config) {}
+
+	/* Annotate all games, the lines are written in archive order as soon as a batch and all before it are done */
+	GameAnnotatorResult Run(const GameArchive& archive, std::ostream& output);
+
+	static void PrintResult(const GameAnnotatorResult& result, std::ostream& os);
+
+private:
+	/* Append the line of one game */
+	void AnnotateGame(const GameRecord& record, size_t number, LineExtractor<Size>& lines, std::string& output, GameAnnotatorResult& result) const;
+
+	/* Value, and the distance if enabled */
+	void AppendValue(const GameState& state, int value, LineExtractor<Size>& lines, std::string& output) const;
+
+	const BasicEvaluationTree<Size>& m_tree;
+	GameAnnotatorConfig m_config;
+};
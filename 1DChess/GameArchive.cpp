@@ -0,0 +1,100 @@
+#include "GameArchive.h"
+#include <cstring>
+
+bool GameArchive::WriteHeader(std::ostream& os)
+{
+	os.write(GAME_ARCHIVE_MAGIC, sizeof(GAME_ARCHIVE_MAGIC));
+	os.write(reinterpret_cast<const char*>(&GAME_ARCHIVE_VERSION), sizeof(GAME_ARCHIVE_VERSION));
+	return static_cast<bool>(os);
+}
+
+bool GameArchive::WriteGame(std::ostream& os, int fieldCount, Color startPlayer, uint64_t startBoard, const std::vector<Move>& moves)
+{
+	if (fieldCount <= 0 || fieldCount > 16 || moves.size() > MAX_PLIES)
+	{
+		return false;
+	}
+
+	unsigned char header[GAME_HEADER_BYTES];
+	header[0] = static_cast<unsigned char>(fieldCount);
+	header[1] = startPlayer == Color::White ? 0 : 1;
+	uint16_t plyCount = static_cast<uint16_t>(moves.size());
+	std::memcpy(header + 2, &startBoard, sizeof(startBoard));
+	std::memcpy(header + 2 + sizeof(startBoard), &plyCount, sizeof(plyCount));
+	os.write(reinterpret_cast<const char*>(header), sizeof(header));
+
+	for (const Move& move : moves)
+	{
+		os.put(static_cast<char>(move.from | (move.to << 4)));
+	}
+	return static_cast<bool>(os);
+}
+
+bool GameArchive::Open(const std::string& path)
+{
+	Close();
+	if (!m_file.Open(path))
+	{
+		return false;
+	}
+
+	const unsigned char* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	uint32_t version = 0;
+	size_t offset = sizeof(GAME_ARCHIVE_MAGIC) + sizeof(version);
+	if (size < offset || std::memcmp(data, GAME_ARCHIVE_MAGIC, sizeof(GAME_ARCHIVE_MAGIC)) != 0)
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&version, data + sizeof(GAME_ARCHIVE_MAGIC), sizeof(version));
+	if (version != GAME_ARCHIVE_VERSION)
+	{
+		Close();
+		return false;
+	}
+
+	/* Only the ply counts are read, one pass over the headers */
+	while (offset < size)
+	{
+		uint16_t plyCount = 0;
+		if (size - offset < GAME_HEADER_BYTES)
+		{
+			Close();
+			return false;
+		}
+		std::memcpy(&plyCount, data + offset + 2 + sizeof(uint64_t), sizeof(plyCount));
+		if (size - offset - GAME_HEADER_BYTES < plyCount)
+		{
+			Close();
+			return false;
+		}
+
+		m_offsets.push_back(offset);
+		offset += GAME_HEADER_BYTES + plyCount;
+	}
+
+	return true;
+}
+
+void GameArchive::Close()
+{
+	m_file.Close();
+	m_offsets.clear();
+}
+
+GameRecord GameArchive::GetGame(size_t game) const
+{
+	const unsigned char* data = m_file.GetData() + m_offsets[game];
+
+	GameRecord record;
+	uint16_t plyCount = 0;
+	record.fieldCount = data[0];
+	record.startPlayer = data[1] == 0 ? Color::White : Color::Black;
+	std::memcpy(&record.startBoard, data + 2, sizeof(record.startBoard));
+	std::memcpy(&plyCount, data + 2 + sizeof(record.startBoard), sizeof(plyCount));
+	record.plyCount = plyCount;
+	record.plies = data + GAME_HEADER_BYTES;
+	return record;
+}
@@ -0,0 +1,57 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Game.h"
+#include "MappedFile.h"
+
+/* Game archive file: Magic, version, then the games back to back. A game is the board size, the side to move at the start,
+ * the start board packed like BasicBoard::Pack, the number of plies and one byte per ply: from in the low 4 bits, to in the high ones.
+ * The piece of a Move follows from the board, so it isn't stored */
+constexpr char GAME_ARCHIVE_MAGIC[4] = { '1', 'D', 'C', 'G' };
+constexpr uint32_t GAME_ARCHIVE_VERSION = 1;
+
+/* Game of an archive, pointing into the mapped file */
+struct GameRecord
+{
+	int fieldCount = 0;
+	Color startPlayer = Color::White;
+	uint64_t startBoard = 0;
+	int plyCount = 0;
+	const unsigned char* plies = nullptr;
+
+	/* Move of a ply, without the piece */
+	Move GetMove(int ply) const { return { plies[ply] & 0xF, plies[ply] >> 4, PieceType::None }; }
+};
+
+/* Archive of played games, read through a file mapping. Open finds where every game starts, after that games can be read
+ * in any order from any thread */
+class GameArchive
+{
+public:
+	/* Longest game of the format */
+	static constexpr int MAX_PLIES = 0xFFFF;
+
+	static bool WriteHeader(std::ostream& os);
+
+	/* Append a game. Boards have at most 16 fields, moves are those of GameState::GetMoves */
+	static bool WriteGame(std::ostream& os, int fieldCount, Color startPlayer, uint64_t startBoard, const std::vector<Move>& moves);
+
+	/* Map an archive and index its games. False if it is no archive or a game is cut off */
+	bool Open(const std::string& path);
+	void Close();
+
+	size_t GetGameCount() const { return m_offsets.size(); }
+	GameRecord GetGame(size_t game) const;
+
+private:
+	/* Size, side, board, plies */
+	static constexpr size_t GAME_HEADER_BYTES = 1 + 1 + sizeof(uint64_t) + sizeof(uint16_t);
+
+	MappedFile m_file;
+
+	/* Start of every game in the file */
+	std::vector<size_t> m_offsets;
+};
@@ -0,0 +1,121 @@
+#include "LayoutReport.h"
+#include <algorithm>
+#include "PositionIterator.h"
+#include "Retrograde.h"
+
+template<int Size>
+LayoutStats LayoutReport<Size>::Measure(const PositionLayout<Size>& layout, uint64_t maxPositions)
+{
+	CacheModel l1(32 << 10, 8);
+	CacheModel l2(1 << 20, 16);
+
+	LayoutStats stats;
+	std::vector<int64_t> successors;
+	std::vector<uint64_t> lines;
+
+	for (PositionIterator<Size> position(layout); stats.positions < maxPositions && position.Next();)
+	{
+		if (position.GetRepetitionCount() != 1)
+		{
+			continue;
+		}
+
+		BasicGameState<Size>& state = position.GetState();
+		state.FinalizeGameState();
+		if (state.IsGameOver() || !Retrograde<Size>::GetSuccessors(layout, state, successors))
+		{
+			continue;
+		}
+		stats.positions++;
+
+		/* Line of an entry: 4 entries per byte */
+		uint64_t ownLine = static_cast<uint64_t>(position.GetIndex()) / 4 / LINE_BYTES;
+		lines.assign(1, ownLine);
+		for (int64_t successor : successors)
+		{
+			uint64_t line = static_cast<uint64_t>(successor) / 4 / LINE_BYTES;
+			stats.sameLine += line == ownLine ? 1 : 0;
+			lines.push_back(line);
+		}
+		stats.successors += successors.size();
+
+		for (uint64_t line : lines)
+		{
+			stats.accesses++;
+			if (!l1.Access(line))
+			{
+				stats.l1Misses++;
+				stats.l2Misses += l2.Access(line) ? 0 : 1;
+			}
+		}
+
+		std::sort(lines.begin() + 1, lines.end());
+		stats.successorLines += std::unique(lines.begin() + 1, lines.end()) - (lines.begin() + 1);
+	}
+
+	return stats;
+}
+
+template<int Size>
+void LayoutReport<Size>::PrintOrder(std::ostream& os, const PositionLayout<Size>& layout)
+{
+	/* Piece to character, like the stream operator of Board */
+	static const char pieceNames[] = { '.', 'R', 'N', 'K', 'r', 'n', 'k' };
+
+	int pieceCount = layout.GetElementCount() - 2;
+	for (int digit = 0; digit < pieceCount; digit++)
+	{
+		os << pieceNames[static_cast<int>(layout.GetPiece(layout.GetDigitElement(digit)))];
+	}
+	os << "|tr";
+}
+
+template<int Size>
+void LayoutReport<Size>::PrintStats(std::ostream& os, const LayoutStats& stats)
+{
+	double positions = static_cast<double>(std::max<uint64_t>(stats.positions, 1));
+	double accesses = static_cast<double>(std::max<uint64_t>(stats.accesses, 1));
+
+	os << "Positions: " << stats.positions << ", successors: " << stats.successors << std::endl;
+	os << "Successors in the own cache line: " << 100.0 * stats.sameLine / std::max<uint64_t>(stats.successors, 1) << " %" << std::endl;
+	os << "Successor cache lines per position: " << stats.successorLines / positions << std::endl;
+	os << "Simulated misses per 1000 reads: 32 KB " << 1000.0 * stats.l1Misses / accesses << ", 1 MB " << 1000.0 * stats.l2Misses / accesses << std::endl;
+}
+
+template<int Size>
+LayoutReport<Size>::CacheModel::CacheModel(size_t bytes, int ways) : m_ways(ways), m_sets(bytes / LINE_BYTES / ways)
+{
+	/* Tag 0 is a valid line, so empty ways are marked by never having been used */
+	m_tags.assign(m_sets * ways, 0);
+	m_lastUse.assign(m_sets * ways, 0);
+}
+
+template<int Size>
+bool LayoutReport<Size>::CacheModel::Access(uint64_t line)
+{
+	m_useCounter++;
+
+	size_t first = static_cast<size_t>(line % m_sets) * m_ways;
+	size_t victim = first;
+	for (size_t way = first; way < first + m_ways; way++)
+	{
+		if (m_lastUse[way] != 0 && m_tags[way] == line)
+		{
+			m_lastUse[way] = m_useCounter;
+			return true;
+		}
+		if (m_lastUse[way] < m_lastUse[victim])
+		{
+			victim = way;
+		}
+	}
+
+	m_tags[victim] = line;
+	m_lastUse[victim] = m_useCounter;
+	return false;
+}
+
+/* Supported board sizes */
+template class LayoutReport<8>;
+template class LayoutReport<10>;
+template class LayoutReport<12>;
@@ -0,0 +1,58 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "PositionLayout.h"
+
+/* Memory access pattern of a table walk over a layout, like the passes of the retrograde solvers */
+struct LayoutStats
+{
+	/* Positions walked (first repetition) and their successors */
+	uint64_t positions = 0;
+	uint64_t successors = 0;
+
+	/* Successors in the cache line of their position */
+	uint64_t sameLine = 0;
+
+	/* Distinct cache lines of the successors of a position, summed */
+	uint64_t successorLines = 0;
+
+	/* Entry reads (position and successors) and their misses in the simulated caches */
+	uint64_t accesses = 0;
+	uint64_t l1Misses = 0;
+	uint64_t l2Misses = 0;
+};
+
+/* Compares layouts without hardware counters: Walks the positions in index order, reads the table entry of each
+ * position and its successors through a model of a 32 KB and a 1 MB set-associative LRU cache with 64 byte lines */
+template<int Size>
+class LayoutReport
+{
+public:
+	/* Walk at most maxPositions positions from index 0 */
+	static LayoutStats Measure(const PositionLayout<Size>& layout, uint64_t maxPositions);
+
+	/* Digits from the highest, in setup notation, e.g. "NnKkRr|tr" */
+	static void PrintOrder(std::ostream& os, const PositionLayout<Size>& layout);
+
+	static void PrintStats(std::ostream& os, const LayoutStats& stats);
+
+private:
+	static constexpr int LINE_BYTES = 64;
+
+	class CacheModel
+	{
+	public:
+		CacheModel(size_t bytes, int ways);
+
+		/* False on a miss, the line is loaded then */
+		bool Access(uint64_t line);
+
+	private:
+		int m_ways;
+		size_t m_sets;
+		std::vector<uint64_t> m_tags;
+		std::vector<uint64_t> m_lastUse;
+		uint64_t m_useCounter = 0;
+	};
+};
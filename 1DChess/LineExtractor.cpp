@@ -0,0 +1,259 @@
+#include "LineExtractor.h"
+#include <algorithm>
+
+template<int Size>
+int LineExtractor<Size>::GetValue(const GameState& state) const
+{
+	if (state.IsGameOver())
+	{
+		if (state.IsMate())
+		{
+			return state.GetWinner() == Color::White ? 1 : -1;
+		}
+		return 0;
+	}
+	return m_tree.GetGameStateEvaluation(state);
+}
+
+template<int Size>
+int LineExtractor<Size>::GetMateDistance(const GameState& state)
+{
+	int value = GetValue(state);
+	if (value != 1 && value != -1)
+	{
+		return -1;
+	}
+
+	/* The mover of a mate is the winner, so the distance is odd if the winner moves and even otherwise */
+	Color winner = value == 1 ? Color::White : Color::Black;
+	for (int bound = state.GetNextPlayer() == winner ? 1 : 0; bound <= m_config.maxDistance; bound += 2)
+	{
+		if (MatesWithin(state, bound, winner))
+		{
+			return bound;
+		}
+	}
+	return -2;
+}
+
+template<int Size>
+std::vector<Move> LineExtractor<Size>::GetPrincipalVariation(const GameState& start)
+{
+	std::vector<Move> line;
+	GameState state = start;
+
+	while (!state.IsGameOver() && static_cast<int>(line.size()) < m_config.maxPlies)
+	{
+		int value = GetValue(state);
+		if (value == -2)
+		{
+			break;
+		}
+
+		const std::vector<Move>& moves = state.GetMoves();
+		int bestMove = -1;
+		int bestDistance = 0;
+		bool bWinnerMoves = (value == 1) == (state.GetNextPlayer() == Color::White);
+		for (size_t i = 0; i < moves.size(); i++)
+		{
+			GameState successor = GetSuccessor(state, moves[i]);
+			if (GetValue(successor) != value)
+			{
+				continue;
+			}
+
+			/* Any drawing move keeps a draw */
+			if (value == 0)
+			{
+				bestMove = static_cast<int>(i);
+				break;
+			}
+
+			int distance = GetMateDistance(successor);
+			if (distance < 0)
+			{
+				continue;
+			}
+			if (bestMove < 0 || (bWinnerMoves ? distance < bestDistance : distance > bestDistance))
+			{
+				bestMove = static_cast<int>(i);
+				bestDistance = distance;
+			}
+		}
+
+		if (bestMove < 0)
+		{
+			break;
+		}
+
+		Move move = moves[bestMove];
+		line.push_back(move);
+		state = GetSuccessor(state, move);
+	}
+
+	return line;
+}
+
+template<int Size>
+bool LineExtractor<Size>::GetProofTree(const GameState& state, ProofTreeNode& root)
+{
+	root = ProofTreeNode();
+	root.distance = GetMateDistance(state);
+	if (root.distance < 0)
+	{
+		return false;
+	}
+
+	size_t nodeCount = 1;
+	return ExpandProof(state, root, nodeCount);
+}
+
+template<int Size>
+void LineExtractor<Size>::PrintLine(std::ostream& os, const std::vector<Move>& moves)
+{
+	for (size_t ply = 0; ply < moves.size(); ply++)
+	{
+		os << (ply > 0 ? " " : "") << ply + 1 << ". " << moves[ply];
+	}
+	os << std::endl;
+}
+
+template<int Size>
+void LineExtractor<Size>::PrintProofTree(std::ostream& os, const ProofTreeNode& root)
+{
+	os << "Mate in " << root.distance << " plies" << std::endl;
+	for (const ProofTreeNode& child : root.children)
+	{
+		PrintProofNode(os, child, 1);
+	}
+}
+
+template<int Size>
+bool LineExtractor<Size>::MatesWithin(const GameState& state, int bound, Color winner)
+{
+	if (state.IsGameOver())
+	{
+		return state.IsMate() && state.GetWinner() == winner;
+	}
+	if (bound <= 0)
+	{
+		return false;
+	}
+
+	uint64_t key = GetPositionKey(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount());
+	auto known = m_bounds.find(key);
+	if (known != m_bounds.end())
+	{
+		if (bound >= known->second.proven)
+		{
+			return true;
+		}
+		if (bound <= known->second.failed)
+		{
+			return false;
+		}
+	}
+
+	/* Only won positions can mate, which prunes every move giving the win away */
+	if (GetValue(state) != (winner == Color::White ? 1 : -1))
+	{
+		return false;
+	}
+
+	/* The winner needs one mating move, the loser must have none escaping */
+	bool bWinnerMoves = state.GetNextPlayer() == winner;
+	bool bMates = !bWinnerMoves;
+	for (const Move& move : state.GetMoves())
+	{
+		if (MatesWithin(GetSuccessor(state, move), bound - 1, winner) == bWinnerMoves)
+		{
+			bMates = bWinnerMoves;
+			break;
+		}
+	}
+
+	/* Lookup again, the recursion may have rehashed the map */
+	Bounds& bounds = m_bounds[key];
+	if (bMates)
+	{
+		bounds.proven = std::min(bounds.proven, bound);
+	}
+	else
+	{
+		bounds.failed = std::max(bounds.failed, bound);
+	}
+	return bMates;
+}
+
+template<int Size>
+bool LineExtractor<Size>::ExpandProof(const GameState& state, ProofTreeNode& node, size_t& nodeCount)
+{
+	if (state.IsGameOver())
+	{
+		return true;
+	}
+
+	Color winner = node.distance % 2 == 1 ? state.GetNextPlayer() : (state.GetNextPlayer() == Color::White ? Color::Black : Color::White);
+	bool bWinnerMoves = state.GetNextPlayer() == winner;
+
+	for (const Move& move : state.GetMoves())
+	{
+		GameState successor = GetSuccessor(state, move);
+
+		/* The winner's move has to keep the distance, the loser's moves can only shorten it */
+		if (bWinnerMoves && !MatesWithin(successor, node.distance - 1, winner))
+		{
+			continue;
+		}
+
+		if (++nodeCount > m_config.maxProofNodes)
+		{
+			return false;
+		}
+
+		ProofTreeNode child;
+		child.move = move;
+		child.distance = GetMateDistance(successor);
+		node.children.push_back(child);
+		if (!ExpandProof(successor, node.children.back(), nodeCount))
+		{
+			return false;
+		}
+
+		if (bWinnerMoves)
+		{
+			break;
+		}
+	}
+
+	return true;
+}
+
+template<int Size>
+typename LineExtractor<Size>::GameState LineExtractor<Size>::GetSuccessor(const GameState& state, const Move& move)
+{
+	GameState successor = state;
+	successor.MakeMove(move);
+	successor.FinalizeGameState();
+	return successor;
+}
+
+template<int Size>
+void LineExtractor<Size>::PrintProofNode(std::ostream& os, const ProofTreeNode& node, int depth)
+{
+	for (int i = 1; i < depth; i++)
+	{
+		os << "  ";
+	}
+	os << depth << ". " << node.move << " (" << node.distance << ")" << std::endl;
+
+	for (const ProofTreeNode& child : node.children)
+	{
+		PrintProofNode(os, child, depth + 1);
+	}
+}
+
+/* Supported board sizes */
+template class LineExtractor<8>;
+template class LineExtractor<10>;
+template class LineExtractor<12>;
@@ -0,0 +1,92 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <unordered_map>
+#include <vector>
+#include "EvaluationTree.h"
+
+struct LineExtractorConfig
+{
+	/* Longest mate searched for, in plies. Wins beyond it have no distance */
+	int maxDistance = 200;
+
+	/* Length limit of drawn lines, which can go on until a repetition ends them */
+	int maxPlies = 100;
+
+	/* Size limit of proof trees */
+	size_t maxProofNodes = 100000;
+};
+
+/* Node of a proof tree. The root has no move */
+struct ProofTreeNode
+{
+	Move move = {};
+
+	/* Plies to mate from here */
+	int distance = 0;
+
+	std::vector<ProofTreeNode> children;
+};
+
+/* Lines and proof trees of a solved tree (or a loaded table), built on demand from the cached values instead of a resident search tree.
+ * The cache only holds win, draw or loss, so mate distances come from a search over value-preserving moves:
+ * Iterative deepening, with the bounds proven per position remembered across calls */
+template<int Size>
+class LineExtractor
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	LineExtractor(const BasicEvaluationTree<Size>& tree, const LineExtractorConfig& config = LineExtractorConfig()) : m_tree(tree), m_config(config) {}
+
+	/* Value of a finalized state: -1, 0, 1, or -2 if unknown. Game over states are valued by the rules */
+	int GetValue(const GameState& state) const;
+
+	/* Plies to mate if both sides play best: The winner mates as fast as possible, the loser delays as long as possible.
+	 * -1 if the state is no win, -2 if the mate is longer than maxDistance */
+	int GetMateDistance(const GameState& state);
+
+	/* Optimal line from a finalized state: Only value-preserving moves, the shortest win for the winner and the longest defence for the loser.
+	 * Drawn lines follow drawing moves until the game ends or maxPlies. Ends early at unknown values */
+	std::vector<Move> GetPrincipalVariation(const GameState& state);
+
+	/* Minimal proof tree of a won state: The fastest mating move at the winner's turns, every move at the loser's.
+	 * False if the state is no win, has no distance or the tree exceeds maxProofNodes */
+	bool GetProofTree(const GameState& state, ProofTreeNode& root);
+
+	/* Line in Move notation with ply numbers, like the node trace of EvaluationTree */
+	static void PrintLine(std::ostream& os, const std::vector<Move>& moves);
+
+	/* One node per line, indented by depth */
+	static void PrintProofTree(std::ostream& os, const ProofTreeNode& root);
+
+	/* Positions with remembered bounds */
+	size_t GetBoundCount() const { return m_bounds.size(); }
+
+private:
+	/* Mate bounds of a position, keyed by GetPositionKey */
+	struct Bounds
+	{
+		/* Largest bound without mate, -1 if none */
+		int failed = -1;
+
+		/* Smallest bound with mate, INT32_MAX if none */
+		int proven = INT32_MAX;
+	};
+
+	/* If winner mates from the state within bound plies against any defence */
+	bool MatesWithin(const GameState& state, int bound, Color winner);
+
+	/* Extend the proof tree below node. False at the node limit */
+	bool ExpandProof(const GameState& state, ProofTreeNode& node, size_t& nodeCount);
+
+	static GameState GetSuccessor(const GameState& state, const Move& move);
+
+	static void PrintProofNode(std::ostream& os, const ProofTreeNode& node, int depth);
+
+	const BasicEvaluationTree<Size>& m_tree;
+	LineExtractorConfig m_config;
+
+	std::unordered_map<uint64_t, Bounds> m_bounds;
+};
@@ -0,0 +1,265 @@
+#include "LoadGenerator.h"
+#include <algorithm>
+#include <chrono>
+#include <random>
+#include <thread>
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <time.h>
+#endif
+
+namespace
+{
+	/* Requests starting later than this after their scheduled time count as late */
+	constexpr std::chrono::microseconds LATE_THRESHOLD(100);
+
+	/* Sleeping is imprecise, the last part of the wait before a request is spent yielding */
+	constexpr std::chrono::microseconds SPIN_WAIT(100);
+}
+
+void LatencyHistogram::Record(uint64_t nanoseconds)
+{
+	m_counts[GetBucket(nanoseconds)]++;
+	m_count++;
+	m_max = std::max(m_max, nanoseconds);
+}
+
+void LatencyHistogram::Add(const LatencyHistogram& other)
+{
+	for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+	{
+		m_counts[bucket] += other.m_counts[bucket];
+	}
+	m_count += other.m_count;
+	m_max = std::max(m_max, other.m_max);
+}
+
+uint64_t LatencyHistogram::GetPercentile(double p) const
+{
+	if (m_count == 0)
+	{
+		return 0;
+	}
+
+	/* Rank of the request, counted from 1 */
+	uint64_t rank = std::max<uint64_t>(1, static_cast<uint64_t>(p * static_cast<double>(m_count) + 0.5));
+	uint64_t seen = 0;
+	for (int bucket = 0; bucket < BUCKET_COUNT; bucket++)
+	{
+		seen += m_counts[bucket];
+		if (seen >= rank)
+		{
+			return std::min(GetBucketEnd(bucket), m_max);
+		}
+	}
+	return m_max;
+}
+
+int LatencyHistogram::GetBucket(uint64_t nanoseconds)
+{
+	/* Small values exactly, larger ones by their top SUB_BUCKET_BITS + 1 bits */
+	if (nanoseconds < (1ull << SUB_BUCKET_BITS))
+	{
+		return static_cast<int>(nanoseconds);
+	}
+
+	int shift = 0;
+	while ((nanoseconds >> shift) >= (2ull << SUB_BUCKET_BITS))
+	{
+		shift++;
+	}
+	int subBucket = static_cast<int>(nanoseconds >> shift) - (1 << SUB_BUCKET_BITS);
+	return ((shift + 1) << SUB_BUCKET_BITS) + subBucket;
+}
+
+uint64_t LatencyHistogram::GetBucketEnd(int bucket)
+{
+	int group = bucket >> SUB_BUCKET_BITS;
+	uint64_t subBucket = bucket & ((1 << SUB_BUCKET_BITS) - 1);
+	if (group == 0)
+	{
+		return subBucket;
+	}
+
+	int shift = group - 1;
+	return (((1ull << SUB_BUCKET_BITS) + subBucket + 1) << shift) - 1;
+}
+
+LoadGenerator::LoadGenerator(const EvaluationTree& eval, const LoadGeneratorConfig& config) : m_eval(eval), m_config(config)
+{
+	std::mt19937_64 rng(m_config.seed);
+
+	GameState start;
+	start.FinalizeGameState();
+
+	/* Random walks of random length. A move ending the game is not made, so every position has moves to annotate */
+	m_corpus.reserve(std::max(m_config.corpusSize, 1));
+	for (int position = 0; position < std::max(m_config.corpusSize, 1); position++)
+	{
+		GameState state = start;
+		int plies = static_cast<int>(rng() % (m_config.walkPlies + 1));
+		for (int ply = 0; ply < plies; ply++)
+		{
+			const std::vector<Move>& moves = state.GetMoves();
+			GameState successor = state;
+			successor.MakeMove(moves[rng() % moves.size()]);
+			successor.FinalizeGameState();
+			if (successor.IsGameOver())
+			{
+				break;
+			}
+			state = successor;
+		}
+		m_corpus.push_back(state);
+	}
+}
+
+LoadGeneratorResult LoadGenerator::Run()
+{
+	int threadCount = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+
+	/* Every worker has its own result, merged at the end. No shared state while sending */
+	std::vector<LoadGeneratorResult> results(threadCount);
+	std::vector<std::thread> workers;
+
+	double cpuStart = GetProcessCpuSeconds();
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&LoadGenerator::RunWorker, this, i, threadCount, std::ref(results[i]));
+	}
+
+	LoadGeneratorResult total;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers[i].join();
+		total.latencies.Add(results[i].latencies);
+		total.unknown += results[i].unknown;
+		total.late += results[i].late;
+	}
+
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	total.cpuSeconds = GetProcessCpuSeconds() - cpuStart;
+	return total;
+}
+
+void LoadGenerator::WriteCorpus(std::ostream& os) const
+{
+	for (const GameState& state : m_corpus)
+	{
+		os << state.GetBoard() << (state.GetNextPlayer() == Color::White ? " w " : " b ") << state.GetRepetitionCount() << '\n';
+	}
+}
+
+void LoadGenerator::PrintResult(const LoadGeneratorResult& result, std::ostream& os)
+{
+	double seconds = result.seconds > 0.0 ? result.seconds : 1e-9;
+	uint64_t requests = result.latencies.GetCount();
+
+	os << "Requests: " << requests << " in " << result.seconds << " s" << std::endl;
+	os << "Requests/s: " << requests / seconds << std::endl;
+	os << "Latency p50: " << result.latencies.GetPercentile(0.5) << " ns, p99: " << result.latencies.GetPercentile(0.99)
+		<< " ns, p999: " << result.latencies.GetPercentile(0.999) << " ns, max: " << result.latencies.GetMax() << " ns" << std::endl;
+	os << "CPU time: " << result.cpuSeconds << " s, " << (requests > 0 ? 1e9 * result.cpuSeconds / requests : 0.0) << " ns per request" << std::endl;
+	os << "Unknown: " << result.unknown << std::endl;
+	os << "Late: " << result.late << std::endl;
+}
+
+void LoadGenerator::RunWorker(int worker, int threadCount, LoadGeneratorResult& result) const
+{
+	using Clock = std::chrono::steady_clock;
+
+	/* Each thread sends every threadCount-th request of the total schedule, interleaved with the others */
+	bool bPaced = m_config.rate > 0.0;
+	Clock::duration interval = bPaced
+		? std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(threadCount / m_config.rate))
+		: Clock::duration::zero();
+
+	Clock::time_point start = Clock::now();
+	Clock::time_point end = start + std::chrono::duration_cast<Clock::duration>(std::chrono::duration<double>(m_config.seconds));
+	Clock::time_point scheduled = start + interval * worker / threadCount;
+
+	size_t corpusSize = m_corpus.size();
+	size_t position = worker % corpusSize;
+
+	while (scheduled < end)
+	{
+		Clock::time_point now = Clock::now();
+		if (bPaced && now < scheduled)
+		{
+			if (scheduled - now > SPIN_WAIT)
+			{
+				std::this_thread::sleep_until(scheduled - SPIN_WAIT);
+			}
+			while ((now = Clock::now()) < scheduled)
+			{
+				std::this_thread::yield();
+			}
+		}
+		else if (!bPaced)
+		{
+			scheduled = now;
+		}
+
+		if (now - scheduled > LATE_THRESHOLD)
+		{
+			result.late++;
+		}
+
+		if (!Request(m_corpus[position]))
+		{
+			result.unknown++;
+		}
+
+		/* From the scheduled time, so waiting for an earlier slow request counts too */
+		result.latencies.Record(static_cast<uint64_t>(std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - scheduled).count()));
+
+		position = (position + threadCount) % corpusSize;
+		scheduled = bPaced ? scheduled + interval : Clock::now();
+	}
+}
+
+bool LoadGenerator::Request(const GameState& state) const
+{
+	if (m_config.operation == LoadOperation::Probe)
+	{
+		return m_eval.GetGameStateEvaluation(state) != -2;
+	}
+
+	bool bKnown = true;
+	for (size_t moveNumber = 0; moveNumber < state.GetMoves().size(); moveNumber++)
+	{
+		bKnown &= m_eval.GetMoveEvaluation(state, moveNumber) != -2;
+	}
+	return bKnown;
+}
+
+double LoadGenerator::GetProcessCpuSeconds()
+{
+#if defined(_WIN32)
+	FILETIME creation, exit, kernel, user;
+	if (!GetProcessTimes(GetCurrentProcess(), &creation, &exit, &kernel, &user))
+	{
+		return 0.0;
+	}
+
+	/* 100 ns units */
+	auto toSeconds = [](const FILETIME& time) { return ((static_cast<uint64_t>(time.dwHighDateTime) << 32) | time.dwLowDateTime) * 1e-7; };
+	return toSeconds(kernel) + toSeconds(user);
+#else
+	timespec time;
+	if (clock_gettime(CLOCK_PROCESS_CPUTIME_ID, &time) != 0)
+	{
+		return 0.0;
+	}
+	return time.tv_sec + time.tv_nsec * 1e-9;
+#endif
+}
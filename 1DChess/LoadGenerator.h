@@ -0,0 +1,107 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <vector>
+#include "EvaluationTree.h"
+
+/* What one request does */
+enum class LoadOperation
+{
+	/* GetGameStateEvaluation of the position */
+	Probe,
+	/* GetMoveEvaluation of every move, like the move annotation of the interactive game */
+	Annotate
+};
+
+struct LoadGeneratorConfig
+{
+	/* 0 = one per hardware thread */
+	int threads = 0;
+
+	/* Requests per second over all threads, 0 = as fast as possible (every thread sends the next request when the last is answered) */
+	double rate = 0.0;
+
+	double seconds = 5.0;
+
+	LoadOperation operation = LoadOperation::Probe;
+
+	/* Positions of the corpus: Random walks from the starting position of up to walkPlies plies, the same for the same seed */
+	int corpusSize = 100000;
+	int walkPlies = 40;
+	unsigned int seed = 1;
+};
+
+/* Latencies in buckets of about 3 % width, so any number of requests takes the same memory */
+class LatencyHistogram
+{
+public:
+	LatencyHistogram() : m_counts(BUCKET_COUNT, 0) {}
+
+	void Record(uint64_t nanoseconds);
+	void Add(const LatencyHistogram& other);
+
+	/* Latency below which the share p (0..1) of all requests lies, upper bound of its bucket */
+	uint64_t GetPercentile(double p) const;
+
+	uint64_t GetCount() const { return m_count; }
+	uint64_t GetMax() const { return m_max; }
+
+private:
+	/* 32 buckets per power of two */
+	static constexpr int SUB_BUCKET_BITS = 5;
+	static constexpr int BUCKET_COUNT = (64 - SUB_BUCKET_BITS + 1) << SUB_BUCKET_BITS;
+
+	static int GetBucket(uint64_t nanoseconds);
+	static uint64_t GetBucketEnd(int bucket);
+
+	std::vector<uint64_t> m_counts;
+	uint64_t m_count = 0;
+	uint64_t m_max = 0;
+};
+
+struct LoadGeneratorResult
+{
+	LatencyHistogram latencies;
+
+	/* Requests answered with an unknown value */
+	uint64_t unknown = 0;
+
+	/* Requests started later than scheduled, the generator could not keep the rate */
+	uint64_t late = 0;
+
+	double seconds = 0.0;
+
+	/* CPU time of the whole process during the run, all threads */
+	double cpuSeconds = 0.0;
+};
+
+/* Sends requests to a solved tree from several threads and measures their latency.
+ * With a rate the requests of each thread follow a fixed schedule, and latency counts from the scheduled time,
+ * so a stalled request also delays the ones queued behind it (no coordinated omission) */
+class LoadGenerator
+{
+public:
+	LoadGenerator(const EvaluationTree& eval, const LoadGeneratorConfig& config);
+
+	/* Run for the configured time on all threads */
+	LoadGeneratorResult Run();
+
+	/* Corpus in the input notation of BatchEvaluator, one position per line */
+	void WriteCorpus(std::ostream& os) const;
+
+	/* Latency percentiles, throughput and CPU time */
+	static void PrintResult(const LoadGeneratorResult& result, std::ostream& os);
+
+private:
+	void RunWorker(int worker, int threadCount, LoadGeneratorResult& result) const;
+
+	/* One request, false if the answer was unknown */
+	bool Request(const GameState& state) const;
+
+	static double GetProcessCpuSeconds();
+
+	const EvaluationTree& m_eval;
+	LoadGeneratorConfig m_config;
+
+	std::vector<GameState> m_corpus;
+};
@@ -0,0 +1,105 @@
+#include "MappedFile.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <windows.h>
+#else
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+MappedFile::~MappedFile()
+{
+	Close();
+}
+
+bool MappedFile::Open(const std::string& path)
+{
+	Close();
+
+#if defined(_WIN32)
+	HANDLE file = CreateFileA(path.c_str(), GENERIC_READ, FILE_SHARE_READ, nullptr, OPEN_EXISTING, FILE_ATTRIBUTE_NORMAL, nullptr);
+	if (file == INVALID_HANDLE_VALUE)
+	{
+		return false;
+	}
+	m_file = file;
+
+	LARGE_INTEGER fileSize;
+	if (!GetFileSizeEx(file, &fileSize) || fileSize.QuadPart == 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_mapping = CreateFileMappingA(file, nullptr, PAGE_READONLY, 0, 0, nullptr);
+	if (m_mapping == nullptr)
+	{
+		Close();
+		return false;
+	}
+
+	m_data = static_cast<const unsigned char*>(MapViewOfFile(m_mapping, FILE_MAP_READ, 0, 0, 0));
+	m_size = static_cast<size_t>(fileSize.QuadPart);
+#else
+	int file = open(path.c_str(), O_RDONLY);
+	if (file < 0)
+	{
+		return false;
+	}
+
+	struct stat fileStat;
+	void* data = MAP_FAILED;
+	if (fstat(file, &fileStat) == 0 && fileStat.st_size > 0)
+	{
+		data = mmap(nullptr, static_cast<size_t>(fileStat.st_size), PROT_READ, MAP_SHARED, file, 0);
+	}
+
+	/* The mapping stays valid without the descriptor */
+	close(file);
+
+	if (data == MAP_FAILED)
+	{
+		return false;
+	}
+	m_data = static_cast<const unsigned char*>(data);
+	m_size = static_cast<size_t>(fileStat.st_size);
+#endif
+
+	if (m_data == nullptr)
+	{
+		Close();
+		return false;
+	}
+	return true;
+}
+
+void MappedFile::Close()
+{
+#if defined(_WIN32)
+	if (m_data != nullptr)
+	{
+		UnmapViewOfFile(m_data);
+	}
+	if (m_mapping != nullptr)
+	{
+		CloseHandle(m_mapping);
+	}
+	if (m_file != nullptr)
+	{
+		CloseHandle(m_file);
+	}
+	m_mapping = nullptr;
+	m_file = nullptr;
+#else
+	if (m_data != nullptr)
+	{
+		munmap(const_cast<unsigned char*>(m_data), m_size);
+	}
+#endif
+
+	m_data = nullptr;
+	m_size = 0;
+}
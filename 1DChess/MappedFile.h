@@ -0,0 +1,31 @@
+#pragma once
+#include <cstddef>
+#include <string>
+
+/* File mapped read-only into memory. Pages are read on first access and shared with every other process mapping the file */
+class MappedFile
+{
+public:
+	MappedFile() = default;
+	~MappedFile();
+
+	MappedFile(const MappedFile&) = delete;
+	MappedFile& operator=(const MappedFile&) = delete;
+
+	/* False if the file doesn't exist, is empty or can't be mapped */
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return m_data != nullptr; }
+	const unsigned char* GetData() const { return m_data; }
+	size_t GetSize() const { return m_size; }
+
+private:
+	const unsigned char* m_data = nullptr;
+	size_t m_size = 0;
+
+#if defined(_WIN32)
+	void* m_file = nullptr;
+	void* m_mapping = nullptr;
+#endif
+};
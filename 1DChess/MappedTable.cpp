@@ -0,0 +1,55 @@
+#include "MappedTable.h"
+#include <cstring>
+
+bool MappedTable::Open(const std::string& path)
+{
+	Close();
+	if (!m_file.Open(path))
+	{
+		return false;
+	}
+
+	const unsigned char* data = m_file.GetData();
+	size_t size = m_file.GetSize();
+
+	/* Fixed part of the header, then the setup, then the count */
+	uint32_t version = 0;
+	uint32_t setupLength = 0;
+	size_t prefix = sizeof(TABLE_MAGIC) + sizeof(version) + sizeof(setupLength);
+	if (size < prefix || std::memcmp(data, TABLE_MAGIC, sizeof(TABLE_MAGIC)) != 0)
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&version, data + sizeof(TABLE_MAGIC), sizeof(version));
+	std::memcpy(&setupLength, data + sizeof(TABLE_MAGIC) + sizeof(version), sizeof(setupLength));
+
+	uint64_t positionCount = 0;
+	size_t headerSize = prefix + setupLength + sizeof(positionCount);
+	if (version != TABLE_VERSION || setupLength > 64 || size < headerSize)
+	{
+		Close();
+		return false;
+	}
+	std::memcpy(&positionCount, data + prefix + setupLength, sizeof(positionCount));
+
+	/* The entries have to fill the rest of the file exactly, which also bounds the count by the address space */
+	if (positionCount == 0 || positionCount > INT64_MAX || (positionCount + 3) / 4 != size - headerSize)
+	{
+		Close();
+		return false;
+	}
+
+	m_setup.assign(reinterpret_cast<const char*>(data + prefix), setupLength);
+	m_positionCount = static_cast<int64_t>(positionCount);
+	m_entries = data + headerSize;
+	return true;
+}
+
+void MappedTable::Close()
+{
+	m_file.Close();
+	m_setup.clear();
+	m_positionCount = 0;
+	m_entries = nullptr;
+}
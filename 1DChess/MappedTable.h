@@ -0,0 +1,48 @@
+#pragma once
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include "MappedFile.h"
+
+/* Table file header, see BasicEvaluationTree::SaveTable: Magic, version, setup length (the board size), setup,
+ * number of positions (64 bit) */
+constexpr char TABLE_MAGIC[4] = { '1', 'D', 'C', 'T' };
+constexpr uint32_t TABLE_VERSION = 2;
+
+/* Table file mapped read-only into memory. The packed entries are used in place, nothing is copied.
+ * The board size is read from the header, so one class serves every size. Position indices are 64 bit like in PositionLayout */
+class MappedTable
+{
+public:
+	/* Map a table file and check its header. False if the file can't be mapped or is no complete table */
+	bool Open(const std::string& path);
+	void Close();
+
+	bool IsOpen() const { return m_entries != nullptr; }
+
+	/* Setup in stream notation, its length is the board size. Copied from the header, so it is 0 terminated */
+	const std::string& GetSetup() const { return m_setup; }
+	int64_t GetPositionCount() const { return m_positionCount; }
+
+	/* Packed entries, 4 per byte with position index % 4 * 2 as bit offset (see CachedEvaluation of EvaluationTree) */
+	const unsigned char* GetEntries() const { return m_entries; }
+	size_t GetEntryBytes() const { return (static_cast<size_t>(m_positionCount) + 3) / 4; }
+
+	/* Entry 0..3 of a position index, 0 (unknown) outside of the table */
+	int GetEntry(int64_t positionIndex) const
+	{
+		if (positionIndex < 0 || positionIndex >= m_positionCount)
+		{
+			return 0;
+		}
+		return (m_entries[positionIndex / 4] >> (positionIndex % 4 * 2)) & 0b11;
+	}
+
+private:
+	MappedFile m_file;
+
+	std::string m_setup;
+	int64_t m_positionCount = 0;
+	const unsigned char* m_entries = nullptr;
+};
@@ -0,0 +1,409 @@
+#include "PartitionedSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <sstream>
+#include <thread>
+#include "EvaluationTree.h"
+#include "PositionIterator.h"
+#include "Prefetch.h"
+
+template<int Size>
+PartitionedSolver<Size>::PartitionedSolver(const Board& setup, const PartitionConfig& config) : m_setup(setup), m_config(config)
+{
+	std::ostringstream setupText;
+	setupText << setup;
+	m_layout = PositionLayout<Size>::FromSetup(setupText.str());
+}
+
+template<int Size>
+bool PartitionedSolver<Size>::RunWorker()
+{
+	if (!IsValidSetup() || m_config.part < 0 || m_config.part >= m_config.parts)
+	{
+		return false;
+	}
+
+	m_begin = GetSliceBegin(m_config.part);
+	m_end = GetSliceBegin(m_config.part + 1);
+	m_slice.assign(static_cast<size_t>((m_end - m_begin + 3) / 4), 0);
+
+	GameState state;
+	std::vector<int64_t> successors;
+
+	/* Mates and draws by rule, and the successors other processes own */
+	int64_t open = 0;
+	for (PositionIterator<Size> position(m_layout, m_begin, m_end); position.Next();)
+	{
+		GameState& initialState = position.GetState();
+		if (position.GetRepetitionCount() != 1)
+		{
+			continue;
+		}
+
+		initialState.FinalizeGameState();
+		if (!Rules::GetSuccessors(m_layout, initialState, successors))
+		{
+			continue;
+		}
+
+		int entry = Rules::GetTerminalEntry(initialState);
+		if (entry != Rules::ENTRY_UNKNOWN)
+		{
+			SetValue(position.GetIndex(), entry);
+			continue;
+		}
+
+		open++;
+		for (int64_t successor : successors)
+		{
+			if (successor < m_begin || successor >= m_end)
+			{
+				m_boundary.push_back(successor);
+			}
+		}
+	}
+
+	std::sort(m_boundary.begin(), m_boundary.end());
+	m_boundary.erase(std::unique(m_boundary.begin(), m_boundary.end()), m_boundary.end());
+	m_boundaryEntries.assign(m_boundary.size(), Rules::ENTRY_UNKNOWN);
+
+	int64_t resolved = 0;
+	if (!ExchangeRequests() || !ExchangeValues(0, open, resolved))
+	{
+		return false;
+	}
+
+	/* Until no process resolves anything. Everyone sees the same sums, so all stop after the same pass */
+	int pass = 0;
+	do
+	{
+		pass++;
+
+		int64_t ownResolved = 0;
+		for (int64_t index = m_begin; index < m_end && open > 0; index++)
+		{
+			if (GetEntry(index) != Rules::ENTRY_UNKNOWN || !Rules::DecodePosition(m_layout, index, state, successors))
+			{
+				continue;
+			}
+			for (int64_t successor : successors)
+			{
+				if (successor >= m_begin && successor < m_end)
+				{
+					PrefetchRead(&m_slice[static_cast<size_t>((successor - m_begin) / 4)]);
+				}
+			}
+
+			int entry = Rules::Resolve(state.GetNextPlayer(), successors, [this](int64_t successor) { return GetEntry(successor); });
+			if (entry != Rules::ENTRY_UNKNOWN)
+			{
+				SetValue(index, entry);
+				open--;
+				ownResolved++;
+			}
+		}
+
+		if (!ExchangeValues(pass, ownResolved, resolved))
+		{
+			return false;
+		}
+		resolved += ownResolved;
+
+		/* Everyone has sent this pass, so nobody reads the previous one anymore */
+		for (int target = 0; target < m_config.parts; target++)
+		{
+			std::remove(GetPassMessagePath(m_config.part, target, pass - 1).c_str());
+		}
+
+		if (m_config.bVerbose)
+		{
+			std::cout << "Part " << m_config.part << ", pass " << pass << ": " << resolved << " positions resolved" << std::endl;
+		}
+	} while (resolved > 0);
+
+	/* Remaining open positions are draws */
+	for (int64_t index = m_begin; index < m_end && open > 0; index++)
+	{
+		if (GetEntry(index) == Rules::ENTRY_UNKNOWN && Rules::DecodePosition(m_layout, index, state, successors))
+		{
+			SetValue(index, Rules::ENTRY_DRAW);
+		}
+	}
+
+	/* The final message carries the last pass, so the merge can remove its files */
+	return PublishMessage(GetMessagePath(m_config.part, "final"), pass, m_slice.data(), m_slice.size());
+}
+
+template<int Size>
+int PartitionedSolver<Size>::MergeTable(std::ostream& os)
+{
+	if (!IsValidSetup() || !BasicEvaluationTree<Size>::WriteTableHeader(os, m_setup, m_layout.GetCount()))
+	{
+		return -2;
+	}
+
+	/* Slices are written as they come, only the entry of the setup is kept */
+	int64_t rootIndex = m_layout.Get(m_setup, Color::White, 1);
+	int rootEntry = Rules::ENTRY_UNKNOWN;
+
+	std::vector<unsigned char> slice;
+	for (int part = 0; part < m_config.parts; part++)
+	{
+		int64_t lastPass = 0;
+		std::string path = GetMessagePath(part, "final");
+		int64_t begin = GetSliceBegin(part);
+		int64_t end = GetSliceBegin(part + 1);
+		if (!ReadMessage(path, lastPass, slice) || static_cast<int64_t>(slice.size()) != (end - begin + 3) / 4)
+		{
+			return -2;
+		}
+
+		os.write(reinterpret_cast<const char*>(slice.data()), slice.size());
+		if (rootIndex >= begin && rootIndex < end)
+		{
+			rootEntry = (slice[static_cast<size_t>((rootIndex - begin) / 4)] >> ((rootIndex - begin) % 4 * 2)) & 0b11;
+		}
+
+		std::remove(path.c_str());
+		for (int target = 0; target < m_config.parts; target++)
+		{
+			std::remove(GetPassMessagePath(part, target, static_cast<int>(lastPass)).c_str());
+		}
+	}
+
+	if (!os)
+	{
+		return -2;
+	}
+
+	switch (rootEntry)
+	{
+	case Rules::ENTRY_WHITE_WINS:
+		return 1;
+	case Rules::ENTRY_BLACK_WINS:
+		return -1;
+	case Rules::ENTRY_DRAW:
+		return 0;
+	default:
+		return -2;
+	}
+}
+
+template<int Size>
+int64_t PartitionedSolver<Size>::GetSliceBegin(int part) const
+{
+	int64_t bytes = (m_layout.GetCount() + 3) / 4 * part / m_config.parts;
+	return std::min(bytes * 4, m_layout.GetCount());
+}
+
+template<int Size>
+std::string PartitionedSolver<Size>::GetMessagePath(int part, const std::string& name) const
+{
+	return m_config.directory + "/run" + m_config.runId + ".part" + std::to_string(part) + "." + name;
+}
+
+template<int Size>
+std::string PartitionedSolver<Size>::GetPassMessagePath(int part, int target, int pass) const
+{
+	return GetMessagePath(part, "to" + std::to_string(target) + ".pass" + std::to_string(pass));
+}
+
+template<int Size>
+bool PartitionedSolver<Size>::ExchangeRequests()
+{
+	m_requests.assign(m_config.parts, std::vector<int64_t>());
+
+	for (int target = 0; target < m_config.parts; target++)
+	{
+		if (target == m_config.part)
+		{
+			continue;
+		}
+
+		/* The boundary is sorted, so the indices of a slice are a range of it */
+		auto first = std::lower_bound(m_boundary.begin(), m_boundary.end(), GetSliceBegin(target));
+		auto last = std::lower_bound(first, m_boundary.end(), GetSliceBegin(target + 1));
+		std::string path = GetMessagePath(m_config.part, "to" + std::to_string(target) + ".needs");
+		if (!PublishMessage(path, 0, first == last ? nullptr : &*first, (last - first) * sizeof(int64_t)))
+		{
+			return false;
+		}
+	}
+
+	std::vector<unsigned char> data;
+	for (int part = 0; part < m_config.parts; part++)
+	{
+		if (part == m_config.part)
+		{
+			continue;
+		}
+
+		int64_t header = 0;
+		std::string path = GetMessagePath(part, "to" + std::to_string(m_config.part) + ".needs");
+		if (!ReadMessage(path, header, data))
+		{
+			return false;
+		}
+
+		/* Nobody else reads it */
+		std::remove(path.c_str());
+		m_requests[part].resize(data.size() / sizeof(int64_t));
+		std::memcpy(m_requests[part].data(), data.data(), m_requests[part].size() * sizeof(int64_t));
+	}
+
+	return true;
+}
+
+template<int Size>
+bool PartitionedSolver<Size>::ExchangeValues(int pass, int64_t ownResolved, int64_t& resolved)
+{
+	/* Index * 4 + entry */
+	std::vector<uint64_t> values;
+	for (int target = 0; target < m_config.parts; target++)
+	{
+		if (target == m_config.part)
+		{
+			continue;
+		}
+
+		values.clear();
+		for (int64_t index : m_decided)
+		{
+			if (std::binary_search(m_requests[target].begin(), m_requests[target].end(), index))
+			{
+				values.push_back(static_cast<uint64_t>(index) * 4 + static_cast<uint64_t>(GetEntry(index)));
+			}
+		}
+
+		if (!PublishMessage(GetPassMessagePath(m_config.part, target, pass), ownResolved, values.data(), values.size() * sizeof(uint64_t)))
+		{
+			return false;
+		}
+	}
+	m_decided.clear();
+
+	resolved = 0;
+	std::vector<unsigned char> data;
+	for (int part = 0; part < m_config.parts; part++)
+	{
+		if (part == m_config.part)
+		{
+			continue;
+		}
+
+		int64_t partResolved = 0;
+		if (!ReadMessage(GetPassMessagePath(part, m_config.part, pass), partResolved, data))
+		{
+			return false;
+		}
+
+		for (size_t offset = 0; offset + sizeof(uint64_t) <= data.size(); offset += sizeof(uint64_t))
+		{
+			uint64_t value;
+			std::memcpy(&value, data.data() + offset, sizeof(value));
+			auto boundary = std::lower_bound(m_boundary.begin(), m_boundary.end(), static_cast<int64_t>(value / 4));
+			if (boundary != m_boundary.end() && *boundary == static_cast<int64_t>(value / 4))
+			{
+				m_boundaryEntries[boundary - m_boundary.begin()] = static_cast<unsigned char>(value % 4);
+			}
+		}
+		resolved += partResolved;
+	}
+
+	return true;
+}
+
+template<int Size>
+bool PartitionedSolver<Size>::PublishMessage(const std::string& path, int64_t header, const void* data, size_t bytes) const
+{
+	std::string temporaryPath = path + ".tmp";
+
+	{
+		std::ofstream file(temporaryPath, std::ios::binary | std::ios::trunc);
+		file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+		file.write(reinterpret_cast<const char*>(data), bytes);
+		if (!file)
+		{
+			return false;
+		}
+	}
+
+	return std::rename(temporaryPath.c_str(), path.c_str()) == 0;
+}
+
+template<int Size>
+bool PartitionedSolver<Size>::ReadMessage(const std::string& path, int64_t& header, std::vector<unsigned char>& data) const
+{
+	auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(m_config.timeoutSeconds);
+
+	std::ifstream file;
+	while (true)
+	{
+		file.open(path, std::ios::binary | std::ios::ate);
+		if (file)
+		{
+			break;
+		}
+
+		if (std::chrono::steady_clock::now() > deadline)
+		{
+			std::cerr << "Timeout waiting for " << path << std::endl;
+			return false;
+		}
+
+		file.clear();
+		std::this_thread::sleep_for(std::chrono::milliseconds(5));
+	}
+
+	std::streamoff size = file.tellg();
+	if (size < static_cast<std::streamoff>(sizeof(header)))
+	{
+		return false;
+	}
+	file.seekg(0);
+	data.resize(static_cast<size_t>(size) - sizeof(header));
+
+	file.read(reinterpret_cast<char*>(&header), sizeof(header));
+	file.read(reinterpret_cast<char*>(data.data()), data.size());
+
+	return static_cast<bool>(file);
+}
+
+template<int Size>
+int PartitionedSolver<Size>::GetEntry(int64_t index) const
+{
+	if (index >= m_begin && index < m_end)
+	{
+		int64_t offset = index - m_begin;
+		return (m_slice[static_cast<size_t>(offset / 4)] >> (offset % 4 * 2)) & 0b11;
+	}
+
+	auto boundary = std::lower_bound(m_boundary.begin(), m_boundary.end(), index);
+	return boundary != m_boundary.end() && *boundary == index ? m_boundaryEntries[boundary - m_boundary.begin()] : Rules::ENTRY_UNKNOWN;
+}
+
+template<int Size>
+void PartitionedSolver<Size>::SetValue(int64_t index, int value)
+{
+	for (int64_t target : { index, Rules::GetSecondRepetition(m_layout, index) })
+	{
+		int64_t offset = target - m_begin;
+		unsigned char& cacheByte = m_slice[static_cast<size_t>(offset / 4)];
+		cacheByte &= ~(0b11 << (offset % 4 * 2));
+		cacheByte |= value << (offset % 4 * 2);
+	}
+
+	/* Draws decide no other position, they aren't sent */
+	if (value != Rules::ENTRY_DRAW)
+	{
+		m_decided.push_back(index);
+	}
+}
+
+/* Supported board sizes */
+template class PartitionedSolver<8>;
+template class PartitionedSolver<10>;
+template class PartitionedSolver<12>;
@@ -0,0 +1,102 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "Game.h"
+#include "PositionLayout.h"
+#include "Retrograde.h"
+
+struct PartitionConfig
+{
+	/* Directory shared by all processes for the message files */
+	std::string directory = ".";
+
+	/* Number of processes and the one of this process */
+	int parts = 2;
+	int part = 0;
+
+	/* Names the message files, so runs in the same directory don't mix */
+	std::string runId = "0";
+
+	/* Give up waiting for the other processes after this long */
+	int timeoutSeconds = 600;
+
+	bool bVerbose = false;
+};
+
+/* Retrograde solve split across processes. Each process owns a slice of the index range, holds only that slice in memory
+ * and resolves only positions of it. Successors in other slices are boundary values, exchanged through message files:
+ * - After the first pass a process asks every other one for the values it needs from its slice (part<p>.to<q>.needs)
+ * - After every pass a process sends every other one the requested values decided in that pass, with the number of
+ *   positions it resolved (part<p>.to<q>.pass<n>)
+ * The solve ends after the first pass in which no process resolved anything, then every process publishes its final
+ * slice and MergeTable writes the slices one after another as table file, nobody holds the whole table.
+ * Message files are written under a temporary name and renamed, so a file that exists is complete */
+template<int Size>
+class PartitionedSolver
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	PartitionedSolver(const Board& setup, const PartitionConfig& config);
+
+	/* If the setup can be indexed at all (one king per color) */
+	bool IsValidSetup() const { return m_layout.IsValid(); }
+
+	/* Solve the slice of this process. False on I/O errors or if another process doesn't answer in time */
+	bool RunWorker();
+
+	/* Write the final slices of all processes as table file in the format of EvaluationTree::SaveTable and
+	 * remove them. Returns the value of the setup with white to move, -2 if a slice is missing */
+	int MergeTable(std::ostream& os);
+
+private:
+	using Rules = Retrograde<Size>;
+
+	/* First index of a slice, slices are whole bytes of the table */
+	int64_t GetSliceBegin(int part) const;
+
+	/* Message file of a process, e.g. "to1.pass3" or "final" */
+	std::string GetMessagePath(int part, const std::string& name) const;
+	std::string GetPassMessagePath(int part, int target, int pass) const;
+
+	/* Ask the owners for the boundary values and take the requests of the others */
+	bool ExchangeRequests();
+
+	/* Send the requested values decided since the last exchange with the number of resolved positions,
+	 * take the values sent by the others and sum up their resolved positions */
+	bool ExchangeValues(int pass, int64_t ownResolved, int64_t& resolved);
+
+	/* Message file: A header word followed by data */
+	bool PublishMessage(const std::string& path, int64_t header, const void* data, size_t bytes) const;
+
+	/* Wait for a message file and read it completely */
+	bool ReadMessage(const std::string& path, int64_t& header, std::vector<unsigned char>& data) const;
+
+	/* Entry of an index of the own slice or the boundary, ENTRY_UNKNOWN for others */
+	int GetEntry(int64_t index) const;
+
+	/* Value for both repetition indices of an index of the own slice */
+	void SetValue(int64_t index, int value);
+
+	Board m_setup;
+	PositionLayout<Size> m_layout;
+	PartitionConfig m_config;
+
+	/* Own slice [m_begin, m_end), 4 positions per byte */
+	int64_t m_begin = 0;
+	int64_t m_end = 0;
+	std::vector<unsigned char> m_slice;
+
+	/* Successors of open positions in other slices, sorted, and their entries as far as received */
+	std::vector<int64_t> m_boundary;
+	std::vector<unsigned char> m_boundaryEntries;
+
+	/* Per process the indices of the own slice it requested, sorted */
+	std::vector<std::vector<int64_t>> m_requests;
+
+	/* Own positions won or lost since the last exchange, ascending */
+	std::vector<int64_t> m_decided;
+};
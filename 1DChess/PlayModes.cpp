@@ -0,0 +1,162 @@
+#include "PlayModes.h"
+#include <fstream>
+#include <iostream>
+#include <string_view>
+#include "BatchEvaluator.h"
+#include "CommandLine.h"
+#include "LoadGenerator.h"
+#include "RulesFuzzer.h"
+#include "SelfPlay.h"
+
+namespace
+{
+	/* Play policy of a "key=perfect|random|mixed" argument */
+	PlayPolicy getPolicyOption(int argc, char* argv[], std::string_view key, PlayPolicy defaultValue)
+	{
+		const char* value = findOption(argc, argv, key);
+		if (value == nullptr)
+		{
+			return defaultValue;
+		}
+
+		std::string_view name(value);
+		if (name == "random")
+		{
+			return PlayPolicy::Random;
+		}
+		else if (name == "mixed")
+		{
+			return PlayPolicy::Mixed;
+		}
+		return PlayPolicy::Perfect;
+	}
+}
+
+int runBatch(const char* path)
+{
+	std::ios::sync_with_stdio(false);
+
+	GameState state;
+	state.FinalizeGameState();
+
+	EvaluationTree eval;
+	eval.SetVerbose(false);
+	eval.Evaluate(state);
+
+	BatchEvaluator batch(eval);
+	if (path != nullptr)
+	{
+		std::ifstream file(path, std::ios::binary);
+		if (!file)
+		{
+			std::cerr << "Could not open " << path << std::endl;
+			return 1;
+		}
+		batch.Run(file, std::cout);
+	}
+	else
+	{
+		batch.Run(std::cin, std::cout);
+	}
+
+	return 0;
+}
+
+int runSelfPlay(int argc, char* argv[])
+{
+	SelfPlayConfig config;
+	config.games = getIntOption(argc, argv, "games", config.games);
+	config.threads = getIntOption(argc, argv, "threads", config.threads);
+	config.whitePolicy = getPolicyOption(argc, argv, "white", config.whitePolicy);
+	config.blackPolicy = getPolicyOption(argc, argv, "black", config.blackPolicy);
+	config.randomMoveRate = getDoubleOption(argc, argv, "random", config.randomMoveRate);
+	config.openingPlies = getIntOption(argc, argv, "opening", config.openingPlies);
+	config.maxPlies = getIntOption(argc, argv, "maxplies", config.maxPlies);
+	config.seed = static_cast<unsigned int>(getIntOption(argc, argv, "seed", static_cast<int>(config.seed)));
+
+	GameState state;
+	state.FinalizeGameState();
+
+	EvaluationTree eval;
+	eval.SetVerbose(false);
+	eval.Evaluate(state);
+
+	SelfPlay selfPlay(eval, config);
+	SelfPlay::PrintResult(selfPlay.Run(), std::cout);
+
+	return 0;
+}
+
+int runLoad(int argc, char* argv[])
+{
+	LoadGeneratorConfig config;
+	config.threads = getIntOption(argc, argv, "threads", config.threads);
+	config.rate = getDoubleOption(argc, argv, "rate", config.rate);
+	config.seconds = getDoubleOption(argc, argv, "seconds", config.seconds);
+	config.corpusSize = getIntOption(argc, argv, "corpus", config.corpusSize);
+	config.walkPlies = getIntOption(argc, argv, "plies", config.walkPlies);
+	config.seed = static_cast<unsigned int>(getIntOption(argc, argv, "seed", static_cast<int>(config.seed)));
+
+	const char* operation = findOption(argc, argv, "op");
+	if (operation != nullptr && std::string_view(operation) == "annotate")
+	{
+		config.operation = LoadOperation::Annotate;
+	}
+	bool bBackground = getIntOption(argc, argv, "background", 0) != 0;
+
+	GameState state;
+	state.FinalizeGameState();
+
+	EvaluationTree eval;
+	eval.SetVerbose(false);
+	if (bBackground)
+	{
+		eval.StartEvaluation(state);
+	}
+	else
+	{
+		eval.Evaluate(state);
+	}
+
+	LoadGenerator generator(eval, config);
+
+	/* Same seed, same corpus: Written in batch notation to replay it with --batch */
+	const char* corpusPath = findOption(argc, argv, "out");
+	if (corpusPath != nullptr)
+	{
+		std::ofstream file(corpusPath);
+		if (!file)
+		{
+			std::cerr << "Could not open " << corpusPath << std::endl;
+			return 1;
+		}
+		generator.WriteCorpus(file);
+	}
+
+	LoadGeneratorResult result = generator.Run();
+	if (bBackground)
+	{
+		eval.CancelEvaluation();
+	}
+	LoadGenerator::PrintResult(result, std::cout);
+
+	return 0;
+}
+
+int runFuzz(int argc, char* argv[])
+{
+	RulesFuzzerConfig config;
+	config.iterations = getIntOption(argc, argv, "iterations", config.iterations);
+	config.plies = getIntOption(argc, argv, "plies", config.plies);
+	config.threads = getIntOption(argc, argv, "threads", config.threads);
+	config.seed = static_cast<unsigned int>(getIntOption(argc, argv, "seed", static_cast<int>(config.seed)));
+
+	RulesFuzzer fuzzer(config);
+	RulesFuzzerResult result = fuzzer.Run(std::cout);
+
+	std::cout << "Compared positions: " << result.positions << " in " << result.seconds << " s" << std::endl;
+	std::cout << "Positions/s: " << result.positions / (result.seconds > 0.0 ? result.seconds : 1e-9) << std::endl;
+	std::cout << "Mismatches: " << result.mismatches << std::endl;
+
+	return result.mismatches == 0 ? 0 : 1;
+}
@@ -0,0 +1,15 @@
+#pragma once
+
+/* Modes on the solved standard game: batch probes, self-play, load generation, and the rules fuzzer. Arguments as given to main, options are "key=value" */
+
+/* Batch mode: Solve silently, then answer one position per line from file or stdin */
+int runBatch(const char* path);
+
+/* Self-play mode: Solve silently, then play games in parallel and report throughput */
+int runSelfPlay(int argc, char* argv[]);
+
+/* Load mode: Solve silently (or in the background with background=1), then send probes from many threads and report latency */
+int runLoad(int argc, char* argv[]);
+
+/* Fuzz mode: Compare the rules against the frozen reference. Returns 1 on any mismatch */
+int runFuzz(int argc, char* argv[]);
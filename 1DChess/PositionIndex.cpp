@@ -0,0 +1,303 @@
+#include "PositionIndex.h"
+#include "PositionLayout.h"
+#include <cstring>
+
+#if defined(__AVX2__)
+#include <immintrin.h>
+#define POSITION_INDEX_AVX2
+#elif defined(__SSE2__) || defined(_M_X64) || (defined(_M_IX86_FP) && _M_IX86_FP >= 2)
+#include <emmintrin.h>
+#define POSITION_INDEX_SSE2
+#endif
+
+namespace
+{
+	constexpr int NUM_PIECE_CODES = 7;
+
+	/* The generic layout of the starting setup must be this hand-written one, so caches of both are interchangeable */
+	constexpr bool IsStandardLayout(const PositionLayout<BOARD_SIZE>& layout)
+	{
+		if (!layout.IsValid() || layout.GetElementCount() != PositionIndex::NumElements || layout.GetCount() != PositionIndex::Count)
+		{
+			return false;
+		}
+
+		for (int element = 0; element < PositionIndex::NumElements; element++)
+		{
+			if (layout.GetPossibilities(element) != PositionIndex::Possibilities[element])
+			{
+				return false;
+			}
+		}
+
+		for (int element = 0; element < PositionIndex::Turn; element++)
+		{
+			if (PositionIndex::GetElement(layout.GetPiece(element)) != element)
+			{
+				return false;
+			}
+
+			for (int field = 0; field < BOARD_SIZE; field++)
+			{
+				if (layout.GetFieldIdentifier(element, field) != PositionIndex::GetFieldIdentifier(static_cast<PositionIndex::Element>(element), field))
+				{
+					return false;
+				}
+			}
+		}
+
+		return true;
+	}
+
+	static_assert(IsStandardLayout(PositionLayout<BOARD_SIZE>::FromSetup(STARTING_SETUP)), "Layout of the starting setup differs from PositionIndex");
+
+	/* Precomputed summands for the batch kernel: An index is the base (every non-king taken) plus the contribution of every occupied field */
+	struct FieldTables
+	{
+		int base;
+		int contribution[NUM_PIECE_CODES][BOARD_SIZE];
+		bool unreachable[NUM_PIECE_CODES][BOARD_SIZE];
+	};
+
+	constexpr FieldTables ComputeFieldTables()
+	{
+		FieldTables tables = {};
+
+		for (int element = 0; element < PositionIndex::Turn; element++)
+		{
+			int taken = PositionIndex::GetTakenIdentifier(static_cast<PositionIndex::Element>(element));
+			if (taken >= 0)
+			{
+				tables.base += taken * PositionIndex::Strides[element];
+			}
+		}
+
+		for (int code = 1; code < NUM_PIECE_CODES; code++)
+		{
+			PositionIndex::Element element = PositionIndex::GetElement(static_cast<Piece>(code));
+			int taken = PositionIndex::GetTakenIdentifier(element);
+
+			for (int field = 0; field < BOARD_SIZE; field++)
+			{
+				int identifier = PositionIndex::GetFieldIdentifier(element, field);
+				tables.unreachable[code][field] = identifier < 0;
+				/* Kings are no part of the base, the others replace their "taken" summand */
+				tables.contribution[code][field] = identifier < 0 ? 0 : (identifier - (taken >= 0 ? taken : 0)) * PositionIndex::Strides[element];
+			}
+		}
+
+		return tables;
+	}
+
+	constexpr FieldTables gFieldTables = ComputeFieldTables();
+
+	constexpr int WHITE_KING_CODE = static_cast<int>(Piece::WhiteKing);
+	constexpr int BLACK_KING_CODE = static_cast<int>(Piece::BlackKing);
+
+	/* Number of valid side/repetition bytes, these are the two lowest digits */
+	constexpr int SIDE_REPETITION_COUNT = PositionIndex::Strides[PositionIndex::Turn] * PositionIndex::Possibilities[PositionIndex::Turn];
+
+	/* Scalar version of the kernel, used for the remainder of a batch */
+	int GetPackedIndex(PackedBoard board, unsigned char sideRepetition)
+	{
+		int index = gFieldTables.base + sideRepetition;
+		int counts[NUM_PIECE_CODES] = {};
+		bool bValid = sideRepetition < SIDE_REPETITION_COUNT;
+
+		for (int field = 0; field < BOARD_SIZE; field++)
+		{
+			int code = (board >> (field * 4)) & 0xF;
+			if (code >= NUM_PIECE_CODES)
+			{
+				return -1;
+			}
+
+			index += gFieldTables.contribution[code][field];
+			bValid = bValid && !gFieldTables.unreachable[code][field];
+			counts[code]++;
+		}
+
+		for (int code = 1; code < NUM_PIECE_CODES; code++)
+		{
+			bool bKing = code == WHITE_KING_CODE || code == BLACK_KING_CODE;
+			bValid = bValid && (bKing ? counts[code] == 1 : counts[code] <= 1);
+		}
+
+		return bValid ? index : -1;
+	}
+
+#if defined(POSITION_INDEX_AVX2)
+	/* 8 positions per iteration */
+	void GetPackedIndices8(const PackedBoard* boards, const unsigned char* sideRepetition, int* indices)
+	{
+		const __m256i nibbleMask = _mm256_set1_epi32(0xF);
+		__m256i packed = _mm256_loadu_si256(reinterpret_cast<const __m256i*>(boards));
+		__m256i sides = _mm256_cvtepu8_epi32(_mm_loadl_epi64(reinterpret_cast<const __m128i*>(sideRepetition)));
+
+		__m256i index = _mm256_add_epi32(_mm256_set1_epi32(gFieldTables.base), sides);
+		__m256i invalid = _mm256_cmpgt_epi32(sides, _mm256_set1_epi32(SIDE_REPETITION_COUNT - 1));
+		__m256i counts[NUM_PIECE_CODES] = {};
+
+		for (int field = 0; field < BOARD_SIZE; field++)
+		{
+			__m256i code = _mm256_and_si256(_mm256_srli_epi32(packed, field * 4), nibbleMask);
+			invalid = _mm256_or_si256(invalid, _mm256_cmpgt_epi32(code, _mm256_set1_epi32(NUM_PIECE_CODES - 1)));
+
+			for (int piece = 1; piece < NUM_PIECE_CODES; piece++)
+			{
+				__m256i match = _mm256_cmpeq_epi32(code, _mm256_set1_epi32(piece));
+				index = _mm256_add_epi32(index, _mm256_and_si256(match, _mm256_set1_epi32(gFieldTables.contribution[piece][field])));
+				if (gFieldTables.unreachable[piece][field])
+				{
+					invalid = _mm256_or_si256(invalid, match);
+				}
+				/* Match is -1 */
+				counts[piece] = _mm256_sub_epi32(counts[piece], match);
+			}
+		}
+
+		const __m256i one = _mm256_set1_epi32(1);
+		for (int piece = 1; piece < NUM_PIECE_CODES; piece++)
+		{
+			if (piece == WHITE_KING_CODE || piece == BLACK_KING_CODE)
+			{
+				invalid = _mm256_or_si256(invalid, _mm256_xor_si256(_mm256_cmpeq_epi32(counts[piece], one), _mm256_set1_epi32(-1)));
+			}
+			else
+			{
+				invalid = _mm256_or_si256(invalid, _mm256_cmpgt_epi32(counts[piece], one));
+			}
+		}
+
+		/* Invalid lanes are all ones, which is -1 */
+		_mm256_storeu_si256(reinterpret_cast<__m256i*>(indices), _mm256_or_si256(index, invalid));
+	}
+#elif defined(POSITION_INDEX_SSE2)
+	/* 4 positions per iteration */
+	void GetPackedIndices4(const PackedBoard* boards, const unsigned char* sideRepetition, int* indices)
+	{
+		const __m128i nibbleMask = _mm_set1_epi32(0xF);
+		const __m128i zero = _mm_setzero_si128();
+		__m128i packed = _mm_loadu_si128(reinterpret_cast<const __m128i*>(boards));
+
+		int sideBytes;
+		std::memcpy(&sideBytes, sideRepetition, sizeof(sideBytes));
+		__m128i sides = _mm_unpacklo_epi16(_mm_unpacklo_epi8(_mm_cvtsi32_si128(sideBytes), zero), zero);
+
+		__m128i index = _mm_add_epi32(_mm_set1_epi32(gFieldTables.base), sides);
+		__m128i invalid = _mm_cmpgt_epi32(sides, _mm_set1_epi32(SIDE_REPETITION_COUNT - 1));
+		__m128i counts[NUM_PIECE_CODES] = {};
+
+		for (int field = 0; field < BOARD_SIZE; field++)
+		{
+			__m128i code = _mm_and_si128(_mm_srli_epi32(packed, field * 4), nibbleMask);
+			invalid = _mm_or_si128(invalid, _mm_cmpgt_epi32(code, _mm_set1_epi32(NUM_PIECE_CODES - 1)));
+
+			for (int piece = 1; piece < NUM_PIECE_CODES; piece++)
+			{
+				__m128i match = _mm_cmpeq_epi32(code, _mm_set1_epi32(piece));
+				index = _mm_add_epi32(index, _mm_and_si128(match, _mm_set1_epi32(gFieldTables.contribution[piece][field])));
+				if (gFieldTables.unreachable[piece][field])
+				{
+					invalid = _mm_or_si128(invalid, match);
+				}
+				/* Match is -1 */
+				counts[piece] = _mm_sub_epi32(counts[piece], match);
+			}
+		}
+
+		const __m128i one = _mm_set1_epi32(1);
+		for (int piece = 1; piece < NUM_PIECE_CODES; piece++)
+		{
+			if (piece == WHITE_KING_CODE || piece == BLACK_KING_CODE)
+			{
+				invalid = _mm_or_si128(invalid, _mm_xor_si128(_mm_cmpeq_epi32(counts[piece], one), _mm_set1_epi32(-1)));
+			}
+			else
+			{
+				invalid = _mm_or_si128(invalid, _mm_cmpgt_epi32(counts[piece], one));
+			}
+		}
+
+		/* Invalid lanes are all ones, which is -1 */
+		_mm_storeu_si128(reinterpret_cast<__m128i*>(indices), _mm_or_si128(index, invalid));
+	}
+#endif
+}
+
+int PositionIndex::Get(const Board& board, Color nextPlayer, int repetitionCount)
+{
+	/* Repetition: A third repetition should never land here */
+	if (repetitionCount < 1 || repetitionCount > Possibilities[Repetition])
+	{
+		return -1;
+	}
+
+	/* Actual state of element. Populate for pieces with the value for "taken" */
+	int elementIdentifiers[NumElements];
+	for (int i = 0; i < NumElements; i++)
+	{
+		elementIdentifiers[i] = GetTakenIdentifier(static_cast<Element>(i));
+	}
+	/* Pieces seen, to reject boards with duplicates */
+	bool found[NumElements] = {};
+
+	/* Accelerate by iterating over the board and calculate on occasion. Pieces not found have already the correct value initialized */
+	for (int i = 0; i < BOARD_SIZE; i++)
+	{
+		Element element = GetElement(board.GetPiece(i));
+		if (element == NumElements)
+		{
+			continue;
+		}
+
+		int identifier = GetFieldIdentifier(element, i);
+		if (found[element] || identifier < 0)
+		{
+			return -1;
+		}
+
+		found[element] = true;
+		elementIdentifiers[element] = identifier;
+	}
+
+	/* Both kings are always there */
+	if (!found[WhiteKing] || !found[BlackKing])
+	{
+		return -1;
+	}
+
+	elementIdentifiers[Turn] = nextPlayer == Color::White ? 0 : 1;
+	elementIdentifiers[Repetition] = repetitionCount - 1;
+
+	/* Calculate index */
+	int index = 0;
+	for (int i = 0; i < NumElements; i++)
+	{
+		index += elementIdentifiers[i] * Strides[i];
+	}
+
+	return index;
+}
+
+void PositionIndex::GetBatch(const PackedBoard* boards, const unsigned char* sideRepetition, size_t count, int* indices)
+{
+	size_t i = 0;
+
+#if defined(POSITION_INDEX_AVX2)
+	for (; i + 8 <= count; i += 8)
+	{
+		GetPackedIndices8(boards + i, sideRepetition + i, indices + i);
+	}
+#elif defined(POSITION_INDEX_SSE2)
+	for (; i + 4 <= count; i += 4)
+	{
+		GetPackedIndices4(boards + i, sideRepetition + i, indices + i);
+	}
+#endif
+
+	for (; i < count; i++)
+	{
+		indices[i] = GetPackedIndex(boards[i], sideRepetition[i]);
+	}
+}
@@ -0,0 +1,114 @@
+#pragma once
+#include <array>
+#include <cstddef>
+#include "Board.h"
+
+/* Perfect mixed-radix index of all positions reachable from the starting position.
+ * The index is the sum of element identifier * stride, elements ordered as in Element (white king is the highest digit) */
+struct PositionIndex
+{
+	/* Combinatory elements of a position */
+	enum Element
+	{
+		WhiteKing,
+		WhiteKnight,
+		WhiteRook,
+		BlackRook,
+		BlackKnight,
+		BlackKing,
+		Turn,
+		Repetition,
+		NumElements
+	};
+
+	/* Possibilities for every combinatory element
+	* 6 positions for each king (can't approach other king)
+	* 4 positions for each knight (only one field color) + 1 for taken
+	* 6 positions for each rook (-1 due to own king to the left, -1 due to enemy king to the right, no possibility to "overtake"), + 1 for taken
+	* 2 in case there is same position with different turn
+	* 2 for for repetition counter (third repetition does not need cache, since it is detected as draw)
+	*/
+	static constexpr std::array<int, NumElements> Possibilities = { 6, 5, 7, 7, 5, 6, 2, 2 };
+
+	/* Remaining possibilities after every element, i.e. the weight of its identifier */
+	static constexpr std::array<int, NumElements> Strides = []()
+	{
+		std::array<int, NumElements> strides = {};
+		int remaining = 1;
+		for (int i = NumElements - 1; i >= 0; i--)
+		{
+			strides[i] = remaining;
+			remaining *= Possibilities[i];
+		}
+		return strides;
+	}();
+
+	/* Number of indices [6 * 5 * 7 * 7 * 5 * 6 * 2 * 2 = 176,400] */
+	static constexpr int Count = Strides[0] * Possibilities[0];
+
+	/* Compute index for a position. Returns -1 if the position can't be reached from the starting position and thus has no index */
+	static int Get(const Board& board, Color nextPlayer, int repetitionCount);
+
+	/* Side to move and repetition as one byte. This equals the two lowest digits of the index */
+	static unsigned char PackSideRepetition(Color nextPlayer, int repetitionCount)
+	{
+		return static_cast<unsigned char>((nextPlayer == Color::White ? 0 : 1) * Strides[Turn] + (repetitionCount - 1) * Strides[Repetition]);
+	}
+
+	/* Compute indices for many packed positions at once (SIMD where available). Invalid positions get -1 */
+	static void GetBatch(const PackedBoard* boards, const unsigned char* sideRepetition, size_t count, int* indices);
+
+	/* Element a piece belongs to, NumElements for no piece */
+	static constexpr Element GetElement(Piece piece)
+	{
+		switch (piece)
+		{
+		case Piece::WhiteKing:
+			return WhiteKing;
+		case Piece::WhiteKnight:
+			return WhiteKnight;
+		case Piece::WhiteRook:
+			return WhiteRook;
+		case Piece::BlackRook:
+			return BlackRook;
+		case Piece::BlackKnight:
+			return BlackKnight;
+		case Piece::BlackKing:
+			return BlackKing;
+		default:
+			return NumElements;
+		}
+	}
+
+	/* Identifier of a piece element on a field. -1 if the piece can never reach the field */
+	static constexpr int GetFieldIdentifier(Element element, int field)
+	{
+		switch (element)
+		{
+		case WhiteKing:
+			/* Take actual position. 6 and 7 are not reachable */
+			return field < 6 ? field : -1;
+		case WhiteKnight:
+			/* Division by 2 yields index [1, 3, 5, 7] -> [0, 1, 2, 3] */
+			return field % 2 == 1 ? field / 2 : -1;
+		case WhiteRook:
+		case BlackRook:
+			/* Shift, because left corner is not reachable (right corner too) */
+			return field >= 1 && field < BOARD_SIZE - 1 ? field - 1 : -1;
+		case BlackKnight:
+			/* Division by 2 yields index [0, 2, 4, 6] -> [0, 1, 2, 3] */
+			return field % 2 == 0 ? field / 2 : -1;
+		case BlackKing:
+			/* Shift by 2 since 0 and 1 are not reachable */
+			return field >= 2 ? field - 2 : -1;
+		default:
+			return -1;
+		}
+	}
+
+	/* Identifier for a taken piece, kings can't be taken */
+	static constexpr int GetTakenIdentifier(Element element)
+	{
+		return (element == WhiteKing || element == BlackKing) ? -1 : Possibilities[element] - 1;
+	}
+};
@@ -0,0 +1,77 @@
+#include "PositionIterator.h"
+#include <algorithm>
+
+template<int Size>
+PositionIterator<Size>::PositionIterator(const PositionLayout<Size>& layout, int64_t begin, int64_t end)
+	: m_layout(layout), m_index(std::max<int64_t>(0, begin)), m_end(std::min<int64_t>(end, layout.IsValid() ? layout.GetCount() : 0))
+{
+}
+
+template<int Size>
+bool PositionIterator<Size>::Next()
+{
+	if (m_bStarted)
+	{
+		m_index++;
+	}
+	m_bStarted = true;
+
+	int pieceCount = m_layout.GetElementCount() - 2;
+
+	while (m_index < m_end)
+	{
+		/* Place the pieces from the highest digit down. On a collision no index until the next value of that digit is valid */
+		Board board;
+		int collision = -1;
+		for (int digit = 0; digit < pieceCount; digit++)
+		{
+			int element = m_layout.GetDigitElement(digit);
+			int field = m_layout.GetIdentifierField(element, static_cast<int>(m_index / m_layout.GetStride(element) % m_layout.GetPossibilities(element)));
+			if (field < 0)
+			{
+				continue;
+			}
+
+			if (!board.IsFree(field))
+			{
+				collision = element;
+				break;
+			}
+			board.SetPiece(field, m_layout.GetPiece(element));
+		}
+
+		if (collision >= 0)
+		{
+			int64_t stride = m_layout.GetStride(collision);
+			m_index = (m_index / stride + 1) * stride;
+			continue;
+		}
+
+		Color nextPlayer = m_index / m_layout.GetStride(pieceCount) % 2 == 0 ? Color::White : Color::Black;
+		int repetitionCount = static_cast<int>(m_index / m_layout.GetStride(pieceCount + 1) % 2) + 1;
+
+		/* Canonical order of equal pieces, see PositionLayout::Decode */
+		if (m_layout.HasDuplicatePieces() && m_layout.Get(board, nextPlayer, repetitionCount) != m_index)
+		{
+			m_index++;
+			continue;
+		}
+
+		m_state = GameState(board, nextPlayer);
+		if (!m_state.IsValidState())
+		{
+			m_index++;
+			continue;
+		}
+
+		m_repetitionCount = repetitionCount;
+		return true;
+	}
+
+	return false;
+}
+
+/* Supported board sizes */
+template class PositionIterator<8>;
+template class PositionIterator<10>;
+template class PositionIterator<12>;
@@ -0,0 +1,38 @@
+#pragma once
+#include <cstdint>
+#include "Game.h"
+#include "PositionLayout.h"
+
+/* Dense iteration over the valid indices of a layout in ascending order, optionally limited to [begin, end).
+ * Valid indices decode to a legal position (see PositionLayout::Decode, and the side not to move is not in check).
+ * Index ranges where two pieces share a field are skipped as a whole. Usage:
+ *   for (PositionIterator<Size> it(layout); it.Next();) { ... it.GetIndex() ... it.GetState() ... } */
+template<int Size>
+class PositionIterator
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	PositionIterator(const PositionLayout<Size>& layout, int64_t begin = 0, int64_t end = INT64_MAX);
+
+	/* Advance to the next valid index. False at the end */
+	bool Next();
+
+	int64_t GetIndex() const { return m_index; }
+	const Board& GetBoard() const { return m_state.GetBoard(); }
+	Color GetNextPlayer() const { return m_state.GetNextPlayer(); }
+	int GetRepetitionCount() const { return m_repetitionCount; }
+
+	/* Game state of the position without history. Only the basic state is calculated, FinalizeGameState adds the moves */
+	GameState& GetState() { return m_state; }
+
+private:
+	const PositionLayout<Size>& m_layout;
+	int64_t m_index;
+	int64_t m_end;
+	bool m_bStarted = false;
+
+	GameState m_state;
+	int m_repetitionCount = 1;
+};
@@ -0,0 +1,107 @@
+#include "PositionLayout.h"
+
+template<int Size>
+int64_t PositionLayout<Size>::Get(const BoardType& board, Color nextPlayer, int repetitionCount) const
+{
+	/* Repetition: A third repetition should never land here */
+	if (!m_bValid || repetitionCount < 1 || repetitionCount > m_possibilities[m_pieceCount + 1])
+	{
+		return -1;
+	}
+
+	bool used[MAX_PIECES] = {};
+	int64_t index = 0;
+
+	for (int field = 0; field < Size; field++)
+	{
+		Piece piece = board.GetPiece(field);
+		if (piece == Piece::None)
+		{
+			continue;
+		}
+
+		/* First free element of that piece which can stand on the field. Equal pieces are thereby assigned in a canonical order */
+		int element = -1;
+		for (int i = 0; i < m_pieceCount; i++)
+		{
+			if (!used[i] && m_pieces[i] == piece && m_fieldIdentifiers[i][field] >= 0)
+			{
+				element = i;
+				break;
+			}
+		}
+
+		if (element < 0)
+		{
+			return -1;
+		}
+
+		used[element] = true;
+		index += m_fieldIdentifiers[element][field] * m_strides[element];
+	}
+
+	/* Remaining elements are taken, which is impossible for kings */
+	for (int i = 0; i < m_pieceCount; i++)
+	{
+		if (used[i])
+		{
+			continue;
+		}
+
+		if (m_pieces[i] == Piece::WhiteKing || m_pieces[i] == Piece::BlackKing)
+		{
+			return -1;
+		}
+
+		index += (m_possibilities[i] - 1) * m_strides[i];
+	}
+
+	index += (nextPlayer == Color::White ? 0 : 1) * m_strides[m_pieceCount];
+	index += (repetitionCount - 1) * m_strides[m_pieceCount + 1];
+
+	return index;
+}
+
+template<int Size>
+bool PositionLayout<Size>::Decode(int64_t index, BoardType& board, Color& nextPlayer, int& repetitionCount) const
+{
+	if (!m_bValid || index < 0 || index >= m_count)
+	{
+		return false;
+	}
+
+	board = BoardType();
+	for (int i = 0; i < m_pieceCount; i++)
+	{
+		int field = GetIdentifierField(i, static_cast<int>(index / m_strides[i] % m_possibilities[i]));
+		if (field < 0)
+		{
+			continue;
+		}
+
+		if (!board.IsFree(field))
+		{
+			return false;
+		}
+		board.SetPiece(field, m_pieces[i]);
+	}
+
+	nextPlayer = index / m_strides[m_pieceCount] % 2 == 0 ? Color::White : Color::Black;
+	repetitionCount = static_cast<int>(index / m_strides[m_pieceCount + 1] % 2) + 1;
+
+	/* Equal pieces can be decoded in any order, only the one of Get has this index */
+	return !m_bDuplicatePieces || Get(board, nextPlayer, repetitionCount) == index;
+}
+
+/* Layouts are computed at compile time, e.g. of the starting setups */
+template<int Size>
+constexpr PositionLayout<Size> STARTING_LAYOUT = PositionLayout<Size>::FromSetup(std::string_view(GetStartingSetup<Size>().data(), Size));
+
+static_assert(STARTING_LAYOUT<8>.GetCount() == 176400, "6 * 5 * 7 * 7 * 5 * 6 * 2 * 2");
+static_assert(STARTING_LAYOUT<10>.GetCount() == 746496, "8 * 6 * 9 * 9 * 6 * 8 * 2 * 2");
+static_assert(STARTING_LAYOUT<12>.GetCount() == 2371600, "10 * 7 * 11 * 11 * 7 * 10 * 2 * 2");
+
+/* Supported board sizes */
+template class PositionLayout<8>;
+template class PositionLayout<10>;
+template class PositionLayout<12>;
@@ -0,0 +1,256 @@
+#pragma once
+#include <cstdint>
+#include <string_view>
+#include "Board.h"
+
+/* Order of the piece digits of a layout. Turn and repetition are always the lowest digits */
+enum class LayoutOrder
+{
+	/* Setup order, the first piece is the highest digit. The layout of table files */
+	Setup,
+
+	/* Pieces with the fewest fields lowest, alternating colors (knights, kings, then rooks on the standard setups).
+	 * The many rook moves change high digits, by the same amount for neighbouring indices. A walk in index order
+	 * therefore finds the successors of a position in the cache lines the positions before it loaded */
+	Locality
+};
+
+/* Mixed-radix index layout derived from a starting setup, so variants with other piece orders or missing pieces can be cached.
+ * Every piece of the setup is one combinatory element (in setup order), followed by turn and repetition.
+ * Digits are in element order as well, unless another LayoutOrder is chosen.
+ * Reachable fields of an element:
+ * - Knights keep the field color of their starting field
+ * - Kings and rooks can't pass a king, and a king can't approach the other king
+ * Non-king elements have one more possibility for "taken".
+ * For the standard setup this is exactly the layout of PositionIndex.
+ * Templated on the board size like BasicBoard, layouts of a fixed setup are compile time constants */
+template<int Size>
+class PositionLayout
+{
+public:
+	using BoardType = BasicBoard<Size>;
+
+	/* Every field holds at most one piece */
+	static constexpr int MAX_PIECES = Size;
+	static constexpr int MAX_ELEMENTS = MAX_PIECES + 2;
+
+	/* Derive layout from setup in stream notation. The layout is invalid if the setup has not exactly one king per color */
+	static constexpr PositionLayout FromSetup(std::string_view setup, LayoutOrder order = LayoutOrder::Setup)
+	{
+		PositionLayout layout;
+		layout.m_order = order;
+		if (setup.size() != Size)
+		{
+			return layout;
+		}
+
+		/* Fields of the kings to find the bounds */
+		int whiteKing = -1;
+		int blackKing = -1;
+		for (int field = 0; field < Size; field++)
+		{
+			Piece piece = GetPieceFromChar(setup[field]);
+			if (piece == Piece::WhiteKing)
+			{
+				if (whiteKing >= 0)
+				{
+					return layout;
+				}
+				whiteKing = field;
+			}
+			else if (piece == Piece::BlackKing)
+			{
+				if (blackKing >= 0)
+				{
+					return layout;
+				}
+				blackKing = field;
+			}
+			else if (piece == Piece::None && setup[field] != '.')
+			{
+				return layout;
+			}
+		}
+
+		if (whiteKing < 0 || blackKing < 0)
+		{
+			return layout;
+		}
+
+		for (int field = 0; field < Size; field++)
+		{
+			Piece piece = GetPieceFromChar(setup[field]);
+			if (piece == Piece::None)
+			{
+				continue;
+			}
+
+			int element = layout.m_pieceCount++;
+			for (int other = 0; other < element; other++)
+			{
+				layout.m_bDuplicatePieces = layout.m_bDuplicatePieces || layout.m_pieces[other] == piece;
+			}
+			layout.m_pieces[element] = piece;
+
+			bool bKing = piece == Piece::WhiteKing || piece == Piece::BlackKing;
+			bool bKnight = piece == Piece::WhiteKnight || piece == Piece::BlackKnight;
+
+			/* Kings and rooks stay between the kings around them, with one free field between two kings */
+			bool bKingLeft = (whiteKing < field) || (blackKing < field);
+			bool bKingRight = (whiteKing > field) || (blackKing > field);
+			int lower = bKingLeft ? (bKing ? 2 : 1) : 0;
+			int upper = Size - 1 - (bKingRight ? (bKing ? 2 : 1) : 0);
+
+			int fieldCount = 0;
+			for (int target = 0; target < Size; target++)
+			{
+				bool bReachable = bKnight ? (target % 2 == field % 2) : (target >= lower && target <= upper);
+				if (bReachable)
+				{
+					layout.m_identifierFields[element][fieldCount] = static_cast<signed char>(target);
+				}
+				layout.m_fieldIdentifiers[element][target] = bReachable ? static_cast<signed char>(fieldCount++) : -1;
+			}
+
+			layout.m_possibilities[element] = bKing ? fieldCount : fieldCount + 1;
+		}
+
+		/* Turn and repetition */
+		layout.m_possibilities[layout.m_pieceCount] = 2;
+		layout.m_possibilities[layout.m_pieceCount + 1] = 2;
+
+		/* Element of every digit from the highest, element order unless reordered below */
+		for (int element = 0; element < layout.m_pieceCount + 2; element++)
+		{
+			layout.m_digitElements[element] = element;
+		}
+		if (order == LayoutOrder::Locality)
+		{
+			/* From the lowest digit up: The piece with the fewest fields, of the other color than the digit below if possible */
+			bool used[MAX_PIECES] = {};
+			for (int digit = layout.m_pieceCount - 1; digit >= 0; digit--)
+			{
+				bool bFirst = digit == layout.m_pieceCount - 1;
+				bool bLastWhite = !bFirst && IsWhite(layout.m_pieces[layout.m_digitElements[digit + 1]]);
+
+				int best = -1;
+				for (int element = 0; element < layout.m_pieceCount; element++)
+				{
+					if (used[element])
+					{
+						continue;
+					}
+
+					bool bAlternates = bFirst || IsWhite(layout.m_pieces[element]) != bLastWhite;
+					bool bBestAlternates = best >= 0 && (bFirst || IsWhite(layout.m_pieces[best]) != bLastWhite);
+					if (best < 0 || (bAlternates && !bBestAlternates)
+						|| (bAlternates == bBestAlternates && layout.m_possibilities[element] < layout.m_possibilities[best]))
+					{
+						best = element;
+					}
+				}
+
+				used[best] = true;
+				layout.m_digitElements[digit] = best;
+			}
+		}
+
+		int64_t remaining = 1;
+		for (int digit = layout.m_pieceCount + 1; digit >= 0; digit--)
+		{
+			int element = layout.m_digitElements[digit];
+			/* Indices are 64 bit. Solvers holding the table in memory limit it further, see their IsValidSetup */
+			if (remaining > INT64_MAX / layout.m_possibilities[element])
+			{
+				return PositionLayout();
+			}
+			layout.m_strides[element] = remaining;
+			remaining *= layout.m_possibilities[element];
+		}
+		layout.m_count = remaining;
+		layout.m_bValid = true;
+
+		return layout;
+	}
+
+	/* Compute index for a position. Returns -1 if the position can't be reached from the setup */
+	int64_t Get(const BoardType& board, Color nextPlayer, int repetitionCount) const;
+
+	/* Position of an index, the inverse of Get. Returns false for indices without position: Two pieces on one field,
+	 * or equal pieces in another than the canonical order of Get. Legality (check) is up to the rules, see PositionIterator */
+	bool Decode(int64_t index, BoardType& board, Color& nextPlayer, int& repetitionCount) const;
+
+	constexpr bool IsValid() const { return m_bValid; }
+
+	/* If the setup has equal pieces, which makes some collision-free indices non-canonical */
+	constexpr bool HasDuplicatePieces() const { return m_bDuplicatePieces; }
+
+	/* Number of indices */
+	constexpr int64_t GetCount() const { return m_count; }
+
+	constexpr LayoutOrder GetOrder() const { return m_order; }
+
+	/* Number of combinatory elements, pieces plus turn and repetition */
+	constexpr int GetElementCount() const { return m_pieceCount + 2; }
+
+	/* Element of a digit, digit 0 is the highest */
+	constexpr int GetDigitElement(int digit) const { return m_digitElements[digit]; }
+	constexpr int GetPossibilities(int element) const { return m_possibilities[element]; }
+	constexpr int64_t GetStride(int element) const { return m_strides[element]; }
+
+	/* Piece of an element */
+	constexpr Piece GetPiece(int element) const { return m_pieces[element]; }
+
+	/* Identifier of an element on a field, -1 if not reachable */
+	constexpr int GetFieldIdentifier(int element, int field) const { return m_fieldIdentifiers[element][field]; }
+
+	/* Field of an element identifier, -1 for "taken" */
+	constexpr int GetIdentifierField(int element, int identifier) const
+	{
+		bool bKing = m_pieces[element] == Piece::WhiteKing || m_pieces[element] == Piece::BlackKing;
+		return !bKing && identifier == m_possibilities[element] - 1 ? -1 : m_identifierFields[element][identifier];
+	}
+
+private:
+	static constexpr bool IsWhite(Piece piece)
+	{
+		return piece == Piece::WhiteRook || piece == Piece::WhiteKnight || piece == Piece::WhiteKing;
+	}
+
+	/* Same characters as the stream operator of Board */
+	static constexpr Piece GetPieceFromChar(char c)
+	{
+		switch (c)
+		{
+		case 'R':
+			return Piece::WhiteRook;
+		case 'N':
+			return Piece::WhiteKnight;
+		case 'K':
+			return Piece::WhiteKing;
+		case 'r':
+			return Piece::BlackRook;
+		case 'n':
+			return Piece::BlackKnight;
+		case 'k':
+			return Piece::BlackKing;
+		default:
+			return Piece::None;
+		}
+	}
+
+	int m_pieceCount = 0;
+	Piece m_pieces[MAX_PIECES] = {};
+	int m_possibilities[MAX_ELEMENTS] = {};
+	int64_t m_strides[MAX_ELEMENTS] = {};
+	int m_digitElements[MAX_ELEMENTS] = {};
+	LayoutOrder m_order = LayoutOrder::Setup;
+	signed char m_fieldIdentifiers[MAX_PIECES][Size] = {};
+	/* Inverse of m_fieldIdentifiers */
+	signed char m_identifierFields[MAX_PIECES][Size] = {};
+	int64_t m_count = 0;
+	bool m_bValid = false;
+
+	/* Only with equal pieces a decoded position can be non-canonical */
+	bool m_bDuplicatePieces = false;
+};
@@ -0,0 +1,15 @@
+#pragma once
+
+#if defined(_MSC_VER)
+#include <xmmintrin.h>
+#endif
+
+/* Hint that the cache line of an address is read soon. No effect on the result, safe for any address */
+inline void PrefetchRead(const void* address)
+{
+#if defined(_MSC_VER)
+	_mm_prefetch(static_cast<const char*>(address), _MM_HINT_T0);
+#else
+	__builtin_prefetch(address, 0, 3);
+#endif
+}
@@ -0,0 +1,639 @@
+#include "QueryServer.h"
+#include <algorithm>
+#include <cstdio>
+#include <cstring>
+#include "PositionIndex.h"
+
+#if defined(_WIN32)
+#define NOMINMAX
+#include <winsock2.h>
+#include <afunix.h>
+#pragma comment(lib, "Ws2_32.lib")
+#else
+#include <cerrno>
+#include <fcntl.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <sys/un.h>
+#include <unistd.h>
+#endif
+
+namespace
+{
+#if defined(_WIN32)
+	using PollDescriptor = WSAPOLLFD;
+	using NativeSocket = SOCKET;
+
+	bool InitSockets()
+	{
+		static bool bStarted = []()
+		{
+			WSADATA data;
+			return WSAStartup(MAKEWORD(2, 2), &data) == 0;
+		}();
+		return bStarted;
+	}
+
+	void CloseSocket(SocketHandle socket) { closesocket(static_cast<NativeSocket>(socket)); }
+	bool SetNonBlocking(SocketHandle socket) { u_long mode = 1; return ioctlsocket(static_cast<NativeSocket>(socket), FIONBIO, &mode) == 0; }
+	bool WouldBlock() { int error = WSAGetLastError(); return error == WSAEWOULDBLOCK || error == WSAEINTR; }
+	int PollSockets(PollDescriptor* descriptors, size_t count, int milliseconds) { return WSAPoll(descriptors, static_cast<ULONG>(count), milliseconds); }
+	intptr_t ReceiveBytes(SocketHandle socket, unsigned char* bytes, size_t count) { return recv(static_cast<NativeSocket>(socket), reinterpret_cast<char*>(bytes), static_cast<int>(count), 0); }
+	intptr_t SendBytes(SocketHandle socket, const unsigned char* bytes, size_t count) { return send(static_cast<NativeSocket>(socket), reinterpret_cast<const char*>(bytes), static_cast<int>(count), 0); }
+#else
+	using PollDescriptor = pollfd;
+	using NativeSocket = int;
+
+	bool InitSockets() { return true; }
+	void CloseSocket(SocketHandle socket) { close(static_cast<NativeSocket>(socket)); }
+	bool SetNonBlocking(SocketHandle socket) { return fcntl(static_cast<NativeSocket>(socket), F_SETFL, fcntl(static_cast<NativeSocket>(socket), F_GETFL) | O_NONBLOCK) == 0; }
+	bool WouldBlock() { return errno == EAGAIN || errno == EWOULDBLOCK || errno == EINTR; }
+	int PollSockets(PollDescriptor* descriptors, size_t count, int milliseconds) { return poll(descriptors, static_cast<nfds_t>(count), milliseconds); }
+	intptr_t ReceiveBytes(SocketHandle socket, unsigned char* bytes, size_t count) { return recv(static_cast<NativeSocket>(socket), bytes, count, 0); }
+
+	/* A closed peer is an error, not a signal ending the process */
+#if defined(MSG_NOSIGNAL)
+	intptr_t SendBytes(SocketHandle socket, const unsigned char* bytes, size_t count) { return send(static_cast<NativeSocket>(socket), bytes, count, MSG_NOSIGNAL); }
+#else
+	intptr_t SendBytes(SocketHandle socket, const unsigned char* bytes, size_t count) { return send(static_cast<NativeSocket>(socket), bytes, count, 0); }
+#endif
+#endif
+
+	/* Stream socket and address for a path, -1 if the path is too long or there are no sockets */
+	SocketHandle CreateSocket(const std::string& path, sockaddr_un& address)
+	{
+		std::memset(&address, 0, sizeof(address));
+		address.sun_family = AF_UNIX;
+		if (!InitSockets() || path.size() >= sizeof(address.sun_path))
+		{
+			return -1;
+		}
+		std::memcpy(address.sun_path, path.c_str(), path.size() + 1);
+
+		NativeSocket socket = ::socket(AF_UNIX, SOCK_STREAM, 0);
+		return static_cast<SocketHandle>(socket);
+	}
+
+	/* Time Run waits for events before it checks for Stop */
+	constexpr int POLL_MILLISECONDS = 100;
+}
+
+void QueryProtocol::WriteRequest(const Request& request, unsigned char* bytes)
+{
+	WriteUint32(request.id, bytes);
+	bytes[4] = static_cast<unsigned char>(request.operation);
+	bytes[5] = request.nextPlayer == Color::White ? 0 : 1;
+	bytes[6] = static_cast<unsigned char>(request.repetitionCount);
+	bytes[7] = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		bytes[8 + i] = static_cast<unsigned char>(request.board >> (i * 8));
+	}
+}
+
+QueryProtocol::Request QueryProtocol::ReadRequest(const unsigned char* bytes)
+{
+	Request request;
+	request.id = ReadUint32(bytes);
+	request.operation = bytes[4];
+
+	/* Anything but 0 and 1 makes the request invalid, like a bad repetition count */
+	request.nextPlayer = bytes[5] == 0 ? Color::White : Color::Black;
+	request.repetitionCount = bytes[5] <= 1 ? bytes[6] : 0;
+
+	request.board = 0;
+	for (int i = 0; i < 8; i++)
+	{
+		request.board |= static_cast<uint64_t>(bytes[8 + i]) << (i * 8);
+	}
+	return request;
+}
+
+void QueryProtocol::WriteUint32(uint32_t value, unsigned char* bytes)
+{
+	for (int i = 0; i < 4; i++)
+	{
+		bytes[i] = static_cast<unsigned char>(value >> (i * 8));
+	}
+}
+
+template<int Size>
+QueryServer<Size>::QueryServer(const BasicEvaluationTree<Size>& eval, int maxConnections) : m_eval(eval), m_maxConnections(maxConnections), m_listenSocket(-1)
+{
+	m_successors.reserve(static_cast<size_t>(LANE_COUNT) * MAX_MOVES);
+	m_connections.reserve(maxConnections);
+}
+
+template<int Size>
+QueryServer<Size>::~QueryServer()
+{
+	for (const std::unique_ptr<Connection>& connection : m_connections)
+	{
+		CloseSocket(connection->socket);
+	}
+	if (m_listenSocket != -1)
+	{
+		CloseSocket(m_listenSocket);
+		std::remove(m_path.c_str());
+	}
+}
+
+template<int Size>
+bool QueryServer<Size>::Listen(const std::string& path)
+{
+	sockaddr_un address;
+	m_listenSocket = CreateSocket(path, address);
+	if (m_listenSocket == -1)
+	{
+		return false;
+	}
+
+	/* Left over by a server that didn't end cleanly */
+	std::remove(path.c_str());
+	m_path = path;
+
+	NativeSocket socket = static_cast<NativeSocket>(m_listenSocket);
+	return bind(socket, reinterpret_cast<const sockaddr*>(&address), sizeof(address)) == 0
+		&& listen(socket, SOMAXCONN) == 0
+		&& SetNonBlocking(m_listenSocket);
+}
+
+template<int Size>
+void QueryServer<Size>::Run(std::ostream* log)
+{
+	if (log != nullptr)
+	{
+		*log << "Listening on " << m_path << std::endl;
+	}
+
+	/* Listening socket first, then one per connection in the order of m_connections */
+	std::vector<PollDescriptor> descriptors;
+	descriptors.reserve(m_maxConnections + 1);
+
+	while (!m_bStop.load(std::memory_order_relaxed))
+	{
+		descriptors.clear();
+		descriptors.push_back({ static_cast<NativeSocket>(m_listenSocket), POLLIN, 0 });
+		for (const std::unique_ptr<Connection>& connection : m_connections)
+		{
+			/* No reading while the input is full, it waits for the output to drain */
+			short events = connection->inputSize < INPUT_BYTES && !connection->bEnd ? POLLIN : 0;
+			events |= connection->outputEnd > connection->outputBegin ? POLLOUT : 0;
+			descriptors.push_back({ static_cast<NativeSocket>(connection->socket), events, 0 });
+		}
+
+		if (PollSockets(descriptors.data(), descriptors.size(), POLL_MILLISECONDS) <= 0)
+		{
+			continue;
+		}
+
+		/* New connections are appended, so the descriptors still match the first connections */
+		size_t connectionCount = m_connections.size();
+		if (descriptors[0].revents & POLLIN)
+		{
+			Accept();
+		}
+
+		for (size_t i = 0; i < connectionCount; i++)
+		{
+			Connection& connection = *m_connections[i];
+			short events = descriptors[i + 1].revents;
+
+			if (events & (POLLIN | POLLHUP))
+			{
+				Receive(connection);
+			}
+			if (events & (POLLERR | POLLNVAL))
+			{
+				connection.bClosed = true;
+				continue;
+			}
+
+			Answer(connection);
+			Send(connection);
+
+			/* All requests of a finished peer answered */
+			if (connection.bEnd && connection.inputSize < QueryProtocol::REQUEST_BYTES && connection.outputEnd == connection.outputBegin)
+			{
+				connection.bClosed = true;
+			}
+		}
+
+		for (size_t i = 0; i < m_connections.size();)
+		{
+			if (m_connections[i]->bClosed)
+			{
+				CloseSocket(m_connections[i]->socket);
+				m_connections.erase(m_connections.begin() + i);
+			}
+			else
+			{
+				i++;
+			}
+		}
+	}
+
+	if (log != nullptr)
+	{
+		*log << "Requests: " << m_requestCount << " in " << m_batchCount << " batches" << std::endl;
+	}
+}
+
+template<int Size>
+void QueryServer<Size>::Accept()
+{
+	while (true)
+	{
+		NativeSocket socket = accept(static_cast<NativeSocket>(m_listenSocket), nullptr, nullptr);
+		SocketHandle handle = static_cast<SocketHandle>(socket);
+		if (handle == -1)
+		{
+			return;
+		}
+
+		if (static_cast<int>(m_connections.size()) >= m_maxConnections || !SetNonBlocking(handle))
+		{
+			CloseSocket(handle);
+			continue;
+		}
+
+		std::unique_ptr<Connection> connection = std::make_unique<Connection>();
+		connection->socket = handle;
+		connection->input.resize(INPUT_BYTES);
+		connection->output.resize(OUTPUT_BYTES);
+		m_connections.push_back(std::move(connection));
+	}
+}
+
+template<int Size>
+void QueryServer<Size>::Receive(Connection& connection)
+{
+	while (connection.inputSize < INPUT_BYTES)
+	{
+		intptr_t received = ReceiveBytes(connection.socket, connection.input.data() + connection.inputSize, INPUT_BYTES - connection.inputSize);
+		if (received > 0)
+		{
+			connection.inputSize += static_cast<size_t>(received);
+		}
+		else
+		{
+			connection.bEnd = received == 0 || !WouldBlock();
+			return;
+		}
+	}
+}
+
+template<int Size>
+void QueryServer<Size>::Answer(Connection& connection)
+{
+	/* Room for replies at the end of the output buffer */
+	if (connection.outputBegin > 0)
+	{
+		std::memmove(connection.output.data(), connection.output.data() + connection.outputBegin, connection.outputEnd - connection.outputBegin);
+		connection.outputEnd -= connection.outputBegin;
+		connection.outputBegin = 0;
+	}
+
+	size_t count = std::min(connection.inputSize / QueryProtocol::REQUEST_BYTES, (OUTPUT_BYTES - connection.outputEnd) / MAX_REPLY_BYTES);
+	for (size_t offset = 0; offset < count; offset += LANE_COUNT)
+	{
+		AnswerBatch(connection.input.data() + offset * QueryProtocol::REQUEST_BYTES, static_cast<int>(std::min<size_t>(count - offset, LANE_COUNT)), connection);
+	}
+
+	size_t consumed = count * QueryProtocol::REQUEST_BYTES;
+	std::memmove(connection.input.data(), connection.input.data() + consumed, connection.inputSize - consumed);
+	connection.inputSize -= consumed;
+}
+
+template<int Size>
+void QueryServer<Size>::Send(Connection& connection)
+{
+	while (connection.outputEnd > connection.outputBegin)
+	{
+		intptr_t sent = SendBytes(connection.socket, connection.output.data() + connection.outputBegin, connection.outputEnd - connection.outputBegin);
+		if (sent > 0)
+		{
+			connection.outputBegin += static_cast<size_t>(sent);
+		}
+		else
+		{
+			connection.bClosed = !WouldBlock();
+			return;
+		}
+	}
+
+	connection.outputBegin = 0;
+	connection.outputEnd = 0;
+}
+
+template<int Size>
+void QueryServer<Size>::AnswerBatch(const unsigned char* requests, int count, Connection& connection)
+{
+	m_batchCount++;
+	m_requestCount += count;
+
+	/* Rules of all positions at once */
+	m_rules.Clear();
+	for (int lane = 0; lane < count; lane++)
+	{
+		QueryProtocol::Request& request = m_requests[lane];
+		request = QueryProtocol::ReadRequest(requests + lane * QueryProtocol::REQUEST_BYTES);
+
+		/* Piece values of all fields and nothing beyond the board */
+		bool bValid = request.operation >= 0 && request.operation < QueryProtocol::OperationCount
+			&& request.repetitionCount >= 1 && request.repetitionCount <= 3
+			&& (request.board >> (Size * 4)) == 0;
+		for (int field = 0; field < Size && bValid; field++)
+		{
+			bValid = ((request.board >> (field * 4)) & 0xF) <= static_cast<uint64_t>(Piece::BlackKing);
+		}
+
+		m_values[lane] = bValid ? QueryProtocol::VALUE_UNKNOWN : QueryProtocol::VALUE_INVALID;
+		if (bValid)
+		{
+			m_rules.SetPosition(lane, Board::Unpack(static_cast<PackedBoard>(request.board)), request.nextPlayer);
+		}
+	}
+	m_rules.Evaluate();
+
+	/* Terminal positions from the rules, the others from the table. Moves of positions asking for them */
+	int probeLanes[LANE_COUNT];
+	int probeCount = 0;
+	m_successors.clear();
+	for (int lane = 0; lane < count; lane++)
+	{
+		const QueryProtocol::Request& request = m_requests[lane];
+		if (m_values[lane] == QueryProtocol::VALUE_INVALID)
+		{
+			continue;
+		}
+		if (!GetLane(m_rules.GetValid(), lane))
+		{
+			m_values[lane] = QueryProtocol::VALUE_INVALID;
+			continue;
+		}
+
+		int value = request.repetitionCount >= 3 ? 0 : GetTerminalValue(m_rules, lane, request.nextPlayer);
+		if (value != -2)
+		{
+			m_values[lane] = value;
+			continue;
+		}
+
+		m_packed[probeCount] = static_cast<PackedBoard>(request.board);
+		m_sideRepetition[probeCount] = PositionIndex::PackSideRepetition(request.nextPlayer, request.repetitionCount);
+		probeLanes[probeCount++] = lane;
+
+		if (request.operation != QueryProtocol::Value)
+		{
+			Board board = Board::Unpack(static_cast<PackedBoard>(request.board));
+			for (int from = 0; from < Size; from++)
+			{
+				for (int to = 0; to < Size; to++)
+				{
+					if (GetLane(m_rules.GetMoves(from, to), lane))
+					{
+						Successor successor = { lane, from, to, board, -2 };
+						successor.board.SetPiece(to, board.GetPiece(from));
+						successor.board.SetPiece(from, Piece::None);
+						m_successors.push_back(successor);
+					}
+				}
+			}
+		}
+	}
+
+	m_eval.ProbeBatch(m_packed, m_sideRepetition, probeCount, m_results);
+	for (int i = 0; i < probeCount; i++)
+	{
+		m_values[probeLanes[i]] = m_results[i];
+	}
+
+	EvaluateSuccessors();
+
+	/* Replies in the order of the requests, the successors are in lane order too */
+	unsigned char* output = connection.output.data();
+	size_t successor = 0;
+	for (int lane = 0; lane < count; lane++)
+	{
+		const QueryProtocol::Request& request = m_requests[lane];
+		size_t first = successor;
+		while (successor < m_successors.size() && m_successors[successor].lane == lane)
+		{
+			successor++;
+		}
+
+		/* Best move like GetBestMove: The first with the best value, unknown if an unknown move could be better */
+		size_t best = m_successors.size();
+		if (request.operation == QueryProtocol::BestMove)
+		{
+			int sign = request.nextPlayer == Color::White ? 1 : -1;
+			bool bComplete = true;
+			for (size_t i = first; i < successor; i++)
+			{
+				if (m_successors[i].value == -2)
+				{
+					bComplete = false;
+				}
+				else if (best == m_successors.size() || m_successors[i].value * sign > m_successors[best].value * sign)
+				{
+					best = i;
+				}
+			}
+			if (best != m_successors.size() && !bComplete && m_successors[best].value * sign < 1)
+			{
+				best = m_successors.size();
+			}
+		}
+
+		size_t begin = request.operation == QueryProtocol::BestMove ? best : first;
+		size_t end = request.operation == QueryProtocol::BestMove ? std::min(best + 1, m_successors.size()) : successor;
+
+		unsigned char* reply = output + connection.outputEnd;
+		QueryProtocol::WriteUint32(request.id, reply);
+		reply[4] = static_cast<unsigned char>(request.operation);
+		reply[5] = static_cast<unsigned char>(static_cast<signed char>(m_values[lane]));
+		reply[6] = static_cast<unsigned char>(end - begin);
+		reply[7] = 0;
+		reply += QueryProtocol::REPLY_BYTES;
+
+		for (size_t i = begin; i < end; i++)
+		{
+			const Successor& move = m_successors[i];
+			reply[0] = static_cast<unsigned char>(move.from);
+			reply[1] = static_cast<unsigned char>(move.to);
+			reply[2] = static_cast<unsigned char>(move.board.GetPieceType(move.to));
+			reply[3] = static_cast<unsigned char>(static_cast<signed char>(move.value));
+			reply += QueryProtocol::MOVE_BYTES;
+		}
+
+		connection.outputEnd = reply - output;
+	}
+}
+
+template<int Size>
+void QueryServer<Size>::EvaluateSuccessors()
+{
+	for (size_t offset = 0; offset < m_successors.size(); offset += LANE_COUNT)
+	{
+		int count = static_cast<int>(std::min<size_t>(m_successors.size() - offset, LANE_COUNT));
+		Successor* successors = m_successors.data() + offset;
+
+		m_rules.Clear();
+		for (int lane = 0; lane < count; lane++)
+		{
+			Color nextPlayer = m_requests[successors[lane].lane].nextPlayer == Color::White ? Color::Black : Color::White;
+			m_rules.SetPosition(lane, successors[lane].board, nextPlayer);
+		}
+		m_rules.Evaluate();
+
+		int probeLanes[LANE_COUNT];
+		int probeCount = 0;
+		for (int lane = 0; lane < count; lane++)
+		{
+			Color nextPlayer = m_requests[successors[lane].lane].nextPlayer == Color::White ? Color::Black : Color::White;
+			successors[lane].value = GetTerminalValue(m_rules, lane, nextPlayer);
+			if (successors[lane].value == -2)
+			{
+				m_packed[probeCount] = successors[lane].board.Pack();
+				m_sideRepetition[probeCount] = PositionIndex::PackSideRepetition(nextPlayer, 1);
+				probeLanes[probeCount++] = lane;
+			}
+		}
+
+		m_eval.ProbeBatch(m_packed, m_sideRepetition, probeCount, m_results);
+		for (int i = 0; i < probeCount; i++)
+		{
+			successors[probeLanes[i]].value = m_results[i];
+		}
+	}
+}
+
+template<int Size>
+int QueryServer<Size>::GetTerminalValue(const BitslicedRules<Size>& rules, int lane, Color nextPlayer)
+{
+	if (GetLane(rules.GetMate(), lane))
+	{
+		/* The side to move lost */
+		return nextPlayer == Color::White ? -1 : 1;
+	}
+	if (GetLane(rules.GetStalemate(), lane) || GetLane(rules.GetInsufficientMaterial(), lane))
+	{
+		return 0;
+	}
+	return -2;
+}
+
+QueryClient::~QueryClient()
+{
+	Close();
+}
+
+bool QueryClient::Connect(const std::string& path)
+{
+	Close();
+
+	sockaddr_un address;
+	m_socket = CreateSocket(path, address);
+	if (m_socket == -1)
+	{
+		return false;
+	}
+
+	if (connect(static_cast<NativeSocket>(m_socket), reinterpret_cast<const sockaddr*>(&address), sizeof(address)) != 0)
+	{
+		Close();
+		return false;
+	}
+
+	m_receiveBuffer.resize(1 << 16);
+	m_receiveBegin = 0;
+	m_receiveEnd = 0;
+	return true;
+}
+
+void QueryClient::Close()
+{
+	if (m_socket != -1)
+	{
+		CloseSocket(m_socket);
+		m_socket = -1;
+	}
+}
+
+bool QueryClient::Send(const QueryProtocol::Request* requests, size_t count)
+{
+	m_sendBuffer.resize(count * QueryProtocol::REQUEST_BYTES);
+	for (size_t i = 0; i < count; i++)
+	{
+		QueryProtocol::WriteRequest(requests[i], m_sendBuffer.data() + i * QueryProtocol::REQUEST_BYTES);
+	}
+
+	size_t offset = 0;
+	while (offset < m_sendBuffer.size())
+	{
+		intptr_t sent = SendBytes(m_socket, m_sendBuffer.data() + offset, m_sendBuffer.size() - offset);
+		if (sent <= 0)
+		{
+			return false;
+		}
+		offset += static_cast<size_t>(sent);
+	}
+	return true;
+}
+
+bool QueryClient::Receive(Reply& reply)
+{
+	unsigned char header[QueryProtocol::REPLY_BYTES];
+	if (!ReadBytes(header, sizeof(header)))
+	{
+		return false;
+	}
+
+	reply.id = QueryProtocol::ReadUint32(header);
+	reply.operation = header[4];
+	reply.value = static_cast<signed char>(header[5]);
+	reply.moves.clear();
+	reply.moveValues.clear();
+
+	for (int i = 0; i < header[6]; i++)
+	{
+		unsigned char move[QueryProtocol::MOVE_BYTES];
+		if (!ReadBytes(move, sizeof(move)))
+		{
+			return false;
+		}
+		reply.moves.push_back({ move[0], move[1], static_cast<PieceType>(move[2]) });
+		reply.moveValues.push_back(static_cast<signed char>(move[3]));
+	}
+	return true;
+}
+
+bool QueryClient::ReadBytes(unsigned char* bytes, size_t count)
+{
+	while (count > 0)
+	{
+		if (m_receiveBegin == m_receiveEnd)
+		{
+			intptr_t received = ReceiveBytes(m_socket, m_receiveBuffer.data(), m_receiveBuffer.size());
+			if (received <= 0)
+			{
+				return false;
+			}
+			m_receiveBegin = 0;
+			m_receiveEnd = static_cast<size_t>(received);
+		}
+
+		size_t chunk = std::min(count, m_receiveEnd - m_receiveBegin);
+		std::memcpy(bytes, m_receiveBuffer.data() + m_receiveBegin, chunk);
+		m_receiveBegin += chunk;
+		bytes += chunk;
+		count -= chunk;
+	}
+	return true;
+}
+
+/* Supported board sizes */
+template class QueryServer<8>;
+template class QueryServer<10>;
+template class QueryServer<12>;
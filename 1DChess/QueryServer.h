@@ -0,0 +1,203 @@
+#pragma once
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "BitslicedRules.h"
+#include "EvaluationTree.h"
+
+/* Binary protocol of QueryServer, all numbers little-endian. Requests can be sent back to back without waiting for replies,
+ * they are answered in order.
+ * Request, 16 bytes: uint32 id, uint8 operation, uint8 side to move (0 white, 1 black), uint8 repetition count (1-3), uint8 0,
+ *   uint64 board in the encoding of BasicBoard::Pack (4 bits per field holding the Piece value, field 0 lowest, unused fields 0).
+ * Reply, 8 bytes and 4 per move: uint32 id, uint8 operation, int8 value of the position, uint8 move count, uint8 0,
+ *   then per move uint8 from, uint8 to, uint8 PieceType, int8 value after the move.
+ * Values are 1, 0, -1 as everywhere, VALUE_UNKNOWN if the table doesn't know and VALUE_INVALID for requests that can't be answered.
+ * Moves are evaluated as positions seen for the first time */
+struct QueryProtocol
+{
+	enum Operation
+	{
+		/* Value only, no moves */
+		Value,
+		/* The best move, none if unknown */
+		BestMove,
+		/* All legal moves with their values */
+		Moves,
+		OperationCount
+	};
+
+	static constexpr int VALUE_UNKNOWN = -2;
+	static constexpr int VALUE_INVALID = -3;
+
+	static constexpr size_t REQUEST_BYTES = 16;
+	static constexpr size_t REPLY_BYTES = 8;
+	static constexpr size_t MOVE_BYTES = 4;
+
+	struct Request
+	{
+		uint32_t id = 0;
+		int operation = Value;
+		Color nextPlayer = Color::White;
+		int repetitionCount = 1;
+		uint64_t board = 0;
+	};
+
+	static void WriteRequest(const Request& request, unsigned char* bytes);
+	static Request ReadRequest(const unsigned char* bytes);
+
+	static uint32_t ReadUint32(const unsigned char* bytes) { return bytes[0] | (bytes[1] << 8) | (bytes[2] << 16) | (static_cast<uint32_t>(bytes[3]) << 24); }
+	static void WriteUint32(uint32_t value, unsigned char* bytes);
+};
+
+/* Native socket: int on POSIX, SOCKET on Windows */
+using SocketHandle = intptr_t;
+
+/* Answers QueryProtocol requests from other processes over a Unix domain socket, so they don't have to start the game and solve again.
+ * One thread runs an event loop over all connections. Every read is answered as a batch: The rules of up to 64 positions are
+ * computed at once by BitslicedRules, their values looked up by ProbeBatch. Buffers are sized when a connection is accepted,
+ * answering allocates nothing */
+template<int Size>
+class QueryServer
+{
+public:
+	using Board = BasicBoard<Size>;
+	using PackedBoard = typename Board::Packed;
+
+	QueryServer(const BasicEvaluationTree<Size>& eval, int maxConnections = 64);
+	~QueryServer();
+
+	QueryServer(const QueryServer&) = delete;
+	QueryServer& operator=(const QueryServer&) = delete;
+
+	/* Listen on the path, a stale socket file there is replaced. False if that fails */
+	bool Listen(const std::string& path);
+
+	/* Serve until Stop. Progress goes to the stream, if any */
+	void Run(std::ostream* log = nullptr);
+
+	/* End Run within 100 ms, callable from any thread and from signal handlers */
+	void Stop() { m_bStop.store(true, std::memory_order_relaxed); }
+
+	uint64_t GetRequestCount() const { return m_requestCount; }
+	uint64_t GetBatchCount() const { return m_batchCount; }
+
+private:
+	static constexpr int LANE_COUNT = BitslicedRules<Size>::LANE_COUNT;
+
+	/* Upper bound of legal moves: Every field to every other field */
+	static constexpr int MAX_MOVES = Size * (Size - 1);
+	static constexpr size_t MAX_REPLY_BYTES = QueryProtocol::REPLY_BYTES + MAX_MOVES * QueryProtocol::MOVE_BYTES;
+
+	static constexpr size_t INPUT_BYTES = 1 << 16;
+	static constexpr size_t OUTPUT_BYTES = 1 << 20;
+
+	struct Connection
+	{
+		SocketHandle socket;
+		std::vector<unsigned char> input;
+		size_t inputSize = 0;
+		std::vector<unsigned char> output;
+		size_t outputBegin = 0;
+		size_t outputEnd = 0;
+
+		/* The peer stopped sending, or the connection failed */
+		bool bEnd = false;
+		bool bClosed = false;
+	};
+
+	/* Move of a request position, the successor goes through the rules and the table like a request */
+	struct Successor
+	{
+		int lane;
+		int from;
+		int to;
+		Board board;
+		int value;
+	};
+
+	void Accept();
+
+	/* Read what arrived, as much as the input buffer holds */
+	void Receive(Connection& connection);
+
+	/* Answer all complete requests whose replies fit into the output buffer */
+	void Answer(Connection& connection);
+
+	/* Write pending replies as far as the socket takes them */
+	void Send(Connection& connection);
+
+	/* Answer up to LANE_COUNT requests, replies are appended to the output buffer */
+	void AnswerBatch(const unsigned char* requests, int count, Connection& connection);
+
+	/* Values of all m_successors, in blocks of LANE_COUNT */
+	void EvaluateSuccessors();
+
+	/* Value of a valid position of the rules, or -2 if it is not terminal */
+	static int GetTerminalValue(const BitslicedRules<Size>& rules, int lane, Color nextPlayer);
+
+	const BasicEvaluationTree<Size>& m_eval;
+	int m_maxConnections;
+
+	SocketHandle m_listenSocket;
+	std::string m_path;
+	std::vector<std::unique_ptr<Connection>> m_connections;
+	std::atomic<bool> m_bStop{ false };
+
+	/* Scratch of AnswerBatch, sized once */
+	BitslicedRules<Size> m_rules;
+	QueryProtocol::Request m_requests[LANE_COUNT];
+	int m_values[LANE_COUNT];
+	PackedBoard m_packed[LANE_COUNT];
+	unsigned char m_sideRepetition[LANE_COUNT];
+	signed char m_results[LANE_COUNT];
+	std::vector<Successor> m_successors;
+
+	uint64_t m_requestCount = 0;
+	uint64_t m_batchCount = 0;
+};
+
+/* Blocking client of QueryServer */
+class QueryClient
+{
+public:
+	/* Reply with its moves, the moves are overwritten by the next Receive */
+	struct Reply
+	{
+		uint32_t id = 0;
+		int operation = 0;
+		int value = QueryProtocol::VALUE_INVALID;
+		std::vector<Move> moves;
+		std::vector<int> moveValues;
+	};
+
+	QueryClient() = default;
+	~QueryClient();
+
+	QueryClient(const QueryClient&) = delete;
+	QueryClient& operator=(const QueryClient&) = delete;
+
+	bool Connect(const std::string& path);
+	void Close();
+
+	/* Send requests back to back. False if the connection is lost */
+	bool Send(const QueryProtocol::Request* requests, size_t count);
+
+	/* Wait for the next reply */
+	bool Receive(Reply& reply);
+
+private:
+	/* Read exactly count bytes */
+	bool ReadBytes(unsigned char* bytes, size_t count);
+
+	SocketHandle m_socket = -1;
+	std::vector<unsigned char> m_sendBuffer;
+
+	/* Bytes received but not yet read */
+	std::vector<unsigned char> m_receiveBuffer;
+	size_t m_receiveBegin = 0;
+	size_t m_receiveEnd = 0;
+};
@@ -0,0 +1,126 @@
+#pragma once
+#include <vector>
+#include "Game.h"
+#include "PositionLayout.h"
+
+/* Building blocks of the retrograde solvers (StreamingSolver, PartitionedSolver).
+ * Positions are visited by index and resolved from the values of their successors, the history is ignored.
+ * Index is int for solvers holding their table in memory and int64_t for the ones on disk, see PositionLayout::GetCount */
+template<int Size>
+struct Retrograde
+{
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	/* Same encoding as CachedEvaluation of EvaluationTree, so the tables are interchangeable */
+	static constexpr int ENTRY_UNKNOWN = 0;
+	static constexpr int ENTRY_WHITE_WINS = 1;
+	static constexpr int ENTRY_DRAW = 2;
+	static constexpr int ENTRY_BLACK_WINS = 3;
+
+	static int GetWinEntry(Color color)
+	{
+		return color == Color::White ? ENTRY_WHITE_WINS : ENTRY_BLACK_WINS;
+	}
+
+	/* Build the game state of an index and the indices of its successors in move order.
+	 * False for indices without position, the second repetition, illegal positions and positions with successors outside of the layout */
+	template<class Index>
+	static bool DecodePosition(const PositionLayout<Size>& layout, Index index, GameState& state, std::vector<Index>& successors)
+	{
+		Board board;
+		Color nextPlayer;
+		int repetitionCount;
+		if (!layout.Decode(index, board, nextPlayer, repetitionCount) || repetitionCount != 1)
+		{
+			return false;
+		}
+
+		state = GameState(board, nextPlayer);
+		if (!state.IsValidState())
+		{
+			return false;
+		}
+
+		state.FinalizeGameState();
+		return GetSuccessors(layout, state, successors);
+	}
+
+	/* Indices of the successors of a finalized state in move order.
+	 * False if one is outside of the layout: Such positions satisfy the per piece bounds of the layout but can't be reached from the setup */
+	template<class Index>
+	static bool GetSuccessors(const PositionLayout<Size>& layout, const GameState& state, std::vector<Index>& successors)
+	{
+		Color opponent = state.GetNextPlayer() == Color::White ? Color::Black : Color::White;
+		successors.clear();
+		for (const Move& move : state.GetMoves())
+		{
+			Board child = state.GetBoard();
+			child.SetPiece(move.to, child.GetPiece(move.from));
+			child.SetPiece(move.from, Piece::None);
+
+			int64_t childIndex = layout.Get(child, opponent, 1);
+			if (childIndex < 0)
+			{
+				return false;
+			}
+			successors.push_back(static_cast<Index>(childIndex));
+		}
+
+		return true;
+	}
+
+	/* Entry of a decoded position by rule (mate, stalemate, material), ENTRY_UNKNOWN if the game goes on */
+	static int GetTerminalEntry(const GameState& state)
+	{
+		if (state.IsMate())
+		{
+			return GetWinEntry(state.GetWinner());
+		}
+		return state.IsDraw() ? ENTRY_DRAW : ENTRY_UNKNOWN;
+	}
+
+	/* Entry of an open position from the entries of its successors: Won with one winning move, lost if every move loses.
+	 * ENTRY_UNKNOWN if not decided yet */
+	template<class Index, class GetEntry>
+	static int Resolve(Color player, const Index* firstSuccessor, const Index* lastSuccessor, GetEntry getEntry)
+	{
+		Color opponent = player == Color::White ? Color::Black : Color::White;
+
+		bool bLoss = true;
+		for (const Index* successor = firstSuccessor; successor != lastSuccessor; successor++)
+		{
+			int entry = getEntry(*successor);
+			if (entry == GetWinEntry(player))
+			{
+				return entry;
+			}
+			if (entry != GetWinEntry(opponent))
+			{
+				bLoss = false;
+			}
+		}
+
+		return bLoss ? GetWinEntry(opponent) : ENTRY_UNKNOWN;
+	}
+
+	template<class Index, class GetEntry>
+	static int Resolve(Color player, const std::vector<Index>& successors, GetEntry getEntry)
+	{
+		return Resolve(player, successors.data(), successors.data() + successors.size(), getEntry);
+	}
+
+	/* Side to move of an index. Turn is the digit above repetition */
+	template<class Index>
+	static Color GetNextPlayer(const PositionLayout<Size>& layout, Index index)
+	{
+		return index / layout.GetStride(layout.GetElementCount() - 2) % 2 == 0 ? Color::White : Color::Black;
+	}
+
+	/* Index of the second repetition of a position, it gets the same value. Repetition is the lowest digit */
+	template<class Index>
+	static Index GetSecondRepetition(const PositionLayout<Size>& layout, Index index)
+	{
+		return index + static_cast<Index>(layout.GetStride(layout.GetElementCount() - 1));
+	}
+};
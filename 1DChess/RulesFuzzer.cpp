@@ -0,0 +1,169 @@
+#include "RulesFuzzer.h"
+#include <chrono>
+#include <sstream>
+#include <thread>
+
+RulesFuzzerResult RulesFuzzer::Run(std::ostream& os)
+{
+	int threadCount = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+
+	std::vector<RulesFuzzerResult> results(threadCount);
+	std::vector<std::thread> workers;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		int iterations = m_config.iterations / threadCount + (i < m_config.iterations % threadCount ? 1 : 0);
+		workers.emplace_back(&RulesFuzzer::RunWorker, this, i, iterations, std::ref(results[i]), std::ref(os));
+	}
+
+	RulesFuzzerResult total;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers[i].join();
+		total.positions += results[i].positions;
+		total.mismatches += results[i].mismatches;
+	}
+
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return total;
+}
+
+void RulesFuzzer::RunWorker(int worker, int iterations, RulesFuzzerResult& result, std::ostream& os)
+{
+	std::mt19937_64 rng(m_config.seed + worker);
+
+	for (int iteration = 0; iteration < iterations; iteration++)
+	{
+		/* Every tenth game starts from the starting position, which gives more repetitions and real game traffic */
+		Board board = iteration % 10 == 0 ? Board::GetStartingPosition() : GetRandomBoard(rng);
+		Color nextPlayer = rng() % 2 == 0 ? Color::White : Color::Black;
+
+		GameState state(board, nextPlayer);
+		ReferenceGameState reference(board, nextPlayer);
+
+		/* Validity is part of the rules, too */
+		if (state.IsValidState() != reference.IsValidState())
+		{
+			result.mismatches++;
+			Report("validity", reference, os);
+			continue;
+		}
+
+		if (!reference.IsValidState())
+		{
+			continue;
+		}
+
+		state.FinalizeGameState();
+		reference.FinalizeGameState();
+
+		for (int ply = 0; ply <= m_config.plies; ply++)
+		{
+			result.positions++;
+
+			std::string difference = Compare(state, reference);
+			if (!difference.empty())
+			{
+				result.mismatches++;
+				Report(difference, reference, os);
+				break;
+			}
+
+			if (reference.IsGameOver())
+			{
+				break;
+			}
+
+			const Move& move = reference.GetMoves()[rng() % reference.GetMoves().size()];
+			state.MakeMove(move);
+			state.FinalizeGameState();
+			reference.MakeMove(move);
+			reference.FinalizeGameState();
+		}
+	}
+}
+
+Board RulesFuzzer::GetRandomBoard(std::mt19937_64& rng)
+{
+	Board board;
+
+	/* Kings are always there */
+	static const Piece pieces[] = { Piece::WhiteKing, Piece::BlackKing, Piece::WhiteRook, Piece::WhiteKnight, Piece::BlackRook, Piece::BlackKnight };
+
+	for (Piece piece : pieces)
+	{
+		bool bKing = piece == Piece::WhiteKing || piece == Piece::BlackKing;
+		if (!bKing && rng() % 4 == 0)
+		{
+			/* Taken */
+			continue;
+		}
+
+		/* Any free field */
+		int field;
+		do
+		{
+			field = static_cast<int>(rng() % BOARD_SIZE);
+		} while (!board.IsFree(field));
+
+		board.SetPiece(field, piece);
+	}
+
+	return board;
+}
+
+std::string RulesFuzzer::Compare(const GameState& state, const ReferenceGameState& reference)
+{
+	if (!(state.GetBoard() == reference.GetBoard()) || state.GetNextPlayer() != reference.GetNextPlayer())
+	{
+		return "board";
+	}
+
+	/* Same moves in the same order, the move cache of the solver depends on the order */
+	if (state.GetMoves() != reference.GetMoves())
+	{
+		return "move list";
+	}
+
+	if (state.IsInCheck() != reference.IsInCheck())
+	{
+		return "check flag";
+	}
+
+	if (state.GetRepetitionCount() != reference.GetRepetitionCount())
+	{
+		return "repetition count";
+	}
+
+	if (state.IsMate() != reference.IsMate() || state.IsDraw() != reference.IsDraw() || (reference.IsMate() && state.GetWinner() != reference.GetWinner()))
+	{
+		return "game result";
+	}
+
+	return {};
+}
+
+void RulesFuzzer::Report(const std::string& difference, const ReferenceGameState& reference, std::ostream& os)
+{
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+
+	if (m_reportCount++ >= m_config.maxReports)
+	{
+		return;
+	}
+
+	/* Position in batch notation, including the history so it can be replayed */
+	std::ostringstream line;
+	line << "Mismatch in " << difference << ": " << reference.GetBoard() << (reference.GetNextPlayer() == Color::White ? " w" : " b") << " history:";
+	for (const Board& board : reference.GetHistory())
+	{
+		line << " " << board;
+	}
+	os << line.str() << std::endl;
+}
@@ -0,0 +1,62 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <random>
+#include <string>
+#include <vector>
+#include "Game.h"
+#include "ReferenceRules.h"
+
+struct RulesFuzzerConfig
+{
+	/* Number of random start positions */
+	int iterations = 100000;
+
+	/* Random plies played from every start position */
+	int plies = 40;
+
+	/* 0 = one per hardware thread */
+	int threads = 0;
+
+	unsigned int seed = 1;
+
+	/* Stop reporting after so many mismatches */
+	int maxReports = 10;
+};
+
+struct RulesFuzzerResult
+{
+	uint64_t positions = 0;
+	uint64_t mismatches = 0;
+	double seconds = 0.0;
+};
+
+/* Differential tester: Plays random move sequences from random boards with GameState and the frozen ReferenceGameState
+ * in lockstep and compares move lists, checks, repetition counts and game results after every ply */
+class RulesFuzzer
+{
+public:
+	RulesFuzzer(const RulesFuzzerConfig& config) : m_config(config), m_reportCount(0) {}
+
+	/* Run all iterations on all threads. Mismatches are reported to the stream */
+	RulesFuzzerResult Run(std::ostream& os);
+
+private:
+	/* Iterations of one thread */
+	void RunWorker(int worker, int iterations, RulesFuzzerResult& result, std::ostream& os);
+
+	/* Random board with both kings and a random subset of the other pieces */
+	static Board GetRandomBoard(std::mt19937_64& rng);
+
+	/* Returns description of the first difference, empty if both agree */
+	static std::string Compare(const GameState& state, const ReferenceGameState& reference);
+
+	/* Thread-safe report of a mismatch */
+	void Report(const std::string& difference, const ReferenceGameState& reference, std::ostream& os);
+
+	RulesFuzzerConfig m_config;
+
+	std::mutex m_reportMutex;
+	int m_reportCount;
+};
@@ -0,0 +1,112 @@
+#include "SearchProfile.h"
+#include <algorithm>
+#include <map>
+
+SearchProfile::SearchProfile(int positionCount) : m_visits(positionCount, 0), m_subtreeSizes(positionCount, 0)
+{
+}
+
+void SearchProfile::RecordVisit(int depth, int positionIndex)
+{
+	GetDepth(depth).nodes++;
+	if (positionIndex >= 0 && m_visits[positionIndex] != UINT32_MAX)
+	{
+		m_visits[positionIndex]++;
+	}
+}
+
+void SearchProfile::RecordTerminal(int depth)
+{
+	GetDepth(depth).terminal++;
+}
+
+void SearchProfile::RecordHit(int depth, int positionIndex)
+{
+	GetDepth(depth).hits++;
+	m_savedNodes += GetSubtreeSize(positionIndex);
+}
+
+void SearchProfile::RecordMiss(int depth, size_t moveCount)
+{
+	DepthStats& stats = GetDepth(depth);
+	stats.misses++;
+	stats.branching[std::min<size_t>(moveCount, MAX_BRANCHING)]++;
+}
+
+void SearchProfile::RecordSubtree(int positionIndex, uint64_t size)
+{
+	if (positionIndex >= 0)
+	{
+		m_subtreeSizes[positionIndex] = size;
+	}
+}
+
+uint64_t SearchProfile::GetSubtreeSize(int positionIndex) const
+{
+	return positionIndex >= 0 ? m_subtreeSizes[positionIndex] : 0;
+}
+
+void SearchProfile::WriteCsv(std::ostream& os) const
+{
+	os << "depth,nodes,terminal,hits,misses";
+	for (int i = 0; i <= MAX_BRANCHING; i++)
+	{
+		os << ",branching_" << i;
+	}
+	os << "\n";
+
+	for (size_t depth = 0; depth < m_depths.size(); depth++)
+	{
+		const DepthStats& stats = m_depths[depth];
+		os << depth << "," << stats.nodes << "," << stats.terminal << "," << stats.hits << "," << stats.misses;
+		for (uint64_t count : stats.branching)
+		{
+			os << "," << count;
+		}
+		os << "\n";
+	}
+
+	/* How many positions were visited how often */
+	std::map<uint32_t, uint64_t> revisits;
+	for (uint32_t visits : m_visits)
+	{
+		if (visits > 0)
+		{
+			revisits[visits]++;
+		}
+	}
+
+	os << "\nvisits,positions\n";
+	for (const auto& [visits, positions] : revisits)
+	{
+		os << visits << "," << positions << "\n";
+	}
+}
+
+bool SearchProfile::WriteBinary(std::ostream& os) const
+{
+	const char magic[4] = { '1', 'D', 'C', 'P' };
+	const uint32_t version = 1;
+	uint32_t positionCount = static_cast<uint32_t>(m_visits.size());
+
+	os.write(magic, sizeof(magic));
+	os.write(reinterpret_cast<const char*>(&version), sizeof(version));
+	os.write(reinterpret_cast<const char*>(&positionCount), sizeof(positionCount));
+
+	for (uint32_t i = 0; i < positionCount; i++)
+	{
+		os.write(reinterpret_cast<const char*>(&m_visits[i]), sizeof(m_visits[i]));
+		os.write(reinterpret_cast<const char*>(&m_subtreeSizes[i]), sizeof(m_subtreeSizes[i]));
+	}
+
+	return static_cast<bool>(os);
+}
+
+SearchProfile::DepthStats& SearchProfile::GetDepth(int depth)
+{
+	if (depth >= static_cast<int>(m_depths.size()))
+	{
+		m_depths.resize(depth + 1);
+	}
+	return m_depths[depth];
+}
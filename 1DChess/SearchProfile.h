@@ -0,0 +1,57 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <vector>
+
+/* Profiling data of a depth-first solve, recorded by EvaluationTree when enabled:
+ * - Per depth: nodes, terminal nodes, cache hits and misses (expanded nodes) and a histogram of the branching factor
+ * - Per position index: number of visits and size of the subtree below it when it was solved */
+class SearchProfile
+{
+public:
+	/* Branching factors from this on share the last bucket */
+	static constexpr int MAX_BRANCHING = 16;
+
+	explicit SearchProfile(int positionCount);
+
+	/* Every node, positionIndex -1 for positions without index */
+	void RecordVisit(int depth, int positionIndex);
+	void RecordTerminal(int depth);
+
+	/* Cache hit, counts the subtree of the position as saved */
+	void RecordHit(int depth, int positionIndex);
+
+	/* Node expanded with moveCount moves */
+	void RecordMiss(int depth, size_t moveCount);
+
+	/* Nodes below a solved position, without itself */
+	void RecordSubtree(int positionIndex, uint64_t size);
+	uint64_t GetSubtreeSize(int positionIndex) const;
+
+	/* Nodes not expanded thanks to cache hits, sum of the subtree sizes of all hits */
+	uint64_t GetSavedNodes() const { return m_savedNodes; }
+
+	/* CSV with one line per depth: depth,nodes,terminal,hits,misses,branching_0..branching_MAX.
+	 * Then, after an empty line, the revisit histogram: visits,positions */
+	void WriteCsv(std::ostream& os) const;
+
+	/* Binary dump: "1DCP", uint32 version, uint32 position count, then per position the uint32 visits and the uint64 subtree size */
+	bool WriteBinary(std::ostream& os) const;
+
+private:
+	struct DepthStats
+	{
+		uint64_t nodes = 0;
+		uint64_t terminal = 0;
+		uint64_t hits = 0;
+		uint64_t misses = 0;
+		uint64_t branching[MAX_BRANCHING + 1] = {};
+	};
+
+	DepthStats& GetDepth(int depth);
+
+	std::vector<DepthStats> m_depths;
+	std::vector<uint32_t> m_visits;
+	std::vector<uint64_t> m_subtreeSizes;
+	uint64_t m_savedNodes = 0;
+};
@@ -0,0 +1,183 @@
+#include "SelfPlay.h"
+#include <chrono>
+#include <thread>
+#include <vector>
+
+void SelfPlayResult::Add(const SelfPlayResult& other)
+{
+	games += other.games;
+	plies += other.plies;
+	whiteWins += other.whiteWins;
+	blackWins += other.blackWins;
+	draws += other.draws;
+	aborted += other.aborted;
+}
+
+SelfPlayResult SelfPlay::Run()
+{
+	int threadCount = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+
+	/* Every worker has its own result, merged at the end. No shared state while playing */
+	std::vector<SelfPlayResult> results(threadCount);
+	std::vector<std::thread> workers;
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		/* Distribute remainder over the first workers */
+		int games = m_config.games / threadCount + (i < m_config.games % threadCount ? 1 : 0);
+		workers.emplace_back(&SelfPlay::RunWorker, this, i, games, std::ref(results[i]));
+	}
+
+	SelfPlayResult total;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers[i].join();
+		total.Add(results[i]);
+	}
+
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return total;
+}
+
+void SelfPlay::PrintResult(const SelfPlayResult& result, std::ostream& os)
+{
+	double seconds = result.seconds > 0.0 ? result.seconds : 1e-9;
+
+	os << "Games: " << result.games << " in " << result.seconds << " s" << std::endl;
+	os << "Games/s: " << result.games / seconds << std::endl;
+	os << "Plies/s: " << result.plies / seconds << std::endl;
+	os << "Average plies per game: " << (result.games > 0 ? static_cast<double>(result.plies) / result.games : 0.0) << std::endl;
+	os << "White wins: " << result.whiteWins << std::endl;
+	os << "Black wins: " << result.blackWins << std::endl;
+	os << "Draws: " << result.draws << std::endl;
+	os << "Aborted: " << result.aborted << std::endl;
+}
+
+void SelfPlay::RunWorker(int worker, int games, SelfPlayResult& result) const
+{
+	std::mt19937_64 rng(m_config.seed + worker);
+
+	GameState start;
+	start.FinalizeGameState();
+
+	for (int game = 0; game < games; game++)
+	{
+		GameState state = start;
+
+		/* Random opening to reach random legal positions */
+		for (int ply = 0; ply < m_config.openingPlies && !state.IsGameOver(); ply++)
+		{
+			const std::vector<Move>& moves = state.GetMoves();
+			state.MakeMove(moves[rng() % moves.size()]);
+			state.FinalizeGameState();
+		}
+
+		int ply = 0;
+		while (!state.IsGameOver() && ply < m_config.maxPlies)
+		{
+			int number = ChooseMove(state, rng);
+			state.MakeMove(state.GetMoves()[number]);
+			state.FinalizeGameState();
+			ply++;
+		}
+
+		result.games++;
+		result.plies += ply;
+
+		if (state.IsMate())
+		{
+			if (state.GetWinner() == Color::White)
+			{
+				result.whiteWins++;
+			}
+			else
+			{
+				result.blackWins++;
+			}
+		}
+		else if (state.IsDraw())
+		{
+			result.draws++;
+		}
+		else
+		{
+			result.aborted++;
+		}
+	}
+}
+
+int SelfPlay::ChooseMove(const GameState& state, std::mt19937_64& rng) const
+{
+	PlayPolicy policy = state.GetNextPlayer() == Color::White ? m_config.whitePolicy : m_config.blackPolicy;
+	int moveCount = static_cast<int>(state.GetMoves().size());
+
+	if (policy == PlayPolicy::Mixed)
+	{
+		/* Decide per move */
+		policy = std::uniform_real_distribution<double>(0.0, 1.0)(rng) < m_config.randomMoveRate ? PlayPolicy::Random : PlayPolicy::Perfect;
+	}
+
+	if (policy == PlayPolicy::Perfect)
+	{
+		int number = ChoosePerfectMove(state);
+		if (number >= 0)
+		{
+			return number;
+		}
+	}
+
+	/* Random, or nothing known about the position */
+	return static_cast<int>(rng() % moveCount);
+}
+
+int SelfPlay::ChoosePerfectMove(const GameState& state) const
+{
+	int number = m_eval.GetBestMove(state);
+	if (number >= 0)
+	{
+		return number;
+	}
+
+	/* Position was never expanded by the solver. Look at the successors instead */
+	const std::vector<Move>& moves = state.GetMoves();
+	int sign = state.GetNextPlayer() == Color::White ? 1 : -1;
+	int bestValue = -2;
+	for (int i = 0; i < static_cast<int>(moves.size()); i++)
+	{
+		GameState newState = state;
+		newState.MakeMove(moves[i]);
+		newState.FinalizeGameState();
+
+		int value;
+		if (newState.IsMate())
+		{
+			value = newState.GetWinner() == Color::White ? 1 : -1;
+		}
+		else if (newState.IsDraw())
+		{
+			value = 0;
+		}
+		else
+		{
+			value = m_eval.GetGameStateEvaluation(newState);
+			if (value == -2)
+			{
+				continue;
+			}
+		}
+
+		if (value * sign > bestValue)
+		{
+			bestValue = value * sign;
+			number = i;
+		}
+	}
+
+	return number;
+}
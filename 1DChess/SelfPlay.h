@@ -0,0 +1,77 @@
+#pragma once
+#include <cstdint>
+#include <random>
+#include "EvaluationTree.h"
+
+/* How a side picks its moves */
+enum class PlayPolicy
+{
+	/* Optimal move from the solved cache */
+	Perfect,
+	/* Uniformly random legal move */
+	Random,
+	/* Perfect, but a random move with a configurable rate */
+	Mixed
+};
+
+struct SelfPlayConfig
+{
+	PlayPolicy whitePolicy = PlayPolicy::Perfect;
+	PlayPolicy blackPolicy = PlayPolicy::Perfect;
+
+	/* Rate of random moves for the mixed policy */
+	double randomMoveRate = 0.2;
+
+	int games = 10000;
+
+	/* 0 = one per hardware thread */
+	int threads = 0;
+
+	/* Random plies played from the starting position before a game starts, to get random legal positions */
+	int openingPlies = 0;
+
+	/* Games running longer are aborted */
+	int maxPlies = 1000;
+
+	unsigned int seed = 1;
+};
+
+struct SelfPlayResult
+{
+	uint64_t games = 0;
+	uint64_t plies = 0;
+	uint64_t whiteWins = 0;
+	uint64_t blackWins = 0;
+	uint64_t draws = 0;
+	uint64_t aborted = 0;
+	double seconds = 0.0;
+
+	/* Sum up worker results */
+	void Add(const SelfPlayResult& other);
+};
+
+/* Plays many complete games in parallel against the solved cache, to stress move generation and lookups */
+class SelfPlay
+{
+public:
+	SelfPlay(const EvaluationTree& eval, const SelfPlayConfig& config) : m_eval(eval), m_config(config) {}
+
+	/* Play all games on all threads */
+	SelfPlayResult Run();
+
+	/* Print throughput and result distribution */
+	static void PrintResult(const SelfPlayResult& result, std::ostream& os);
+
+private:
+	/* Play games of one thread */
+	void RunWorker(int worker, int games, SelfPlayResult& result) const;
+
+	/* Pick the number of the next move according to the policy of the side to move */
+	int ChooseMove(const GameState& state, std::mt19937_64& rng) const;
+
+	/* Best move from cache, falls back to successor evaluations for positions without move entry. -1 if nothing known */
+	int ChoosePerfectMove(const GameState& state) const;
+
+	const EvaluationTree& m_eval;
+	SelfPlayConfig m_config;
+};
@@ -0,0 +1,208 @@
+#include "ServerModes.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <fstream>
+#include <iostream>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "CommandLine.h"
+#include "QueryServer.h"
+
+namespace
+{
+	/* Set by SIGINT and SIGTERM, ends the server */
+	std::atomic<bool> gbServerStop{ false };
+
+	void stopServer(int)
+	{
+		gbServerStop.store(true);
+	}
+
+	/* Board of any supported size in the encoding of BasicBoard::Pack. False if the text is no board */
+	bool packBoard(const std::string& text, uint64_t& packed)
+	{
+		switch (text.size())
+		{
+		case 8:
+		{
+			BasicBoard<8> board;
+			packed = BasicBoard<8>::FromString(text, board) ? board.Pack() : 0;
+			return packed != 0;
+		}
+		case 10:
+		{
+			BasicBoard<10> board;
+			packed = BasicBoard<10>::FromString(text, board) ? board.Pack() : 0;
+			return packed != 0;
+		}
+		case 12:
+		{
+			BasicBoard<12> board;
+			packed = BasicBoard<12>::FromString(text, board) ? board.Pack() : 0;
+			return packed != 0;
+		}
+		default:
+			return false;
+		}
+	}
+}
+
+/* Server mode for one board size */
+template<int Size>
+int runServeOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	BasicEvaluationTree<Size> eval(board);
+	if (!prepareTree(eval, board, setup, argc, argv))
+	{
+		return 1;
+	}
+
+	const char* socketPath = findOption(argc, argv, "socket");
+	std::string path = socketPath != nullptr ? socketPath : "1dchess.sock";
+
+	QueryServer<Size> server(eval, getIntOption(argc, argv, "connections", 64));
+	if (!server.Listen(path))
+	{
+		std::cerr << "Could not listen on " << path << std::endl;
+		return 1;
+	}
+
+	/* The signal only sets a flag, this thread hands it to the server */
+	std::signal(SIGINT, stopServer);
+	std::signal(SIGTERM, stopServer);
+	double seconds = getDoubleOption(argc, argv, "seconds", 0.0);
+	auto start = std::chrono::steady_clock::now();
+	std::thread watcher([&]()
+	{
+		while (!gbServerStop.load() && (seconds <= 0.0 || std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() < seconds))
+		{
+			std::this_thread::sleep_for(std::chrono::milliseconds(50));
+		}
+		server.Stop();
+	});
+
+	server.Run(&std::cout);
+	watcher.join();
+
+	return 0;
+}
+
+int runServe(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runServeOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+int runQuery(int argc, char* argv[])
+{
+	const char* socketPath = findOption(argc, argv, "socket");
+	std::string path = socketPath != nullptr ? socketPath : "1dchess.sock";
+
+	const char* operationName = findOption(argc, argv, "op");
+	std::string_view operation = operationName != nullptr ? operationName : "value";
+	QueryProtocol::Request request;
+	request.operation = operation == "best" ? QueryProtocol::BestMove : (operation == "moves" ? QueryProtocol::Moves : QueryProtocol::Value);
+
+	std::ifstream file;
+	if (argc > 2 && std::string_view(argv[2]).find('=') == std::string_view::npos)
+	{
+		file.open(argv[2]);
+		if (!file)
+		{
+			std::cerr << "Could not open " << argv[2] << std::endl;
+			return 1;
+		}
+	}
+	std::istream& input = file.is_open() ? static_cast<std::istream&>(file) : std::cin;
+
+	/* Lines that are no position are sent anyway, with a board the server rejects */
+	std::vector<QueryProtocol::Request> requests;
+	std::string line;
+	while (std::getline(input, line))
+	{
+		std::istringstream tokens(line);
+		std::string board, side;
+		int repetitionCount = 1;
+		tokens >> board >> side;
+		if (!(tokens >> repetitionCount))
+		{
+			repetitionCount = 1;
+		}
+
+		request.id = static_cast<uint32_t>(requests.size());
+		request.nextPlayer = side == "b" ? Color::Black : Color::White;
+		request.repetitionCount = repetitionCount;
+		if (!packBoard(board, request.board) || (side != "w" && side != "b"))
+		{
+			request.board = ~uint64_t(0);
+		}
+		requests.push_back(request);
+	}
+
+	QueryClient client;
+	if (!client.Connect(path))
+	{
+		std::cerr << "Could not connect to " << path << std::endl;
+		return 1;
+	}
+
+	/* Requests in flight before the first reply is read */
+	size_t pipeline = static_cast<size_t>(std::max(getIntOption(argc, argv, "pipeline", 256), 1));
+
+	auto start = std::chrono::steady_clock::now();
+	std::string output;
+	QueryClient::Reply reply;
+	for (size_t offset = 0; offset < requests.size(); offset += pipeline)
+	{
+		size_t count = std::min(pipeline, requests.size() - offset);
+		if (!client.Send(requests.data() + offset, count))
+		{
+			std::cerr << "Connection lost" << std::endl;
+			return 1;
+		}
+
+		for (size_t i = 0; i < count; i++)
+		{
+			if (!client.Receive(reply))
+			{
+				std::cerr << "Connection lost" << std::endl;
+				return 1;
+			}
+
+			std::ostringstream text;
+			text << (reply.value == QueryProtocol::VALUE_INVALID ? "invalid" : gEvalTable[reply.value + 2]);
+			if (reply.operation == QueryProtocol::BestMove && reply.moves.empty() && reply.value != QueryProtocol::VALUE_INVALID)
+			{
+				text << " -";
+			}
+			for (size_t move = 0; move < reply.moves.size(); move++)
+			{
+				text << ' ' << reply.moves[move];
+				if (reply.operation == QueryProtocol::Moves)
+				{
+					text << '=' << gEvalTable[reply.moveValues[move] + 2];
+				}
+			}
+			output += text.str();
+			output += '\n';
+		}
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	std::cout << output;
+	std::cerr << "Requests: " << requests.size() << " in " << seconds << " s, " << requests.size() / std::max(seconds, 1e-9) << " requests/s" << std::endl;
+
+	return 0;
+}
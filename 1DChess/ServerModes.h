@@ -0,0 +1,9 @@
+#pragma once
+
+/* Query server and its client, see QueryServer. Arguments as given to main, options are "key=value" */
+
+/* Server mode: Load or solve the table once, then answer queries of other processes on a Unix domain socket */
+int runServe(int argc, char* argv[]);
+
+/* Query mode: Send the positions of a file (or stdin) in batch notation to a server, pipelined, and print the replies */
+int runQuery(int argc, char* argv[]);
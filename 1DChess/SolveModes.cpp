@@ -0,0 +1,412 @@
+#include "SolveModes.h"
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+#include "ChildProcess.h"
+#include "CommandLine.h"
+#include "FrontierSolver.h"
+#include "PartitionedSolver.h"
+#include "StreamingSolver.h"
+#include "TableVerifier.h"
+#include "TranspositionTable.h"
+#include "VariantSolver.h"
+
+int runVariants(int argc, char* argv[])
+{
+	std::vector<std::string> setups;
+
+	/* Arguments without "=" are setups */
+	for (int i = 2; i < argc; i++)
+	{
+		if (std::string_view(argv[i]).find('=') == std::string_view::npos)
+		{
+			setups.push_back(argv[i]);
+		}
+	}
+
+	if (const char* path = findOption(argc, argv, "file"))
+	{
+		std::ifstream file(path);
+		if (!file)
+		{
+			std::cerr << "Could not open " << path << std::endl;
+			return 1;
+		}
+
+		std::string line;
+		while (std::getline(file, line))
+		{
+			if (!line.empty() && line.back() == '\r')
+			{
+				line.pop_back();
+			}
+			if (!line.empty())
+			{
+				setups.push_back(line);
+			}
+		}
+	}
+
+	if (setups.empty())
+	{
+		setups.push_back(std::string(STARTING_SETUP));
+	}
+
+	const char* outputDirectory = findOption(argc, argv, "out");
+	VariantSolver solver(setups, getIntOption(argc, argv, "threads", 0), outputDirectory != nullptr ? outputDirectory : "");
+	return VariantSolver::PrintSummary(solver.Run(), std::cout) ? 0 : 1;
+}
+
+int runProfile(int argc, char* argv[])
+{
+	GameState state;
+	state.FinalizeGameState();
+
+	EvaluationTree eval;
+	eval.SetVerbose(false);
+	eval.EnableProfile();
+	eval.SetMoveOrdering(getIntOption(argc, argv, "order", 0) != 0);
+
+	auto start = std::chrono::steady_clock::now();
+	int value = eval.Evaluate(state);
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	const SearchProfile& profile = *eval.GetProfile();
+	std::cerr << "Value: " << value << ", nodes: " << eval.Root->CountRecursive() << ", saved by cache: " << profile.GetSavedNodes() << ", " << seconds << " s" << std::endl;
+
+	if (const char* path = findOption(argc, argv, "csv"))
+	{
+		std::ofstream file(path);
+		profile.WriteCsv(file);
+	}
+	else
+	{
+		profile.WriteCsv(std::cout);
+	}
+
+	if (const char* path = findOption(argc, argv, "bin"))
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!profile.WriteBinary(file))
+		{
+			std::cerr << "Could not write " << path << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+/* Streaming mode for one board size */
+template<int Size>
+int runStreamOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	StreamingSolverConfig config;
+	const char* directory = findOption(argc, argv, "dir");
+	config.directory = directory != nullptr ? directory : config.directory;
+	config.chunkPositions = getIntOption(argc, argv, "chunk", static_cast<int>(config.chunkPositions));
+	config.memoryBytes = static_cast<size_t>(getIntOption(argc, argv, "memory", static_cast<int>(config.memoryBytes >> 20))) << 20;
+	config.bucketBufferBytes = static_cast<size_t>(std::max(1, getIntOption(argc, argv, "buffer", static_cast<int>(config.bucketBufferBytes >> 10)))) << 10;
+
+	StreamingSolver<Size> solver(board, config);
+	if (!solver.IsValidSetup())
+	{
+		std::cerr << "Setup can't be indexed: " << setup << std::endl;
+		return 1;
+	}
+
+	int value = solver.Run();
+	if (value == -2)
+	{
+		std::cerr << "I/O error in " << config.directory << std::endl;
+		return 1;
+	}
+
+	std::cout << setup << ": " << (value == 1 ? "White wins" : value == -1 ? "Black wins" : "Draw") << std::endl;
+	solver.PrintStats(std::cout);
+
+	if (const char* path = findOption(argc, argv, "out"))
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file || !solver.ExportTable(file))
+		{
+			std::cerr << "Could not write " << path << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int runStream(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runStreamOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Frontier mode for one board size */
+template<int Size>
+int runFrontierOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	const char* order = findOption(argc, argv, "order");
+	FrontierSolver<Size> solver(board, order != nullptr && std::string_view(order) == "locality" ? LayoutOrder::Locality : LayoutOrder::Setup);
+	solver.SetPrefetch(getIntOption(argc, argv, "prefetch", 0) != 0);
+	if (!solver.IsValidSetup())
+	{
+		std::cerr << "Setup can't be indexed: " << setup << std::endl;
+		return 1;
+	}
+
+	int value = solver.Run();
+	if (value == -2)
+	{
+		std::cerr << "Setup is no legal position: " << setup << std::endl;
+		return 1;
+	}
+
+	std::cout << setup << ": " << (value == 1 ? "White wins" : value == -1 ? "Black wins" : "Draw") << std::endl;
+	solver.PrintStats(std::cout);
+
+	if (const char* path = findOption(argc, argv, "out"))
+	{
+		std::ofstream file(path, std::ios::binary);
+		if (!file || !solver.ExportTable(file))
+		{
+			std::cerr << "Could not write " << path << std::endl;
+			return 1;
+		}
+	}
+
+	return 0;
+}
+
+int runFrontier(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runFrontierOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Hashed mode for one board size: Solve with a shared transposition table instead of the index cache */
+template<int Size>
+int runHashedOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	TranspositionTableConfig config;
+	config.memoryBytes = static_cast<size_t>(std::max(1, getIntOption(argc, argv, "memory", static_cast<int>(config.memoryBytes >> 20)))) << 20;
+	const char* replacement = findOption(argc, argv, "replace");
+	if (replacement != nullptr && std::string_view(replacement) == "always")
+	{
+		config.replacement = ReplacementPolicy::AlwaysReplace;
+	}
+	std::shared_ptr<TranspositionTable> table = std::make_shared<TranspositionTable>(config);
+
+	/* Every thread solves the whole game, half of them with move ordering, so they reach positions in different order */
+	int threadCount = std::max(1, getIntOption(argc, argv, "threads", 1));
+	std::vector<int> values(threadCount, -2);
+	std::vector<std::thread> workers;
+
+	auto start = std::chrono::steady_clock::now();
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back([&, i]()
+		{
+			BasicEvaluationTree<Size> eval(board);
+			eval.SetVerbose(false);
+			eval.SetMoveOrdering(i % 2 == 1);
+			eval.SetTranspositionTable(table, true);
+
+			BasicGameState<Size> state(board, Color::White);
+			state.FinalizeGameState();
+			values[i] = eval.Evaluate(state);
+		});
+	}
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+	double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		std::cout << "Thread " << i << ": " << values[i] << std::endl;
+	}
+	std::cout << "Table: " << (table->GetMemoryBytes() >> 20) << " MB, " << table->GetCapacity() << " entries, occupancy " << table->GetOccupancy() << std::endl;
+	std::cout << "Time: " << seconds << " s" << std::endl;
+
+	/* Reference solve with the index cache */
+	if (getIntOption(argc, argv, "compare", 0) != 0)
+	{
+		BasicEvaluationTree<Size> eval(board);
+		eval.SetVerbose(false);
+		BasicGameState<Size> state(board, Color::White);
+		state.FinalizeGameState();
+		int value = eval.Evaluate(state);
+		std::cout << "Indexed: " << value << std::endl;
+		return std::count(values.begin(), values.end(), value) == threadCount ? 0 : 1;
+	}
+
+	return 0;
+}
+
+int runHashed(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runHashedOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Verify mode for one board size */
+template<int Size>
+int runVerifyOfSize(const std::string& setup, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	BasicEvaluationTree<Size> eval(board);
+	if (!prepareTree(eval, board, setup, argc, argv))
+	{
+		return 1;
+	}
+
+	TableVerifierConfig config;
+	config.threads = getIntOption(argc, argv, "threads", config.threads);
+	config.maxReports = getIntOption(argc, argv, "max", config.maxReports);
+
+	TableVerifier<Size> verifier(eval, config);
+	TableVerifierResult result = verifier.Run(std::cout);
+
+	std::cout << "Checked positions: " << result.positions << " in " << result.seconds << " s" << std::endl;
+	std::cout << "Unknown: " << result.unknown << std::endl;
+	std::cout << "Unverifiable: " << result.unverifiable << std::endl;
+	std::cout << "Terminal mismatches: " << result.terminalMismatches << std::endl;
+	std::cout << "Value mismatches: " << result.valueMismatches << std::endl;
+
+	return result.terminalMismatches + result.valueMismatches == 0 ? 0 : 1;
+}
+
+int runVerify(int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runVerifyOfSize<decltype(size)::value>(setup, argc, argv); });
+}
+
+/* Partition mode for one board size. Workers solve their slice, the coordinator starts them as processes and merges */
+template<int Size>
+int runPartitionOfSize(const std::string& setup, bool bWorker, int argc, char* argv[])
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		std::cerr << "Invalid setup " << setup << std::endl;
+		return 1;
+	}
+
+	PartitionConfig config;
+	const char* directory = findOption(argc, argv, "dir");
+	const char* runId = findOption(argc, argv, "run");
+	config.directory = directory != nullptr ? directory : config.directory;
+	config.runId = runId != nullptr ? runId : std::to_string(std::chrono::steady_clock::now().time_since_epoch().count());
+	config.parts = std::max(1, getIntOption(argc, argv, "parts", config.parts));
+	config.part = getIntOption(argc, argv, "part", config.part);
+	config.timeoutSeconds = getIntOption(argc, argv, "timeout", config.timeoutSeconds);
+
+	PartitionedSolver<Size> solver(board, config);
+	if (!solver.IsValidSetup())
+	{
+		std::cerr << "Setup can't be indexed: " << setup << std::endl;
+		return 1;
+	}
+
+	if (bWorker)
+	{
+		return solver.RunWorker() ? 0 : 1;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	/* One process per part, started with this executable. Arguments are passed as they are, no shell quoting */
+	std::vector<ChildProcess> workers(config.parts);
+	bool bFailed = false;
+	for (int part = 0; part < config.parts; part++)
+	{
+		std::vector<std::string> arguments = { argv[0], "--partition-worker", setup, "parts=" + std::to_string(config.parts),
+			"part=" + std::to_string(part), "dir=" + config.directory, "run=" + config.runId, "timeout=" + std::to_string(config.timeoutSeconds) };
+		if (!workers[part].Start(arguments))
+		{
+			/* The others give up after the timeout */
+			std::cerr << "Could not start part " << part << std::endl;
+			bFailed = true;
+		}
+	}
+
+	for (int part = 0; part < config.parts; part++)
+	{
+		if (workers[part].Wait() != 0)
+		{
+			std::cerr << "Part " << part << " failed" << std::endl;
+			bFailed = true;
+		}
+	}
+
+	if (bFailed)
+	{
+		return 1;
+	}
+
+	const char* path = findOption(argc, argv, "out");
+	std::ofstream file;
+	std::ostringstream discard;
+	if (path != nullptr)
+	{
+		file.open(path, std::ios::binary);
+	}
+
+	int value = solver.MergeTable(path != nullptr ? static_cast<std::ostream&>(file) : discard);
+	if (value == -2)
+	{
+		std::cerr << "Could not merge the parts" << std::endl;
+		return 1;
+	}
+
+	std::cout << setup << ": " << (value == 1 ? "White wins" : value == -1 ? "Black wins" : "Draw") << std::endl;
+	std::cout << "Parts: " << config.parts << std::endl;
+	std::cout << "Time: " << std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count() << " s" << std::endl;
+
+	return 0;
+}
+
+int runPartition(bool bWorker, int argc, char* argv[])
+{
+	std::string setup = getSetupArgument(argc, argv);
+	return dispatchBySize(setup, [&](auto size) { return runPartitionOfSize<decltype(size)::value>(setup, bWorker, argc, argv); });
+}
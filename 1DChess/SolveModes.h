@@ -0,0 +1,24 @@
+#pragma once
+
+/* Modes solving whole setups: in parallel, profiled, on disk, breadth-first, hashed, verified and partitioned over processes. Arguments as given to main, options are "key=value" */
+
+/* Variant mode: Solve setups given as arguments or in a file (one per line) in parallel */
+int runVariants(int argc, char* argv[]);
+
+/* Profile mode: Solve with a SearchProfile and dump it */
+int runProfile(int argc, char* argv[]);
+
+/* Streaming mode: Solve one setup with the table on disk */
+int runStream(int argc, char* argv[]);
+
+/* Frontier mode: Solve one setup breadth-first without recursion */
+int runFrontier(int argc, char* argv[]);
+
+/* Hashed mode: Solve one setup with a transposition table shared by several solver threads */
+int runHashed(int argc, char* argv[]);
+
+/* Verify mode: Check a table file, or a fresh solve, against the rules */
+int runVerify(int argc, char* argv[]);
+
+/* Partition mode: Solve one setup with several processes. With bWorker this process is one of them, started by the coordinator */
+int runPartition(bool bWorker, int argc, char* argv[]);
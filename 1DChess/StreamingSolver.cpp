@@ -0,0 +1,347 @@
+#include "StreamingSolver.h"
+#include <algorithm>
+#include <chrono>
+#include <climits>
+#include <cstdio>
+#include <sstream>
+#include "EvaluationTree.h"
+#include "PositionIterator.h"
+
+template<int Size>
+StreamingSolver<Size>::StreamingSolver(const Board& setup, const StreamingSolverConfig& config) : m_setup(setup), m_config(config)
+{
+	std::ostringstream setupText;
+	setupText << setup;
+	m_layout = PositionLayout<Size>::FromSetup(setupText.str());
+
+	std::string name = setupText.str();
+	std::replace(name.begin(), name.end(), '.', '_');
+	m_basePath = m_config.directory + "/" + name;
+	m_path = GetScratchPath(".chunks");
+}
+
+template<int Size>
+StreamingSolver<Size>::~StreamingSolver()
+{
+	/* The chunk and count files are scratch, the result is exported as table. Buckets remove their files themselves */
+	if (m_table.GetEntryCount() > 0)
+	{
+		m_table.Flush();
+		std::remove(m_path.c_str());
+	}
+	if (m_countFile.is_open())
+	{
+		m_countFile.close();
+		std::remove(GetScratchPath(".counts").c_str());
+	}
+}
+
+template<int Size>
+int StreamingSolver<Size>::Run()
+{
+	if (!IsValidSetup())
+	{
+		return -2;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	/* Chunks are whole bytes */
+	int64_t chunkPositions = std::max<int64_t>(4, m_config.chunkPositions / 4 * 4);
+	size_t chunkCount = static_cast<size_t>((m_layout.GetCount() + chunkPositions - 1) / chunkPositions);
+
+	/* Edge and value buffers of every chunk come out of the memory budget, the rest holds chunks */
+	size_t bufferBytes = std::min(m_config.bucketBufferBytes, m_config.memoryBytes / 2 / (2 * chunkCount + 2));
+	size_t edgeRecords = std::max<size_t>(1, bufferBytes / (2 * sizeof(uint64_t)));
+	size_t valueRecords = std::max<size_t>(1, bufferBytes / sizeof(uint64_t));
+	size_t allBufferBytes = (chunkCount + 1) * (edgeRecords * 2 + valueRecords) * sizeof(uint64_t);
+	size_t chunkMemory = m_config.memoryBytes - std::min(m_config.memoryBytes, allBufferBytes);
+	size_t residentChunks = std::max<size_t>(1, chunkMemory / static_cast<size_t>(chunkPositions / 4));
+	if (!m_table.Create(m_path, m_layout.GetCount(), chunkPositions, residentChunks))
+	{
+		return -2;
+	}
+
+	m_openPositions.assign(chunkCount, 0);
+	m_unsentPositions.assign(chunkCount, 0);
+
+	m_countFile.open(GetScratchPath(".counts"), std::ios::in | std::ios::out | std::ios::binary | std::ios::trunc);
+	if (!m_countFile)
+	{
+		return -2;
+	}
+	if (!m_edges.Create(GetScratchPath(".edges"), chunkCount, 2, edgeRecords) || !m_values.Create(GetScratchPath(".values"), chunkCount, 1, valueRecords))
+	{
+		return -2;
+	}
+
+	InitializePass();
+
+	while (HasPendingWork() && IsGood())
+	{
+		int64_t resolved = PropagationPass();
+		if (m_config.bVerbose)
+		{
+			std::cout << "Pass " << m_passes << ": " << resolved << " positions resolved" << std::endl;
+		}
+	}
+
+	if (IsGood())
+	{
+		FinalizePass();
+	}
+
+	m_seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!m_table.Flush() || !IsGood())
+	{
+		return -2;
+	}
+
+	switch (m_table.Get(m_layout.Get(m_setup, Color::White, 1)))
+	{
+	case Rules::ENTRY_WHITE_WINS:
+		return 1;
+	case Rules::ENTRY_BLACK_WINS:
+		return -1;
+	case Rules::ENTRY_DRAW:
+		return 0;
+	default:
+		return -2;
+	}
+}
+
+template<int Size>
+bool StreamingSolver<Size>::ExportTable(std::ostream& os)
+{
+	return BasicEvaluationTree<Size>::WriteTableHeader(os, m_setup, m_layout.GetCount()) && m_table.CopyTo(os);
+}
+
+template<int Size>
+void StreamingSolver<Size>::PrintStats(std::ostream& os) const
+{
+	int64_t chunkCount = std::max<int64_t>(1, m_table.GetChunkCount());
+	double loadsPerChunk = static_cast<double>(m_table.GetChunkLoads()) / chunkCount;
+
+	os << "Positions: " << m_positions << std::endl;
+	os << "Passes: " << m_passes << std::endl;
+	os << "Chunks: " << m_table.GetChunkCount() << " of " << m_table.GetChunkEntries() << " positions" << std::endl;
+	os << "Chunk loads: " << m_table.GetChunkLoads() << ", " << loadsPerChunk << " per chunk, " << loadsPerChunk / std::max(1, m_passes) << " per chunk and pass" << std::endl;
+	os << "Read: " << m_table.GetBytesRead() / 1024 << " KB, written: " << m_table.GetBytesWritten() / 1024 << " KB" << std::endl;
+	os << "Memory: " << m_table.GetResidentChunks() * m_table.GetChunkEntries() / 4 / 1024 << " KB resident chunks, "
+		<< (m_edges.GetBufferBytes() + m_values.GetBufferBytes()) / 1024 << " KB bucket buffers" << std::endl;
+	os << "Buckets read: " << m_edges.GetBytesRead() / 1024 + m_values.GetBytesRead() / 1024 << " KB, written: " << m_edges.GetBytesWritten() / 1024 + m_values.GetBytesWritten() / 1024 << " KB" << std::endl;
+	os << "Move counts read: " << m_countBytesRead / 1024 << " KB, written: " << m_countBytesWritten / 1024 << " KB" << std::endl;
+	os << "Time: " << m_seconds << " s" << std::endl;
+}
+
+template<int Size>
+void StreamingSolver<Size>::InitializePass()
+{
+	/* Move counts are stored in a byte: A piece has at most Size - 1 target fields */
+	static_assert(Size * (Size - 1) <= UCHAR_MAX, "Move counts must fit into a byte");
+
+	std::vector<int64_t> successors;
+	int64_t chunkPositions = m_table.GetChunkEntries();
+
+	for (int64_t chunk = 0; chunk < m_table.GetChunkCount(); chunk++)
+	{
+		int64_t begin = chunk * chunkPositions;
+		int64_t end = std::min(m_table.GetEntryCount(), (chunk + 1) * chunkPositions);
+		m_counts.assign(static_cast<size_t>((end - begin) / 2), 0);
+
+		for (PositionIterator<Size> position(m_layout, begin, end); position.Next();)
+		{
+			GameState& state = position.GetState();
+			if (position.GetRepetitionCount() != 1)
+			{
+				continue;
+			}
+
+			state.FinalizeGameState();
+			if (!Rules::GetSuccessors(m_layout, state, successors))
+			{
+				continue;
+			}
+
+			m_positions++;
+			int64_t index = position.GetIndex();
+			int entry = Rules::GetTerminalEntry(state);
+			if (entry != Rules::ENTRY_UNKNOWN)
+			{
+				SetValue(index, entry);
+				m_unsentPositions[chunk] += entry != Rules::ENTRY_DRAW ? 1 : 0;
+				continue;
+			}
+
+			m_counts[static_cast<size_t>((index - begin) / 2)] = static_cast<unsigned char>(successors.size());
+			m_openPositions[chunk]++;
+			for (int64_t successor : successors)
+			{
+				uint64_t edge[2] = { static_cast<uint64_t>(successor), static_cast<uint64_t>(index) };
+				m_edges.Append(static_cast<size_t>(successor / chunkPositions), edge);
+			}
+		}
+
+		StoreCounts(chunk);
+	}
+
+	m_passes++;
+}
+
+template<int Size>
+int64_t StreamingSolver<Size>::PropagationPass()
+{
+	int64_t chunkPositions = m_table.GetChunkEntries();
+	int64_t resolved = 0;
+
+	for (int64_t chunk = 0; chunk < m_table.GetChunkCount() && IsGood(); chunk++)
+	{
+		size_t bucket = static_cast<size_t>(chunk);
+
+		/* Values sent to this chunk, from earlier chunks of this pass and later ones of the last pass */
+		if (m_values.GetRecordCount(bucket) > 0 && LoadCounts(chunk))
+		{
+			m_values.Drain(bucket, [&](const uint64_t* value)
+			{
+				resolved += ApplyValue(chunk, static_cast<int64_t>(*value / 4), static_cast<int>(*value % 4)) ? 1 : 0;
+			});
+			StoreCounts(chunk);
+		}
+
+		/* Values of the decided successors in this chunk to their positions. Draws decide nothing, their edges are dropped */
+		if (m_unsentPositions[chunk] > 0)
+		{
+			m_unsentPositions[chunk] = 0;
+			m_edges.Drain(bucket, [&](const uint64_t* edge)
+			{
+				int entry = m_table.Get(static_cast<int64_t>(edge[0]));
+				if (entry == Rules::ENTRY_UNKNOWN)
+				{
+					m_edges.Append(bucket, edge);
+				}
+				else if (entry != Rules::ENTRY_DRAW)
+				{
+					uint64_t value = edge[1] * 4 + static_cast<uint64_t>(entry);
+					m_values.Append(static_cast<size_t>(edge[1] / static_cast<uint64_t>(chunkPositions)), &value);
+				}
+			});
+		}
+	}
+
+	m_passes++;
+	return resolved;
+}
+
+template<int Size>
+bool StreamingSolver<Size>::HasPendingWork() const
+{
+	for (size_t chunk = 0; chunk < m_unsentPositions.size(); chunk++)
+	{
+		if (m_unsentPositions[chunk] > 0 || m_values.GetRecordCount(chunk) > 0)
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+template<int Size>
+bool StreamingSolver<Size>::ApplyValue(int64_t chunk, int64_t index, int value)
+{
+	if (m_table.Get(index) != Rules::ENTRY_UNKNOWN)
+	{
+		return false;
+	}
+
+	/* One winning move decides, a losing one only when it was the last move not known to lose */
+	if (value != Rules::GetWinEntry(Rules::GetNextPlayer(m_layout, index)))
+	{
+		unsigned char& count = m_counts[static_cast<size_t>((index - chunk * m_table.GetChunkEntries()) / 2)];
+		if (count == 0 || --count > 0)
+		{
+			return false;
+		}
+	}
+
+	SetValue(index, value);
+	m_openPositions[chunk]--;
+	m_unsentPositions[chunk]++;
+	return true;
+}
+
+template<int Size>
+void StreamingSolver<Size>::FinalizePass()
+{
+	int64_t chunkPositions = m_table.GetChunkEntries();
+
+	for (int64_t chunk = 0; chunk < m_table.GetChunkCount(); chunk++)
+	{
+		if (m_openPositions[chunk] == 0 || !LoadCounts(chunk))
+		{
+			continue;
+		}
+
+		/* Open positions have moves left, decided ones a value */
+		int64_t begin = chunk * chunkPositions;
+		for (size_t i = 0; i < m_counts.size(); i++)
+		{
+			int64_t index = begin + static_cast<int64_t>(i) * 2;
+			if (m_counts[i] > 0 && m_table.Get(index) == Rules::ENTRY_UNKNOWN)
+			{
+				SetValue(index, Rules::ENTRY_DRAW);
+			}
+		}
+		m_openPositions[chunk] = 0;
+	}
+
+	m_passes++;
+}
+
+template<int Size>
+void StreamingSolver<Size>::SetValue(int64_t index, int value)
+{
+	m_table.Set(index, value);
+	m_table.Set(Rules::GetSecondRepetition(m_layout, index), value);
+}
+
+template<int Size>
+bool StreamingSolver<Size>::LoadCounts(int64_t chunk)
+{
+	int64_t chunkPositions = m_table.GetChunkEntries();
+	int64_t positions = std::min(m_table.GetEntryCount() - chunk * chunkPositions, chunkPositions);
+
+	m_counts.resize(static_cast<size_t>(positions / 2));
+	m_countFile.seekg(chunk * (chunkPositions / 2));
+	m_countFile.read(reinterpret_cast<char*>(m_counts.data()), m_counts.size());
+	m_countBytesRead += m_counts.size();
+
+	return static_cast<bool>(m_countFile);
+}
+
+template<int Size>
+bool StreamingSolver<Size>::StoreCounts(int64_t chunk)
+{
+	m_countFile.seekp(chunk * (m_table.GetChunkEntries() / 2));
+	m_countFile.write(reinterpret_cast<const char*>(m_counts.data()), m_counts.size());
+	m_countBytesWritten += m_counts.size();
+
+	return static_cast<bool>(m_countFile);
+}
+
+template<int Size>
+bool StreamingSolver<Size>::IsGood() const
+{
+	return m_table.IsGood() && m_edges.IsGood() && m_values.IsGood() && static_cast<bool>(m_countFile);
+}
+
+template<int Size>
+std::string StreamingSolver<Size>::GetScratchPath(const char* extension) const
+{
+	return m_basePath + extension;
+}
+
+/* Supported board sizes */
+template class StreamingSolver<8>;
+template class StreamingSolver<10>;
+template class StreamingSolver<12>;
@@ -0,0 +1,121 @@
+#pragma once
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <vector>
+#include "BucketStore.h"
+#include "ChunkedTable.h"
+#include "Game.h"
+#include "PositionLayout.h"
+#include "Retrograde.h"
+
+struct StreamingSolverConfig
+{
+	/* Directory for the chunk file */
+	std::string directory = ".";
+
+	/* Positions per chunk */
+	int64_t chunkPositions = 1 << 20;
+
+	/* Memory for resident chunks and bucket buffers in bytes */
+	size_t memoryBytes = 64 << 20;
+
+	/* Write buffer of every bucket in bytes at most, see BucketStore. There are two buckets per chunk,
+	 * their buffers are shrunk to take at most half of memoryBytes (but hold at least one record) */
+	size_t bucketBufferBytes = 64 << 10;
+
+	/* Print progress per pass */
+	bool bVerbose = true;
+};
+
+/* Solver with the position table on disk, for variants whose table doesn't fit into memory.
+ * Instead of the depth-first search of EvaluationTree it solves retrograde-style, touching only one chunk at a time:
+ * - The first pass marks mates and draws by rule. For every open position it stores the number of moves (one byte per
+ *   position in a second file) and an edge (successor, position) in the bucket of the successor's chunk.
+ * - Every further pass walks the chunks in index order. A chunk first applies the values sent to it: A winning successor
+ *   decides its position, a losing one counts down the moves, the last one loses the position. Then it reads its edges and
+ *   sends the value of every decided successor to the chunk of the position, edges of open successors are kept.
+ *   Values sent to a later chunk are applied in the same pass, the others in the next one.
+ * - Positions still open when nothing is sent anymore are draws.
+ * The result doesn't depend on the move history, so both repetition indices of a position get the same value.
+ * The table has the layout of the EvaluationTree cache and can be exported as table file */
+template<int Size>
+class StreamingSolver
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	StreamingSolver(const Board& setup, const StreamingSolverConfig& config);
+	~StreamingSolver();
+
+	/* If the setup can be indexed at all (one king per color) */
+	bool IsValidSetup() const { return m_layout.IsValid(); }
+
+	/* Solve all positions. Returns the value of the setup with white to move, -2 on I/O errors */
+	int Run();
+
+	/* Write the solved table in the format of EvaluationTree::SaveTable */
+	bool ExportTable(std::ostream& os);
+
+	/* Passes, timing and I/O */
+	void PrintStats(std::ostream& os) const;
+
+private:
+	using Rules = Retrograde<Size>;
+
+	/* Mates and draws by rule */
+	void InitializePass();
+
+	/* One sweep over all chunks with values to apply or send. Returns the number of resolved positions */
+	int64_t PropagationPass();
+
+	/* If a chunk has values to apply or send */
+	bool HasPendingWork() const;
+
+	/* A value sent to an open position of the resident chunk. Returns if it decided the position */
+	bool ApplyValue(int64_t chunk, int64_t index, int value);
+
+	/* Remaining open positions are draws */
+	void FinalizePass();
+
+	/* Value for both repetition indices */
+	void SetValue(int64_t index, int value);
+
+	/* Move counts of the first repetition positions of a chunk, kept in m_counts while the chunk is worked on */
+	bool LoadCounts(int64_t chunk);
+	bool StoreCounts(int64_t chunk);
+
+	/* No I/O error in the table, the buckets or the count file */
+	bool IsGood() const;
+
+	/* Scratch file next to the chunk file */
+	std::string GetScratchPath(const char* extension) const;
+
+	Board m_setup;
+	PositionLayout<Size> m_layout;
+	StreamingSolverConfig m_config;
+
+	std::string m_basePath;
+	std::string m_path;
+	ChunkedTable m_table;
+
+	/* Moves not known to lose yet, per open position */
+	std::fstream m_countFile;
+	std::vector<unsigned char> m_counts;
+
+	/* Edges (successor, position) by chunk of the successor, values (index * 4 + entry) by chunk of the position */
+	BucketStore m_edges;
+	BucketStore m_values;
+
+	/* Per chunk: Open positions, and decided positions whose value wasn't sent yet */
+	std::vector<int64_t> m_openPositions;
+	std::vector<int64_t> m_unsentPositions;
+
+	/* Stats */
+	int m_passes = 0;
+	int64_t m_positions = 0;
+	uint64_t m_countBytesRead = 0;
+	uint64_t m_countBytesWritten = 0;
+	double m_seconds = 0.0;
+};
@@ -0,0 +1,136 @@
+#include "TableVerifier.h"
+#include <algorithm>
+#include <chrono>
+#include <thread>
+#include "PositionIterator.h"
+
+template<int Size>
+TableVerifierResult TableVerifier<Size>::Run(std::ostream& os)
+{
+	int threadCount = m_config.threads > 0 ? m_config.threads : static_cast<int>(std::thread::hardware_concurrency());
+	if (threadCount <= 0)
+	{
+		threadCount = 1;
+	}
+
+	std::vector<TableVerifierResult> results(threadCount);
+	std::vector<std::thread> workers;
+	std::atomic<int> nextBlock{ 0 };
+
+	auto start = std::chrono::steady_clock::now();
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back(&TableVerifier::RunWorker, this, std::ref(nextBlock), std::ref(results[i]), std::ref(os));
+	}
+
+	TableVerifierResult total;
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers[i].join();
+		total.positions += results[i].positions;
+		total.unknown += results[i].unknown;
+		total.unverifiable += results[i].unverifiable;
+		total.terminalMismatches += results[i].terminalMismatches;
+		total.valueMismatches += results[i].valueMismatches;
+	}
+
+	total.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+	return total;
+}
+
+template<int Size>
+void TableVerifier<Size>::RunWorker(std::atomic<int>& nextBlock, TableVerifierResult& result, std::ostream& os)
+{
+	const PositionLayout<Size>& layout = m_tree.GetLayout();
+
+	std::vector<int> successors;
+
+	int block;
+	while ((block = nextBlock.fetch_add(1)) * BLOCK_SIZE < layout.GetCount())
+	{
+		for (PositionIterator<Size> position(layout, block * BLOCK_SIZE, (block + 1) * BLOCK_SIZE); position.Next();)
+		{
+			/* Both repetitions have the same successors */
+			int index = static_cast<int>(position.GetIndex());
+			GameState& state = position.GetState();
+			state.FinalizeGameState();
+			if (!Rules::GetSuccessors(layout, state, successors))
+			{
+				continue;
+			}
+			for (int successor : successors)
+			{
+				m_tree.PrefetchIndex(successor);
+			}
+
+			int stored = m_tree.GetIndexEvaluation(index);
+			if (stored == -2)
+			{
+				result.unknown++;
+				continue;
+			}
+			result.positions++;
+
+			/* Terminal by rule */
+			if (state.IsGameOver())
+			{
+				int expected = state.IsMate() ? (state.GetWinner() == Color::White ? 1 : -1) : 0;
+				if (stored != expected)
+				{
+					result.terminalMismatches++;
+					Report("terminal", index, state, stored, expected, os);
+				}
+				continue;
+			}
+
+			/* Minimax over the known successors */
+			int sign = state.GetNextPlayer() == Color::White ? 1 : -1;
+			int best = -2;
+			bool bComplete = true;
+			for (int successor : successors)
+			{
+				int value = m_tree.GetIndexEvaluation(successor);
+				if (value == -2)
+				{
+					bComplete = false;
+				}
+				else if (best == -2 || value * sign > best * sign)
+				{
+					best = value;
+				}
+			}
+
+			/* With unknown successors only a win is decided */
+			if (!bComplete && best != sign)
+			{
+				result.unverifiable++;
+				continue;
+			}
+
+			if (stored != best)
+			{
+				result.valueMismatches++;
+				Report("value", index, state, stored, best, os);
+			}
+		}
+	}
+}
+
+template<int Size>
+void TableVerifier<Size>::Report(const char* kind, int index, const GameState& state, int stored, int expected, std::ostream& os)
+{
+	std::lock_guard<std::mutex> lock(m_reportMutex);
+	if (m_reportCount++ >= m_config.maxReports)
+	{
+		return;
+	}
+
+	os << "Mismatch (" << kind << ") at index " << index << ": " << state.GetBoard() << (state.GetNextPlayer() == Color::White ? " w" : " b")
+		<< ", stored " << stored << ", expected " << expected << std::endl;
+}
+
+/* Supported board sizes */
+template class TableVerifier<8>;
+template class TableVerifier<10>;
+template class TableVerifier<12>;
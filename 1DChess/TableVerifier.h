@@ -0,0 +1,67 @@
+#pragma once
+#include <cstdint>
+#include <iostream>
+#include <mutex>
+#include <vector>
+#include "EvaluationTree.h"
+#include "Retrograde.h"
+
+struct TableVerifierConfig
+{
+	/* 0 = one per hardware thread */
+	int threads = 0;
+
+	/* Stop reporting after so many mismatches */
+	int maxReports = 20;
+};
+
+struct TableVerifierResult
+{
+	/* Known entries checked */
+	uint64_t positions = 0;
+
+	/* Entries still unknown, nothing to check */
+	uint64_t unknown = 0;
+
+	/* Known entries with unknown successors which don't decide the value on their own */
+	uint64_t unverifiable = 0;
+
+	uint64_t terminalMismatches = 0;
+	uint64_t valueMismatches = 0;
+
+	double seconds = 0.0;
+};
+
+/* Checks a solved table position by position: Terminal entries must match mate, stalemate and insufficient material
+ * of the rules, every other entry the minimax over the entries of its successors.
+ * Successors are looked up without history (first repetition), like the retrograde solvers do. Tables of the
+ * depth-first solve can therefore differ where repetitions on the solve path decided a value */
+template<int Size>
+class TableVerifier
+{
+public:
+	using Board = BasicBoard<Size>;
+	using GameState = BasicGameState<Size>;
+
+	TableVerifier(const BasicEvaluationTree<Size>& tree, const TableVerifierConfig& config) : m_tree(tree), m_config(config), m_reportCount(0) {}
+
+	/* Check all indices on all threads. Mismatches are reported to the stream */
+	TableVerifierResult Run(std::ostream& os);
+
+private:
+	using Rules = Retrograde<Size>;
+
+	/* Blocks of indices are handed out to the threads */
+	static constexpr int BLOCK_SIZE = 4096;
+
+	void RunWorker(std::atomic<int>& nextBlock, TableVerifierResult& result, std::ostream& os);
+
+	/* Thread-safe report of a mismatch */
+	void Report(const char* kind, int index, const GameState& state, int stored, int expected, std::ostream& os);
+
+	const BasicEvaluationTree<Size>& m_tree;
+	TableVerifierConfig m_config;
+
+	std::mutex m_reportMutex;
+	int m_reportCount;
+};
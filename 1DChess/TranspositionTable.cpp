@@ -0,0 +1,99 @@
+#include "TranspositionTable.h"
+#include <algorithm>
+
+TranspositionTable::TranspositionTable(const TranspositionTableConfig& config) : m_replacement(config.replacement)
+{
+	/* Power of two, so the bucket is a mask of the key */
+	m_bucketCount = 1;
+	while (m_bucketCount * 2 * sizeof(Bucket) <= config.memoryBytes)
+	{
+		m_bucketCount *= 2;
+	}
+
+	m_buckets = std::make_unique<Bucket[]>(m_bucketCount);
+	Clear();
+}
+
+bool TranspositionTable::Probe(uint64_t key, TranspositionEntry& entry) const
+{
+	const Bucket& bucket = m_buckets[key & (m_bucketCount - 1)];
+	for (const Entry& slot : bucket.entries)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		uint64_t check = slot.check.load(std::memory_order_relaxed);
+		if ((data & USED_FLAG) && (check ^ data) == key)
+		{
+			entry.value = static_cast<int>(data & 0xFF);
+			entry.depth = GetDepth(data);
+			return true;
+		}
+	}
+	return false;
+}
+
+void TranspositionTable::Store(uint64_t key, const TranspositionEntry& entry)
+{
+	Bucket& bucket = m_buckets[key & (m_bucketCount - 1)];
+	uint64_t newData = PackData(entry);
+
+	/* Same key, else an empty entry, else the shallowest */
+	Entry* target = nullptr;
+	int targetDepth = INT32_MAX;
+	for (Entry& slot : bucket.entries)
+	{
+		uint64_t data = slot.data.load(std::memory_order_relaxed);
+		uint64_t check = slot.check.load(std::memory_order_relaxed);
+		if (!(data & USED_FLAG) || (check ^ data) == key)
+		{
+			target = &slot;
+			targetDepth = -1;
+			break;
+		}
+
+		if (GetDepth(data) < targetDepth)
+		{
+			target = &slot;
+			targetDepth = GetDepth(data);
+		}
+	}
+
+	if (m_replacement == ReplacementPolicy::DepthPreferred && targetDepth > entry.depth)
+	{
+		return;
+	}
+
+	/* Two separate stores: A reader in between sees a key mismatch, not wrong data */
+	target->check.store(key ^ newData, std::memory_order_relaxed);
+	target->data.store(newData, std::memory_order_relaxed);
+}
+
+void TranspositionTable::Clear()
+{
+	for (size_t i = 0; i < m_bucketCount; i++)
+	{
+		for (Entry& slot : m_buckets[i].entries)
+		{
+			slot.check.store(0, std::memory_order_relaxed);
+			slot.data.store(0, std::memory_order_relaxed);
+		}
+	}
+}
+
+double TranspositionTable::GetOccupancy() const
+{
+	size_t buckets = std::min<size_t>(m_bucketCount, 1000);
+	size_t used = 0;
+	for (size_t i = 0; i < buckets; i++)
+	{
+		for (const Entry& slot : m_buckets[i].entries)
+		{
+			used += (slot.data.load(std::memory_order_relaxed) & USED_FLAG) ? 1 : 0;
+		}
+	}
+	return static_cast<double>(used) / (buckets * ENTRIES_PER_BUCKET);
+}
+
+uint64_t TranspositionTable::PackData(const TranspositionEntry& entry)
+{
+	return USED_FLAG | (static_cast<uint64_t>(std::clamp(entry.depth, 0, 0xFFFF)) << 8) | static_cast<uint64_t>(entry.value & 0xFF);
+}
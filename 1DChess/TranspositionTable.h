@@ -0,0 +1,120 @@
+#pragma once
+#include <array>
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include "Board.h"
+
+/* Which entry of a full bucket a new entry replaces */
+enum class ReplacementPolicy
+{
+	/* The shallowest entry, unless it is deeper than the new one. Then the new entry is dropped */
+	DepthPreferred,
+
+	/* The shallowest entry, always */
+	AlwaysReplace
+};
+
+struct TranspositionTableConfig
+{
+	/* Upper bound of the memory, rounded down to a power of two buckets */
+	size_t memoryBytes = 16 << 20;
+
+	ReplacementPolicy replacement = ReplacementPolicy::DepthPreferred;
+};
+
+/* What the table stores per key */
+struct TranspositionEntry
+{
+	/* Payload of the caller, 0..255 */
+	int value = 0;
+
+	/* Work behind the value (e.g. search depth), 0..65535. Deeper entries survive under DepthPreferred */
+	int depth = 0;
+};
+
+/* Fixed-size hash table of positions for caches which can't use a PositionLayout index: Variants too large to index,
+ * or keys with more information than the index. Memory is allocated once and never grows.
+ * Buckets of four entries fill one cache line, so a probe touches one line. Entries are lock-free (lockless hashing):
+ * The key is stored XOR the data, a torn entry from concurrent writers fails the key check and reads as a miss.
+ * Any number of threads can probe and store at the same time */
+class TranspositionTable
+{
+public:
+	static constexpr size_t ENTRIES_PER_BUCKET = 4;
+
+	explicit TranspositionTable(const TranspositionTableConfig& config);
+
+	/* Entry of a key. False if not stored (never stored, replaced, or overwritten meanwhile) */
+	bool Probe(uint64_t key, TranspositionEntry& entry) const;
+
+	/* Store or update the entry of a key, see ReplacementPolicy */
+	void Store(uint64_t key, const TranspositionEntry& entry);
+
+	/* Remove all entries. Not while other threads use the table */
+	void Clear();
+
+	size_t GetMemoryBytes() const { return m_bucketCount * sizeof(Bucket); }
+	size_t GetCapacity() const { return m_bucketCount * ENTRIES_PER_BUCKET; }
+
+	/* Share of used entries in the first (at most) 1000 buckets */
+	double GetOccupancy() const;
+
+private:
+	struct Entry
+	{
+		std::atomic<uint64_t> check;
+		std::atomic<uint64_t> data;
+	};
+
+	struct alignas(64) Bucket
+	{
+		Entry entries[ENTRIES_PER_BUCKET];
+	};
+	static_assert(sizeof(Bucket) == 64, "A bucket is one cache line");
+
+	/* Data word: Value in bits 0..7, depth in bits 8..23, the used flag keeps empty entries from matching key 0 */
+	static constexpr uint64_t USED_FLAG = uint64_t(1) << 63;
+	static uint64_t PackData(const TranspositionEntry& entry);
+	static int GetDepth(uint64_t data) { return static_cast<int>((data >> 8) & 0xFFFF); }
+
+	std::unique_ptr<Bucket[]> m_buckets;
+	size_t m_bucketCount = 0;
+	ReplacementPolicy m_replacement;
+};
+
+/* Zobrist keys: One random word per field and piece, side and repetition count (splitmix64 of the position in the table) */
+constexpr uint64_t GetZobristWord(uint64_t number)
+{
+	uint64_t z = (number + 1) * 0x9E3779B97F4A7C15ull;
+	z = (z ^ (z >> 30)) * 0xBF58476D1CE4E5B9ull;
+	z = (z ^ (z >> 27)) * 0x94D049BB133111EBull;
+	return z ^ (z >> 31);
+}
+
+constexpr std::array<uint64_t, 16 * 8 + 2 + 4> ZOBRIST_WORDS = []()
+{
+	std::array<uint64_t, 16 * 8 + 2 + 4> words = {};
+	for (size_t i = 0; i < words.size(); i++)
+	{
+		words[i] = GetZobristWord(i);
+	}
+	return words;
+}();
+
+/* Key of a position, with the same information as its position index (pieces, side to move, repetition count) */
+template<int Size>
+uint64_t GetPositionKey(const BasicBoard<Size>& board, Color nextPlayer, int repetitionCount)
+{
+	uint64_t key = ZOBRIST_WORDS[16 * 8 + static_cast<int>(nextPlayer)] ^ ZOBRIST_WORDS[16 * 8 + 2 + (repetitionCount & 3)];
+	for (int field = 0; field < Size; field++)
+	{
+		Piece piece = board.GetPiece(field);
+		if (piece != Piece::None)
+		{
+			key ^= ZOBRIST_WORDS[field * 8 + static_cast<int>(piece)];
+		}
+	}
+	return key;
+}
@@ -0,0 +1,154 @@
+#include "VariantSolver.h"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <thread>
+#include "CommandLine.h"
+#include "EvaluationTree.h"
+
+std::vector<VariantResult> VariantSolver::Run() const
+{
+	std::vector<VariantResult> results(m_setups.size());
+
+	int threadCount = m_threads > 0 ? m_threads : static_cast<int>(std::thread::hardware_concurrency());
+	threadCount = std::max(1, std::min(threadCount, static_cast<int>(m_setups.size())));
+
+	/* Variants differ a lot in size, so the threads pick the next one when done */
+	std::atomic<size_t> next{ 0 };
+	std::vector<std::thread> workers;
+
+	for (int i = 0; i < threadCount; i++)
+	{
+		workers.emplace_back([this, &next, &results]()
+		{
+			size_t variant;
+			while ((variant = next.fetch_add(1)) < m_setups.size())
+			{
+				SolveVariant(m_setups[variant], results[variant]);
+			}
+		});
+	}
+
+	for (std::thread& worker : workers)
+	{
+		worker.join();
+	}
+
+	return results;
+}
+
+bool VariantSolver::PrintSummary(const std::vector<VariantResult>& results, std::ostream& os)
+{
+	int whiteWins = 0;
+	int draws = 0;
+	int blackWins = 0;
+	int invalid = 0;
+	int tableErrors = 0;
+
+	for (const VariantResult& result : results)
+	{
+		os << result.setup << ": ";
+		if (!result.bValid)
+		{
+			os << "invalid setup" << std::endl;
+			invalid++;
+			continue;
+		}
+
+		switch (result.value)
+		{
+		case 1:
+			os << "White wins";
+			whiteWins++;
+			break;
+		case -1:
+			os << "Black wins";
+			blackWins++;
+			break;
+		default:
+			os << "Draw";
+			draws++;
+			break;
+		}
+
+		os << " (" << result.seconds << " s)";
+		if (!result.tablePath.empty() && result.bTableWritten)
+		{
+			os << " -> " << result.tablePath;
+		}
+		else if (!result.tablePath.empty())
+		{
+			os << ", could not write " << result.tablePath;
+			tableErrors++;
+		}
+		os << std::endl;
+	}
+
+	os << "----------------" << std::endl;
+	os << "White wins: " << whiteWins << std::endl;
+	os << "Draws: " << draws << std::endl;
+	os << "Black wins: " << blackWins << std::endl;
+	os << "Invalid: " << invalid << std::endl;
+	if (tableErrors > 0)
+	{
+		os << "Tables not written: " << tableErrors << std::endl;
+	}
+
+	return tableErrors == 0;
+}
+
+void VariantSolver::SolveVariant(const std::string& setup, VariantResult& result) const
+{
+	result.setup = setup;
+
+	dispatchBySize(setup, [&](auto size)
+	{
+		SolveVariantOfSize<decltype(size)::value>(setup, result);
+		return 0;
+	});
+}
+
+template<int Size>
+void VariantSolver::SolveVariantOfSize(const std::string& setup, VariantResult& result) const
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		return;
+	}
+
+	BasicEvaluationTree<Size> eval(board);
+	BasicGameState<Size> state(board, Color::White);
+	if (!eval.IsValidSetup() || !state.IsValidState())
+	{
+		return;
+	}
+
+	auto start = std::chrono::steady_clock::now();
+
+	state.FinalizeGameState();
+	eval.SetVerbose(false);
+	result.value = eval.Evaluate(state);
+	result.bValid = true;
+
+	result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+	if (!m_outputDirectory.empty())
+	{
+		result.tablePath = GetTablePath(setup);
+		std::ofstream file(result.tablePath, std::ios::binary);
+		if (file && eval.SaveTable(file))
+		{
+			file.close();
+			result.bTableWritten = static_cast<bool>(file);
+		}
+	}
+}
+
+std::string VariantSolver::GetTablePath(const std::string& setup) const
+{
+	std::string name = setup;
+	std::replace(name.begin(), name.end(), '.', '_');
+	return m_outputDirectory + "/" + name + ".tbl";
+}
@@ -0,0 +1,56 @@
+#pragma once
+#include <iostream>
+#include <string>
+#include <vector>
+
+/* Outcome of solving one variant */
+struct VariantResult
+{
+	std::string setup;
+
+	/* False if the setup is no legal position or can't be cached */
+	bool bValid = false;
+
+	/* -1, 0, 1 with white to move first */
+	int value = 0;
+
+	/* Table file, empty if none was asked for */
+	std::string tablePath;
+
+	/* False if the table file couldn't be opened or written */
+	bool bTableWritten = false;
+
+	double seconds = 0.0;
+};
+
+/* Solves a list of variant starting setups (8, 10 or 12 fields) in parallel, one evaluation tree per variant, and writes one table per variant */
+class VariantSolver
+{
+public:
+	VariantSolver(const std::vector<std::string>& setups, int threads, const std::string& outputDirectory)
+		: m_setups(setups), m_threads(threads), m_outputDirectory(outputDirectory) {}
+
+	/* Solve all variants, results in input order */
+	std::vector<VariantResult> Run() const;
+
+	/* One line per variant and the count of wins, draws and losses. False if a table couldn't be written */
+	static bool PrintSummary(const std::vector<VariantResult>& results, std::ostream& os);
+
+private:
+	/* Dispatch on the setup length to the board size, other sizes stay invalid */
+	void SolveVariant(const std::string& setup, VariantResult& result) const;
+
+	template<int Size>
+	void SolveVariantOfSize(const std::string& setup, VariantResult& result) const;
+
+	/* File name for the table of a setup. Empty fields become '_' */
+	std::string GetTablePath(const std::string& setup) const;
+
+	std::vector<std::string> m_setups;
+
+	/* 0 = one per hardware thread */
+	int m_threads;
+
+	/* Empty = don't write tables */
+	std::string m_outputDirectory;
+};
@@ -0,0 +1,437 @@
+#include "ChessApi.h"
+#include <map>
+#include <memory>
+#include <mutex>
+#include <new>
+#include <string>
+#include "Game.h"
+#include "MappedTable.h"
+#include "PositionLayout.h"
+
+/* The handles are size independent, their implementations are templated on the board size */
+struct ChessTable
+{
+	virtual ~ChessTable() = default;
+
+	/* Position index of a board of the table's size, -1 if not in the table */
+	virtual int64_t GetIndex(std::string_view board, Color nextPlayer, int repetitionCount) const = 0;
+
+	int size = 0;
+	std::unique_ptr<MappedTable> file;
+
+	/* Registry of open tables */
+	std::string path;
+	int references = 0;
+};
+
+template<int Size>
+struct TableOfSize : ChessTable
+{
+	int64_t GetIndex(std::string_view text, Color nextPlayer, int repetitionCount) const override
+	{
+		BasicBoard<Size> board;
+		if (!BasicBoard<Size>::FromString(text, board))
+		{
+			return -1;
+		}
+		return GetIndex(board, nextPlayer, repetitionCount);
+	}
+
+	int64_t GetIndex(const BasicBoard<Size>& board, Color nextPlayer, int repetitionCount) const
+	{
+		int64_t index = layout.Get(board, nextPlayer, repetitionCount);
+		return index < file->GetPositionCount() ? index : -1;
+	}
+
+	PositionLayout<Size> layout;
+};
+
+struct ChessState
+{
+	virtual ~ChessState() = default;
+
+	virtual ChessState* Clone() const = 0;
+	virtual int GetMoves(ChessMove* moves, int capacity) const = 0;
+	virtual bool ApplyMove(const ChessMove& move) = 0;
+	virtual int GetBoard(char* buffer, int capacity) const = 0;
+	virtual int GetSideToMove() const = 0;
+	virtual int GetRepetitionCount() const = 0;
+	virtual int GetResult() const = 0;
+
+	/* Position index in a table, -1 for tables of other sizes or setups and once the game is over */
+	virtual int64_t GetTableIndex(const ChessTable& table) const = 0;
+};
+
+template<int Size>
+struct StateOfSize : ChessState
+{
+	explicit StateOfSize(const BasicGameState<Size>& gameState) : state(gameState) {}
+
+	ChessState* Clone() const override
+	{
+		return new StateOfSize(*this);
+	}
+
+	int GetMoves(ChessMove* moves, int capacity) const override
+	{
+		const std::vector<Move>& stateMoves = state.GetMoves();
+		for (int i = 0; i < capacity && i < static_cast<int>(stateMoves.size()); i++)
+		{
+			moves[i] = { stateMoves[i].from, stateMoves[i].to, static_cast<int>(stateMoves[i].piece) };
+		}
+		return static_cast<int>(stateMoves.size());
+	}
+
+	bool ApplyMove(const ChessMove& move) override
+	{
+		if (state.IsGameOver())
+		{
+			return false;
+		}
+
+		for (const Move& stateMove : state.GetMoves())
+		{
+			if (stateMove.from == move.from && stateMove.to == move.to)
+			{
+				state.MakeMoveUnchecked(stateMove);
+				state.FinalizeGameState();
+				return true;
+			}
+		}
+		return false;
+	}
+
+	int GetBoard(char* buffer, int capacity) const override
+	{
+		if (capacity <= Size)
+		{
+			return -1;
+		}
+
+		/* Same characters as the stream operator of Board */
+		static const char pieceChars[] = { '.', 'R', 'N', 'K', 'r', 'n', 'k' };
+		for (int field = 0; field < Size; field++)
+		{
+			buffer[field] = pieceChars[static_cast<int>(state.GetBoard().GetPiece(field))];
+		}
+		buffer[Size] = '\0';
+		return Size;
+	}
+
+	int GetSideToMove() const override
+	{
+		return state.GetNextPlayer() == Color::White ? CHESS_WHITE : CHESS_BLACK;
+	}
+
+	int GetRepetitionCount() const override
+	{
+		return state.GetRepetitionCount();
+	}
+
+	int GetResult() const override
+	{
+		if (state.IsMate())
+		{
+			return state.GetWinner() == Color::White ? CHESS_WDL_WHITE_WINS : CHESS_WDL_BLACK_WINS;
+		}
+		return state.IsDraw() ? CHESS_WDL_DRAW : CHESS_WDL_UNKNOWN;
+	}
+
+	int64_t GetTableIndex(const ChessTable& table) const override
+	{
+		if (table.size != Size || state.IsGameOver())
+		{
+			return -1;
+		}
+		return static_cast<const TableOfSize<Size>&>(table).GetIndex(state.GetBoard(), state.GetNextPlayer(), state.GetRepetitionCount());
+	}
+
+	BasicGameState<Size> state;
+};
+
+/* Open tables by path, so every file is mapped once per process */
+static std::mutex tableMutex;
+static std::map<std::string, ChessTable*> openTables;
+
+/* Table entry (see CachedEvaluation of EvaluationTree) to CHESS_WDL_* */
+static constexpr signed char ENTRY_RESULTS[4] = { CHESS_WDL_UNKNOWN, CHESS_WDL_WHITE_WINS, CHESS_WDL_DRAW, CHESS_WDL_BLACK_WINS };
+
+template<int Size>
+static ChessState* createStateOfSize(std::string_view setup)
+{
+	BasicBoard<Size> board;
+	if (!BasicBoard<Size>::FromString(setup, board))
+	{
+		return nullptr;
+	}
+
+	BasicGameState<Size> state(board, Color::White);
+	if (!state.IsValidState())
+	{
+		return nullptr;
+	}
+	state.FinalizeGameState();
+
+	return new StateOfSize<Size>(state);
+}
+
+template<int Size>
+static ChessTable* createTableOfSize(std::string_view setup)
+{
+	TableOfSize<Size>* table = new TableOfSize<Size>();
+	table->size = Size;
+	table->layout = PositionLayout<Size>::FromSetup(setup);
+	return table;
+}
+
+extern "C"
+{
+
+int chess_api_version(void)
+{
+	return CHESS_API_VERSION;
+}
+
+ChessState* chess_state_create(const char* setup)
+{
+	std::string_view text = setup != nullptr ? std::string_view(setup) : STARTING_SETUP;
+
+	try
+	{
+		switch (text.size())
+		{
+		case 8:
+			return createStateOfSize<8>(text);
+		case 10:
+			return createStateOfSize<10>(text);
+		case 12:
+			return createStateOfSize<12>(text);
+		default:
+			return nullptr;
+		}
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+ChessState* chess_state_clone(const ChessState* state)
+{
+	try
+	{
+		return state != nullptr ? state->Clone() : nullptr;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void chess_state_free(ChessState* state)
+{
+	delete state;
+}
+
+int chess_state_moves(const ChessState* state, ChessMove* moves, int capacity)
+{
+	if (state == nullptr)
+	{
+		return 0;
+	}
+	return state->GetMoves(moves, moves != nullptr ? capacity : 0);
+}
+
+int chess_state_apply_move(ChessState* state, const ChessMove* move)
+{
+	if (state == nullptr || move == nullptr)
+	{
+		return -1;
+	}
+
+	try
+	{
+		return state->ApplyMove(*move) ? 0 : -1;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return -1;
+	}
+}
+
+int chess_state_board(const ChessState* state, char* buffer, int capacity)
+{
+	if (state == nullptr || buffer == nullptr)
+	{
+		return -1;
+	}
+	return state->GetBoard(buffer, capacity);
+}
+
+int chess_state_side_to_move(const ChessState* state)
+{
+	return state != nullptr ? state->GetSideToMove() : CHESS_WHITE;
+}
+
+int chess_state_repetition_count(const ChessState* state)
+{
+	return state != nullptr ? state->GetRepetitionCount() : 0;
+}
+
+int chess_state_result(const ChessState* state)
+{
+	return state != nullptr ? state->GetResult() : CHESS_WDL_UNKNOWN;
+}
+
+ChessTable* chess_table_open(const char* path)
+{
+	if (path == nullptr)
+	{
+		return nullptr;
+	}
+
+	std::lock_guard<std::mutex> lock(tableMutex);
+
+	auto open = openTables.find(path);
+	if (open != openTables.end())
+	{
+		open->second->references++;
+		return open->second;
+	}
+
+	try
+	{
+		std::unique_ptr<MappedTable> file = std::make_unique<MappedTable>();
+		if (!file->Open(path))
+		{
+			return nullptr;
+		}
+
+		ChessTable* table = nullptr;
+		switch (file->GetSetup().size())
+		{
+		case 8:
+			table = createTableOfSize<8>(file->GetSetup());
+			break;
+		case 10:
+			table = createTableOfSize<10>(file->GetSetup());
+			break;
+		case 12:
+			table = createTableOfSize<12>(file->GetSetup());
+			break;
+		default:
+			return nullptr;
+		}
+
+		table->file = std::move(file);
+		table->path = path;
+		table->references = 1;
+		openTables[path] = table;
+		return table;
+	}
+	catch (const std::bad_alloc&)
+	{
+		return nullptr;
+	}
+}
+
+void chess_table_close(ChessTable* table)
+{
+	if (table == nullptr)
+	{
+		return;
+	}
+
+	std::lock_guard<std::mutex> lock(tableMutex);
+	if (--table->references == 0)
+	{
+		openTables.erase(table->path);
+		delete table;
+	}
+}
+
+const char* chess_table_setup(const ChessTable* table, int* length)
+{
+	if (table == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (length != nullptr)
+	{
+		*length = static_cast<int>(table->file->GetSetup().size());
+	}
+	return table->file->GetSetup().c_str();
+}
+
+const unsigned char* chess_table_entries(const ChessTable* table, int64_t* count)
+{
+	if (table == nullptr)
+	{
+		return nullptr;
+	}
+
+	if (count != nullptr)
+	{
+		*count = table->file->GetPositionCount();
+	}
+	return table->file->GetEntries();
+}
+
+int64_t chess_table_index(const ChessTable* table, const char* board, int sideToMove, int repetitionCount)
+{
+	if (table == nullptr || board == nullptr)
+	{
+		return -1;
+	}
+	return table->GetIndex(board, sideToMove == CHESS_WHITE ? Color::White : Color::Black, repetitionCount);
+}
+
+int64_t chess_table_state_index(const ChessTable* table, const ChessState* state)
+{
+	if (table == nullptr || state == nullptr)
+	{
+		return -1;
+	}
+	return state->GetTableIndex(*table);
+}
+
+int chess_table_probe_index(const ChessTable* table, int64_t index)
+{
+	if (table == nullptr)
+	{
+		return CHESS_WDL_UNKNOWN;
+	}
+	return ENTRY_RESULTS[table->file->GetEntry(index)];
+}
+
+int chess_table_probe(const ChessTable* table, const ChessState* state)
+{
+	if (table == nullptr || state == nullptr)
+	{
+		return CHESS_WDL_UNKNOWN;
+	}
+
+	int result = state->GetResult();
+	if (result != CHESS_WDL_UNKNOWN)
+	{
+		return result;
+	}
+	return ENTRY_RESULTS[table->file->GetEntry(state->GetTableIndex(*table))];
+}
+
+void chess_table_probe_batch(const ChessTable* table, const int64_t* indices, size_t count, signed char* results)
+{
+	if (table == nullptr || indices == nullptr || results == nullptr)
+	{
+		return;
+	}
+
+	const MappedTable& file = *table->file;
+	for (size_t i = 0; i < count; i++)
+	{
+		results[i] = ENTRY_RESULTS[file.GetEntry(indices[i])];
+	}
+}
+
+}
@@ -0,0 +1,107 @@
+#pragma once
+/* C interface of the 1D chess engine, for linking the rules and solved tables into other programs.
+ * Stable ABI: Opaque handles, plain C types and no C++ exceptions across the boundary.
+ * Build as DLL (defines CHESS_API_EXPORTS) or link statically with CHESS_API_STATIC defined by the caller */
+
+#include <stddef.h>
+#include <stdint.h>
+
+#if defined(CHESS_API_STATIC)
+#define CHESS_API
+#elif defined(_WIN32) && defined(CHESS_API_EXPORTS)
+#define CHESS_API __declspec(dllexport)
+#elif defined(_WIN32)
+#define CHESS_API __declspec(dllimport)
+#else
+#define CHESS_API __attribute__((visibility("default")))
+#endif
+
+#ifdef __cplusplus
+extern "C" {
+#endif
+
+/* Raised with incompatible changes of this header */
+#define CHESS_API_VERSION 1
+
+/* Evaluations, from the view of white */
+#define CHESS_WDL_BLACK_WINS (-1)
+#define CHESS_WDL_DRAW 0
+#define CHESS_WDL_WHITE_WINS 1
+#define CHESS_WDL_UNKNOWN (-2)
+
+/* Sides */
+#define CHESS_WHITE 0
+#define CHESS_BLACK 1
+
+/* Game with history (repetitions) on a board of 8, 10 or 12 fields */
+typedef struct ChessState ChessState;
+
+/* Solved table file, mapped read-only. Position indices are 64 bit, larger boards have more positions than an int holds */
+typedef struct ChessTable ChessTable;
+
+/* Fields count from 0. piece: 1 rook, 2 knight, 3 king (only filled by chess_state_moves) */
+typedef struct ChessMove
+{
+	int from;
+	int to;
+	int piece;
+} ChessMove;
+
+CHESS_API int chess_api_version(void);
+
+/* State */
+
+/* New game from a setup in stream notation (e.g. "KNR..rnk", "KNR....rnk"), white to move. NULL setup is the standard setup.
+ * NULL if the setup is no board of a supported size or no legal position */
+CHESS_API ChessState* chess_state_create(const char* setup);
+CHESS_API ChessState* chess_state_clone(const ChessState* state);
+CHESS_API void chess_state_free(ChessState* state);
+
+/* Number of legal moves. Writes at most capacity of them in engine move order and returns the total number */
+CHESS_API int chess_state_moves(const ChessState* state, ChessMove* moves, int capacity);
+
+/* Make a legal move (piece is ignored). 0 on success, -1 if the move is not legal or the game is over */
+CHESS_API int chess_state_apply_move(ChessState* state, const ChessMove* move);
+
+/* Board in stream notation into buffer (board size + 1 bytes with the terminating 0). Returns the board size, -1 if the buffer is too small */
+CHESS_API int chess_state_board(const ChessState* state, char* buffer, int capacity);
+
+CHESS_API int chess_state_side_to_move(const ChessState* state);
+CHESS_API int chess_state_repetition_count(const ChessState* state);
+
+/* Result by rule (mate, stalemate, material, repetition) as CHESS_WDL_*, CHESS_WDL_UNKNOWN while the game goes on */
+CHESS_API int chess_state_result(const ChessState* state);
+
+/* Table */
+
+/* Map a table file written by the solver (--variants out=, --stream out=, ...). A file already open in this process is shared,
+ * every open needs its close. NULL if the file is no table */
+CHESS_API ChessTable* chess_table_open(const char* path);
+CHESS_API void chess_table_close(ChessTable* table);
+
+/* Setup of the table in stream notation, terminated by 0 and valid until the table is closed. Writes its length
+ * (the board size) to length unless that is NULL */
+CHESS_API const char* chess_table_setup(const ChessTable* table, int* length);
+
+/* Packed entries in place, valid until the table is closed: 2 bits per position index at bit (index % 4 * 2) of byte index / 4.
+ * 0 unknown, 1 white wins, 2 draw, 3 black wins. Writes the number of position indices to count */
+CHESS_API const unsigned char* chess_table_entries(const ChessTable* table, int64_t* count);
+
+/* Position index of a board in stream notation, the side to move and the repetition count (1 or 2). -1 if not in the table */
+CHESS_API int64_t chess_table_index(const ChessTable* table, const char* board, int sideToMove, int repetitionCount);
+
+/* Position index of a state, -1 if not in the table (other setup, game over) */
+CHESS_API int64_t chess_table_state_index(const ChessTable* table, const ChessState* state);
+
+/* Evaluation of a position index as CHESS_WDL_* */
+CHESS_API int chess_table_probe_index(const ChessTable* table, int64_t index);
+
+/* Evaluation of a state: The rule result once the game is over, the table value otherwise */
+CHESS_API int chess_table_probe(const ChessTable* table, const ChessState* state);
+
+/* Evaluate count position indices into results (CHESS_WDL_*). Invalid indices give CHESS_WDL_UNKNOWN */
+CHESS_API void chess_table_probe_batch(const ChessTable* table, const int64_t* indices, size_t count, signed char* results);
+
+#ifdef __cplusplus
+}
+#endif